@@ -0,0 +1,133 @@
+#include <cnfkit/detail/cnflike_parser.h>
+#include <cnfkit/detail/dimacs_parser.h>
+#include <cnfkit/dimacs_parser.h>
+#include <cnfkit/input_policy.h>
+#include <cnfkit/io/io_buf.h>
+#include <cnfkit/literal.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace cnfkit {
+
+namespace {
+auto create_random_3sat_body(uint32_t num_vars, size_t num_clauses) -> std::string
+{
+  std::mt19937 rng{1};
+  std::uniform_int_distribution<int32_t> var_distribution{1, static_cast<int32_t>(num_vars)};
+
+  std::string result;
+  for (size_t clause_idx = 0; clause_idx < num_clauses; ++clause_idx) {
+    for (int lit_idx = 0; lit_idx < 3; ++lit_idx) {
+      int32_t const var = var_distribution(rng);
+      result += std::to_string(rng() % 2 == 0 ? var : -var) + " ";
+    }
+    result += "0\n";
+  }
+  return result;
+}
+
+auto get_benchmark_input() -> std::string const&
+{
+  static std::string const input = create_random_3sat_body(1000000, 4000000);
+  return input;
+}
+
+template <typename InputPolicy>
+void parse_with_kernel_and_policy(benchmark::State& state, detail::scan_kernel kernel)
+{
+  if (!detail::is_scan_kernel_supported(kernel)) {
+    state.SkipWithError("scan kernel not supported on this machine");
+    return;
+  }
+
+  std::string const& input = get_benchmark_input();
+
+  for (auto _ : state) {
+    detail::cnf_chunk_parser parser{detail::cnf_chunk_parser_mode::dimacs, kernel};
+    size_t num_lits = 0;
+    parser.parse<InputPolicy>(
+        input, 0, [&num_lits](bool /*unused*/, std::vector<lit> const& clause) {
+          num_lits += clause.size();
+        });
+    benchmark::DoNotOptimize(num_lits);
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * input.size()));
+}
+
+void parse_with_kernel(benchmark::State& state, detail::scan_kernel kernel)
+{
+  parse_with_kernel_and_policy<validated_input>(state, kernel);
+}
+
+void parse_trusted_with_kernel(benchmark::State& state, detail::scan_kernel kernel)
+{
+  parse_with_kernel_and_policy<trusted_input>(state, kernel);
+}
+
+// Some generators precede the formula with megabytes of comment lines
+auto create_cnf_with_comment_preamble(size_t preamble_size) -> std::string
+{
+  std::string result;
+  while (result.size() < preamble_size) {
+    result += "c generated by a tool emitting lots of comment lines, 0123456789\n";
+  }
+  return result + "p cnf 3 2\n1 -2 0\n2 3 0\n";
+}
+
+auto get_preamble_benchmark_input() -> std::string const&
+{
+  static std::string const input = create_cnf_with_comment_preamble(10000000);
+  return input;
+}
+
+void parse_comment_preamble(benchmark::State& state)
+{
+  std::string const& input = get_preamble_benchmark_input();
+
+  for (auto _ : state) {
+    buf_source source{input};
+    size_t num_lits = 0;
+    parse_cnf(source, [&num_lits](std::vector<lit> const& clause) { num_lits += clause.size(); });
+    benchmark::DoNotOptimize(num_lits);
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * input.size()));
+}
+
+void parse_in_memory_comment_preamble(benchmark::State& state)
+{
+  std::string const& input = get_preamble_benchmark_input();
+
+  for (auto _ : state) {
+    auto const header = detail::parse_cnf_header(input);
+    benchmark::DoNotOptimize(header);
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * input.size()));
+}
+}
+
+// The disabled kernel measures the regular, non-vectorized parser
+BENCHMARK_CAPTURE(parse_with_kernel, regular_parser, detail::scan_kernel::disabled)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(parse_with_kernel, scalar, detail::scan_kernel::scalar)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(parse_with_kernel, sse2, detail::scan_kernel::sse2)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(parse_with_kernel, avx2, detail::scan_kernel::avx2)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(parse_trusted_with_kernel, regular_parser, detail::scan_kernel::disabled)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(parse_trusted_with_kernel, avx2, detail::scan_kernel::avx2)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(parse_comment_preamble)->Unit(benchmark::kMillisecond);
+BENCHMARK(parse_in_memory_comment_preamble)->Unit(benchmark::kMillisecond);
+}
@@ -0,0 +1,122 @@
+#include <cnfkit/dimacs_writer.h>
+#include <cnfkit/io.h>
+#include <cnfkit/literal.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <streambuf>
+#include <vector>
+
+namespace cnfkit {
+
+namespace {
+class null_sink : public sink {
+public:
+  void write_bytes(std::byte const* start, std::byte const* stop) override
+  {
+    m_num_bytes += stop - start;
+    benchmark::DoNotOptimize(start);
+  }
+
+  void flush() override {}
+
+  auto get_num_bytes() const -> size_t { return m_num_bytes; }
+
+private:
+  size_t m_num_bytes = 0;
+};
+
+class null_streambuf : public std::streambuf {
+public:
+  auto get_num_bytes() const -> size_t { return m_num_bytes; }
+
+protected:
+  auto overflow(int_type ch) -> int_type override
+  {
+    ++m_num_bytes;
+    return traits_type::not_eof(ch);
+  }
+
+  auto xsputn(char const* str, std::streamsize count) -> std::streamsize override
+  {
+    m_num_bytes += count;
+    benchmark::DoNotOptimize(str);
+    return count;
+  }
+
+private:
+  size_t m_num_bytes = 0;
+};
+
+// Clauses of sizes 2 to 10, as typically occurring in preprocessed instances
+auto create_random_clauses(uint32_t num_vars, size_t num_clauses) -> std::vector<std::vector<lit>>
+{
+  std::mt19937 rng{1};
+  std::uniform_int_distribution<uint32_t> var_distribution{0, num_vars - 1};
+  std::uniform_int_distribution<size_t> size_distribution{2, 10};
+
+  std::vector<std::vector<lit>> result(num_clauses);
+  for (std::vector<lit>& clause : result) {
+    clause.resize(size_distribution(rng));
+    for (lit& literal : clause) {
+      literal = lit{var{var_distribution(rng)}, rng() % 2 == 0};
+    }
+  }
+  return result;
+}
+
+auto get_benchmark_input() -> std::vector<std::vector<lit>> const&
+{
+  static std::vector<std::vector<lit>> const input = create_random_clauses(1000000, 1000000);
+  return input;
+}
+
+void write_cnf(benchmark::State& state)
+{
+  std::vector<std::vector<lit>> const& input = get_benchmark_input();
+  size_t num_bytes = 0;
+
+  for (auto _ : state) {
+    null_sink sink;
+    dimacs_writer writer{sink, 1000000, input.size()};
+    for (std::vector<lit> const& clause : input) {
+      writer.add_clause(clause.data(), clause.data() + clause.size());
+    }
+    writer.flush();
+    num_bytes += sink.get_num_bytes();
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(num_bytes));
+}
+
+// Baseline: writing the formula via std::ostream
+void write_cnf_via_ostream(benchmark::State& state)
+{
+  std::vector<std::vector<lit>> const& input = get_benchmark_input();
+  size_t num_bytes = 0;
+
+  for (auto _ : state) {
+    null_streambuf buf;
+    std::ostream output{&buf};
+    output << "p cnf " << 1000000 << " " << input.size() << "\n";
+    for (std::vector<lit> const& clause : input) {
+      for (lit const literal : clause) {
+        output << lit_to_dimacs(literal) << " ";
+      }
+      output << "0\n";
+    }
+    output.flush();
+    num_bytes += buf.get_num_bytes();
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(num_bytes));
+}
+}
+
+BENCHMARK(write_cnf)->Unit(benchmark::kMillisecond);
+BENCHMARK(write_cnf_via_ostream)->Unit(benchmark::kMillisecond);
+}
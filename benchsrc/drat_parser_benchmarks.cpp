@@ -0,0 +1,96 @@
+#include <cnfkit/detail/drat_parser.h>
+#include <cnfkit/detail/leb128.h>
+#include <cnfkit/drat_writer.h>
+#include <cnfkit/io.h>
+#include <cnfkit/literal.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace cnfkit {
+
+namespace {
+class string_sink : public sink {
+public:
+  void write_bytes(std::byte const* start, std::byte const* stop) override
+  {
+    m_data.append(reinterpret_cast<char const*>(start), reinterpret_cast<char const*>(stop));
+  }
+
+  void flush() override {}
+
+  auto get_data() const -> std::string const& { return m_data; }
+
+private:
+  std::string m_data;
+};
+
+// Clauses of sizes 2 to 30 over 1M variables, i.e. mostly literals of 3 bytes
+auto create_random_binary_proof(uint32_t num_vars, size_t num_clauses) -> std::string
+{
+  std::mt19937 rng{1};
+  std::uniform_int_distribution<uint32_t> var_distribution{0, num_vars - 1};
+  std::uniform_int_distribution<size_t> size_distribution{2, 30};
+
+  string_sink sink;
+  drat_binary_writer writer{sink};
+  std::vector<lit> clause;
+  for (size_t clause_idx = 0; clause_idx < num_clauses; ++clause_idx) {
+    clause.resize(size_distribution(rng));
+    for (lit& literal : clause) {
+      literal = lit{var{var_distribution(rng)}, rng() % 2 == 0};
+    }
+    writer.add_clause(clause.data(), clause.data() + clause.size());
+  }
+  writer.flush();
+  return sink.get_data();
+}
+
+auto get_benchmark_input() -> std::string const&
+{
+  static std::string const input = create_random_binary_proof(1000000, 1000000);
+  return input;
+}
+
+void parse_with_kernel(benchmark::State& state, detail::leb128_kernel kernel)
+{
+  if (!detail::is_leb128_kernel_supported(kernel)) {
+    state.SkipWithError("LEB128 kernel not supported on this machine");
+    return;
+  }
+
+  std::string const& input = get_benchmark_input();
+  std::byte const* start = reinterpret_cast<std::byte const*>(input.data());
+
+  for (auto _ : state) {
+    detail::drat_binary_chunk_parser parser{kernel};
+    size_t num_lits = 0;
+    parser.parse(start,
+                 start + input.size(),
+                 [&num_lits](bool /*unused*/, lit const* clause_start, lit const* clause_stop) {
+                   num_lits += clause_stop - clause_start;
+                 });
+    benchmark::DoNotOptimize(num_lits);
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * input.size()));
+}
+}
+
+// The disabled kernel measures the regular, non-vectorized parser
+BENCHMARK_CAPTURE(parse_with_kernel, regular_parser, detail::leb128_kernel::disabled)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(parse_with_kernel, scalar, detail::leb128_kernel::scalar)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(parse_with_kernel, bmi2, detail::leb128_kernel::bmi2)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(parse_with_kernel, ssse3, detail::leb128_kernel::ssse3)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(parse_with_kernel, avx2, detail::leb128_kernel::avx2)
+    ->Unit(benchmark::kMillisecond);
+}
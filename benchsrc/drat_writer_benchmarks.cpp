@@ -0,0 +1,82 @@
+#include <cnfkit/drat_writer.h>
+#include <cnfkit/io.h>
+#include <cnfkit/literal.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace cnfkit {
+
+namespace {
+class null_sink : public sink {
+public:
+  void write_bytes(std::byte const* start, std::byte const* stop) override
+  {
+    m_num_bytes += stop - start;
+    benchmark::DoNotOptimize(start);
+  }
+
+  void flush() override {}
+
+  auto get_num_bytes() const -> size_t { return m_num_bytes; }
+
+private:
+  size_t m_num_bytes = 0;
+};
+
+// Clauses of sizes 2 to 30, as typically emitted by solvers for learnt clauses
+auto create_random_clauses(uint32_t num_vars, size_t num_clauses) -> std::vector<std::vector<lit>>
+{
+  std::mt19937 rng{1};
+  std::uniform_int_distribution<uint32_t> var_distribution{0, num_vars - 1};
+  std::uniform_int_distribution<size_t> size_distribution{2, 30};
+
+  std::vector<std::vector<lit>> result(num_clauses);
+  for (std::vector<lit>& clause : result) {
+    clause.resize(size_distribution(rng));
+    for (lit& literal : clause) {
+      literal = lit{var{var_distribution(rng)}, rng() % 2 == 0};
+    }
+  }
+  return result;
+}
+
+auto get_benchmark_input() -> std::vector<std::vector<lit>> const&
+{
+  static std::vector<std::vector<lit>> const input = create_random_clauses(1000000, 1000000);
+  return input;
+}
+
+template <typename Writer>
+void write_proof(benchmark::State& state)
+{
+  std::vector<std::vector<lit>> const& input = get_benchmark_input();
+  size_t num_bytes = 0;
+
+  for (auto _ : state) {
+    null_sink sink;
+    Writer writer{sink};
+    for (size_t idx = 0; idx < input.size(); ++idx) {
+      std::vector<lit> const& clause = input[idx];
+      if (idx % 2 == 0) {
+        writer.add_clause(clause.data(), clause.data() + clause.size());
+      }
+      else {
+        writer.del_clause(clause.data(), clause.data() + clause.size());
+      }
+    }
+    writer.flush();
+    num_bytes += sink.get_num_bytes();
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(num_bytes));
+}
+}
+
+BENCHMARK_TEMPLATE(write_proof, drat_text_writer)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(write_proof, drat_binary_writer)->Unit(benchmark::kMillisecond);
+}
@@ -0,0 +1,437 @@
+#pragma once
+
+/**
+ * \file
+ */
+
+#include <cnfkit/detail/check_cxx_version.h>
+
+#include <cnfkit/literal.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * \defgroup formulas In-Memory Formulas
+ *
+ * \brief Compact in-memory representations of formulas
+ */
+
+namespace cnfkit {
+
+/**
+ * \brief Reference to a clause stored in a clause_arena.
+ *
+ * \ingroup formulas
+ *
+ * Clause references are 32-bit offsets into the arena. Unlike pointers, they
+ * remain valid when the arena grows.
+ */
+class clause_ref {
+public:
+  constexpr explicit clause_ref(uint32_t raw_value) noexcept : m_raw_value{raw_value} {}
+  constexpr clause_ref() noexcept : m_raw_value{0} {}
+
+  constexpr auto get_raw_value() const noexcept -> uint32_t { return m_raw_value; }
+
+private:
+  uint32_t m_raw_value;
+};
+
+constexpr auto operator==(clause_ref lhs, clause_ref rhs) noexcept -> bool;
+constexpr auto operator!=(clause_ref lhs, clause_ref rhs) noexcept -> bool;
+constexpr auto operator<(clause_ref lhs, clause_ref rhs) noexcept -> bool;
+
+/**
+ * \brief Mapping from clause references valid before a clause_arena compaction
+ *        to the corresponding references valid after the compaction.
+ *
+ * \ingroup formulas
+ */
+class clause_forwarding_table {
+public:
+  /**
+   * \brief Returns the reference of the clause referenced by `old_ref` before the compaction,
+   *        or `std::nullopt` if the clause has been discarded.
+   */
+  auto forward(clause_ref old_ref) const noexcept -> std::optional<clause_ref>;
+
+  /**
+   * \brief Returns the number of clauses that survived the compaction.
+   */
+  auto size() const noexcept -> size_t;
+
+private:
+  template <typename ClauseType>
+  friend class clause_arena;
+
+  // Sorted by the old references
+  std::vector<std::pair<clause_ref, clause_ref>> m_forwarding;
+};
+
+/**
+ * \brief Key function for `clause_arena::compact()`, ordering clauses by size.
+ *
+ * \ingroup formulas
+ */
+struct clause_size_key {
+  template <typename ClauseType>
+  auto operator()(ClauseType const& clause) const noexcept -> typename ClauseType::size_type
+  {
+    return clause.size();
+  }
+};
+
+/**
+ * \brief Storage for clauses with the memory layout defined by `clause`.
+ *
+ * \ingroup formulas
+ *
+ * All clauses are stored contiguously in a single growable buffer of 32-bit
+ * words. `ClauseType` must be derived from `clause<ClauseType, SizeType>`
+ * and may not require an alignment stricter than that of `uint32_t`.
+ *
+ * References to clauses returned by `resolve()` are invalidated when clauses
+ * are added to the arena. Clause references are not, except by `compact()`.
+ *
+ * Clauses can be marked as deleted. Their memory is reclaimed by `compact()`,
+ * which moves the remaining clauses to the front of the arena.
+ */
+template <typename ClauseType>
+class clause_arena {
+public:
+  using clause_type = ClauseType;
+  using size_type = typename ClauseType::size_type;
+
+  /**
+   * \brief Adds a clause with `num_lits` literals to the arena.
+   *
+   * The literals of the new clause are zero-initialized.
+   *
+   * \throws std::length_error  Thrown when the clause cannot be addressed via 32-bit
+   *                            clause references.
+   */
+  auto allocate(size_type num_lits) -> clause_ref;
+
+  /**
+   * \brief Adds a clause consisting of the literals `[start, stop)` to the arena.
+   *
+   * \throws std::length_error  Thrown when the clause cannot be addressed via 32-bit
+   *                            clause references.
+   */
+  auto add_clause(lit const* start, lit const* stop) -> clause_ref;
+
+  auto resolve(clause_ref ref) noexcept -> ClauseType&;
+  auto resolve(clause_ref ref) const noexcept -> ClauseType const&;
+
+  /**
+   * \brief Reserves memory for `num_clauses` clauses having `num_lits` literals in total.
+   */
+  void reserve(size_t num_clauses, size_t num_lits);
+
+  /**
+   * \brief Returns the size of the memory occupied by clauses, in bytes.
+   */
+  auto get_mem_size() const noexcept -> size_t;
+
+  /**
+   * \brief Marks the referenced clause as deleted.
+   *
+   * The clause remains accessible until the next compaction.
+   */
+  void mark_deleted(clause_ref ref);
+
+  auto is_deleted(clause_ref ref) const noexcept -> bool;
+
+  /**
+   * \brief Returns the size of the memory occupied by clauses marked as deleted, in bytes.
+   */
+  auto get_deleted_mem_size() const noexcept -> size_t;
+
+  /**
+   * \brief Removes all clauses from the arena except for the clauses referenced by `refs`
+   *        that are not marked as deleted.
+   *
+   * The remaining clauses are moved to the front of the arena, in their current
+   * order, without allocating a second buffer. Memory freed by shrinking clauses
+   * (see `clause::shrink()`) is reclaimed as well.
+   *
+   * After the compaction, `refs` contains the references of the remaining
+   * clauses, ordered by their position in the arena. Other references can be
+   * updated via the returned forwarding table.
+   *
+   * The compaction takes linear time if `refs` is ordered by the positions of
+   * the clauses in the arena (e.g. when the clauses have been added in the
+   * order of `refs`), and O(n log n) time otherwise. `refs` must not contain
+   * duplicates.
+   */
+  auto compact(std::vector<clause_ref>& refs) -> clause_forwarding_table;
+
+  /**
+   * \brief Like `compact(refs)`, but orders the remaining clauses by the key
+   *        `key_fn(clause)`, e.g. by their size (see `clause_size_key`).
+   *
+   * Clauses with equal keys keep their relative order. Since reordering the
+   * clauses in place is not possible, the remaining clauses are copied to a
+   * new buffer of the size of the remaining clauses.
+   */
+  template <typename KeyFn>
+  auto compact(std::vector<clause_ref>& refs, KeyFn&& key_fn) -> clause_forwarding_table;
+
+  void clear() noexcept;
+
+private:
+  static_assert(alignof(ClauseType) <= alignof(uint32_t),
+                "clause types stored in arenas must not require more than 32-bit alignment");
+
+  constexpr static auto get_num_words(size_type num_lits) noexcept -> size_t;
+
+  // Removes references to deleted clauses and sorts the references by position
+  void prepare_compaction(std::vector<clause_ref>& refs) const;
+
+  void finish_compaction(std::vector<clause_ref>& refs, clause_forwarding_table& forwarding);
+
+  std::vector<uint32_t> m_memory;
+
+  // m_is_deleted[i] is true iff a deleted clause starts at m_memory[i]. Only
+  // grown when clauses are marked as deleted.
+  std::vector<bool> m_is_deleted;
+  size_t m_num_deleted_words = 0;
+};
+
+// *** Implementation ***
+
+constexpr auto operator==(clause_ref lhs, clause_ref rhs) noexcept -> bool
+{
+  return lhs.get_raw_value() == rhs.get_raw_value();
+}
+
+constexpr auto operator!=(clause_ref lhs, clause_ref rhs) noexcept -> bool
+{
+  return !(lhs == rhs);
+}
+
+constexpr auto operator<(clause_ref lhs, clause_ref rhs) noexcept -> bool
+{
+  return lhs.get_raw_value() < rhs.get_raw_value();
+}
+
+inline auto clause_forwarding_table::forward(clause_ref old_ref) const noexcept
+    -> std::optional<clause_ref>
+{
+  auto const iter = std::lower_bound(
+      m_forwarding.begin(),
+      m_forwarding.end(),
+      old_ref,
+      [](std::pair<clause_ref, clause_ref> const& entry, clause_ref ref) {
+        return entry.first < ref;
+      });
+
+  if (iter == m_forwarding.end() || iter->first != old_ref) {
+    return std::nullopt;
+  }
+  return iter->second;
+}
+
+inline auto clause_forwarding_table::size() const noexcept -> size_t
+{
+  return m_forwarding.size();
+}
+
+template <typename ClauseType>
+constexpr auto clause_arena<ClauseType>::get_num_words(size_type num_lits) noexcept -> size_t
+{
+  size_t const mem_size = ClauseType::get_mem_size(num_lits);
+  return (mem_size + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+}
+
+template <typename ClauseType>
+auto clause_arena<ClauseType>::allocate(size_type num_lits) -> clause_ref
+{
+  size_t const offset = m_memory.size();
+  size_t const num_words = get_num_words(num_lits);
+
+  if (offset > std::numeric_limits<uint32_t>::max() ||
+      num_words > std::numeric_limits<uint32_t>::max() - offset) {
+    throw std::length_error{"clause arena exceeds the maximum size"};
+  }
+
+  m_memory.resize(offset + num_words);
+
+  ClauseType::construct_in(reinterpret_cast<unsigned char*>(m_memory.data() + offset), num_lits);
+  return clause_ref{static_cast<uint32_t>(offset)};
+}
+
+template <typename ClauseType>
+auto clause_arena<ClauseType>::add_clause(lit const* start, lit const* stop) -> clause_ref
+{
+  clause_ref const result = allocate(static_cast<size_type>(stop - start));
+  std::copy(start, stop, resolve(result).begin());
+  return result;
+}
+
+template <typename ClauseType>
+auto clause_arena<ClauseType>::resolve(clause_ref ref) noexcept -> ClauseType&
+{
+  assert(ref.get_raw_value() < m_memory.size());
+  return *reinterpret_cast<ClauseType*>(m_memory.data() + ref.get_raw_value());
+}
+
+template <typename ClauseType>
+auto clause_arena<ClauseType>::resolve(clause_ref ref) const noexcept -> ClauseType const&
+{
+  assert(ref.get_raw_value() < m_memory.size());
+  return *reinterpret_cast<ClauseType const*>(m_memory.data() + ref.get_raw_value());
+}
+
+template <typename ClauseType>
+void clause_arena<ClauseType>::reserve(size_t num_clauses, size_t num_lits)
+{
+  size_t const num_lit_words = num_lits * sizeof(lit) / sizeof(uint32_t);
+  size_t const num_words = num_clauses * get_num_words(0) + num_lit_words;
+  m_memory.reserve(m_memory.size() + num_words);
+}
+
+template <typename ClauseType>
+auto clause_arena<ClauseType>::get_mem_size() const noexcept -> size_t
+{
+  return m_memory.size() * sizeof(uint32_t);
+}
+
+template <typename ClauseType>
+void clause_arena<ClauseType>::mark_deleted(clause_ref ref)
+{
+  if (is_deleted(ref)) {
+    return;
+  }
+
+  if (m_is_deleted.size() < m_memory.size()) {
+    m_is_deleted.resize(m_memory.size());
+  }
+
+  m_is_deleted[ref.get_raw_value()] = true;
+  m_num_deleted_words += get_num_words(resolve(ref).size());
+}
+
+template <typename ClauseType>
+auto clause_arena<ClauseType>::is_deleted(clause_ref ref) const noexcept -> bool
+{
+  return ref.get_raw_value() < m_is_deleted.size() && m_is_deleted[ref.get_raw_value()];
+}
+
+template <typename ClauseType>
+auto clause_arena<ClauseType>::get_deleted_mem_size() const noexcept -> size_t
+{
+  return m_num_deleted_words * sizeof(uint32_t);
+}
+
+template <typename ClauseType>
+void clause_arena<ClauseType>::prepare_compaction(std::vector<clause_ref>& refs) const
+{
+  refs.erase(std::remove_if(refs.begin(),
+                            refs.end(),
+                            [this](clause_ref ref) { return is_deleted(ref); }),
+             refs.end());
+
+  if (!std::is_sorted(refs.begin(), refs.end())) {
+    std::sort(refs.begin(), refs.end());
+  }
+}
+
+template <typename ClauseType>
+void clause_arena<ClauseType>::finish_compaction(std::vector<clause_ref>& refs,
+                                                 clause_forwarding_table& forwarding)
+{
+  for (size_t idx = 0; idx < refs.size(); ++idx) {
+    refs[idx] = forwarding.m_forwarding[idx].second;
+  }
+
+  if (!std::is_sorted(refs.begin(), refs.end())) {
+    std::sort(refs.begin(), refs.end());
+  }
+
+  m_is_deleted.clear();
+  m_num_deleted_words = 0;
+}
+
+template <typename ClauseType>
+auto clause_arena<ClauseType>::compact(std::vector<clause_ref>& refs) -> clause_forwarding_table
+{
+  prepare_compaction(refs);
+
+  clause_forwarding_table result;
+  result.m_forwarding.reserve(refs.size());
+
+  // Since the clauses are processed in the order of their positions, each
+  // clause is moved to a position not exceeding its current position, and
+  // only to memory not occupied by clauses yet to be moved
+  size_t fill = 0;
+  for (clause_ref const old_ref : refs) {
+    size_t const num_words = get_num_words(resolve(old_ref).size());
+    if (fill != old_ref.get_raw_value()) {
+      std::memmove(m_memory.data() + fill,
+                   m_memory.data() + old_ref.get_raw_value(),
+                   num_words * sizeof(uint32_t));
+    }
+    result.m_forwarding.emplace_back(old_ref, clause_ref{static_cast<uint32_t>(fill)});
+    fill += num_words;
+  }
+
+  m_memory.resize(fill);
+  finish_compaction(refs, result);
+  return result;
+}
+
+template <typename ClauseType>
+template <typename KeyFn>
+auto clause_arena<ClauseType>::compact(std::vector<clause_ref>& refs, KeyFn&& key_fn)
+    -> clause_forwarding_table
+{
+  prepare_compaction(refs);
+
+  std::vector<clause_ref> new_order = refs;
+  auto const by_key = [this, &key_fn](clause_ref lhs, clause_ref rhs) {
+    return key_fn(resolve(lhs)) < key_fn(resolve(rhs));
+  };
+  std::stable_sort(new_order.begin(), new_order.end(), by_key);
+
+  size_t num_live_words = 0;
+  for (clause_ref const ref : new_order) {
+    num_live_words += get_num_words(resolve(ref).size());
+  }
+
+  clause_forwarding_table result;
+  result.m_forwarding.reserve(refs.size());
+
+  std::vector<uint32_t> new_memory;
+  new_memory.reserve(num_live_words);
+  for (clause_ref const old_ref : new_order) {
+    uint32_t const* const clause_start = m_memory.data() + old_ref.get_raw_value();
+    size_t const num_words = get_num_words(resolve(old_ref).size());
+    clause_ref const new_ref{static_cast<uint32_t>(new_memory.size())};
+    result.m_forwarding.emplace_back(old_ref, new_ref);
+    new_memory.insert(new_memory.end(), clause_start, clause_start + num_words);
+  }
+
+  std::sort(result.m_forwarding.begin(), result.m_forwarding.end());
+  m_memory = std::move(new_memory);
+  finish_compaction(refs, result);
+  return result;
+}
+
+template <typename ClauseType>
+void clause_arena<ClauseType>::clear() noexcept
+{
+  m_memory.clear();
+  m_is_deleted.clear();
+  m_num_deleted_words = 0;
+}
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+/**
+ * \file
+ */
+
+#include <cnfkit/detail/check_cxx_version.h>
+
+#include <cnfkit/literal.h>
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace cnfkit {
+
+/**
+ * \brief The default maximum number of clauses per batch delivered by the
+ *        batching parsers.
+ *
+ * \ingroup dimacs_parsers
+ */
+constexpr size_t default_max_clause_batch_size = 4096;
+
+/**
+ * \brief Sequence of clauses stored in a flat buffer.
+ *
+ * \ingroup dimacs_parsers
+ *
+ * The literals of all clauses are stored consecutively in `get_lits()`.
+ * The literals of clause `i` are stored in the range
+ * `[get_lits() + get_offsets()[i], get_lits() + get_offsets()[i+1])`,
+ * i.e. the offsets form the row index of a CSR (compressed sparse row)
+ * layout, with `get_offsets()` having `size() + 1` elements.
+ *
+ * For clauses read from DRAT proofs, `is_added(i)` is true if and only if
+ * clause `i` is added to the proof. For clauses read from CNF data,
+ * `is_added(i)` is always true.
+ *
+ * Clauses can be added at once via `add_clause()`, or built literal by literal
+ * via `add_lit()` and `finish_clause()`. The literals of an unfinished clause
+ * are not part of the batch: they are neither counted by `get_num_lits()` nor
+ * removed by `clear()`.
+ */
+class clause_batch {
+public:
+  clause_batch();
+
+  auto size() const noexcept -> size_t;
+  auto empty() const noexcept -> bool;
+
+  auto get_num_lits() const noexcept -> size_t;
+  auto get_lits() const noexcept -> lit const*;
+  auto get_offsets() const noexcept -> size_t const*;
+
+  auto clause_start(size_t idx) const noexcept -> lit const*;
+  auto clause_stop(size_t idx) const noexcept -> lit const*;
+  auto is_added(size_t idx) const noexcept -> bool;
+
+  void add_clause(lit const* start, lit const* stop, bool is_added = true);
+
+  void add_lit(lit literal);
+  void finish_clause(bool is_added = true);
+  auto has_unfinished_clause() const noexcept -> bool;
+
+  void clear() noexcept;
+
+private:
+  std::vector<lit> m_lits;
+  std::vector<size_t> m_offsets;
+  std::vector<bool> m_is_added;
+};
+
+/**
+ * \brief View of a single clause, as returned by the pull-based readers.
+ *
+ * \ingroup dimacs_parsers
+ *
+ * The literals of the clause are stored in `[start, stop)`. For clauses read
+ * from DRAT proofs, `is_added` is true if and only if the clause is added to
+ * the proof. For clauses read from CNF data, `is_added` is always true.
+ */
+struct clause_view {
+  lit const* start = nullptr;
+  lit const* stop = nullptr;
+  bool is_added = true;
+
+  auto begin() const noexcept -> lit const*;
+  auto end() const noexcept -> lit const*;
+  auto size() const noexcept -> size_t;
+  auto empty() const noexcept -> bool;
+};
+
+// *** Implementation ***
+
+inline auto clause_view::begin() const noexcept -> lit const*
+{
+  return start;
+}
+
+inline auto clause_view::end() const noexcept -> lit const*
+{
+  return stop;
+}
+
+inline auto clause_view::size() const noexcept -> size_t
+{
+  return stop - start;
+}
+
+inline auto clause_view::empty() const noexcept -> bool
+{
+  return start == stop;
+}
+
+inline clause_batch::clause_batch() : m_offsets{0} {}
+
+inline auto clause_batch::size() const noexcept -> size_t
+{
+  return m_is_added.size();
+}
+
+inline auto clause_batch::empty() const noexcept -> bool
+{
+  return m_is_added.empty();
+}
+
+inline auto clause_batch::get_num_lits() const noexcept -> size_t
+{
+  return m_offsets.back();
+}
+
+inline auto clause_batch::get_lits() const noexcept -> lit const*
+{
+  return m_lits.data();
+}
+
+inline auto clause_batch::get_offsets() const noexcept -> size_t const*
+{
+  return m_offsets.data();
+}
+
+inline auto clause_batch::clause_start(size_t idx) const noexcept -> lit const*
+{
+  assert(idx < size());
+  return m_lits.data() + m_offsets[idx];
+}
+
+inline auto clause_batch::clause_stop(size_t idx) const noexcept -> lit const*
+{
+  assert(idx < size());
+  return m_lits.data() + m_offsets[idx + 1];
+}
+
+inline auto clause_batch::is_added(size_t idx) const noexcept -> bool
+{
+  assert(idx < size());
+  return m_is_added[idx];
+}
+
+inline void clause_batch::add_clause(lit const* start, lit const* stop, bool is_added)
+{
+  assert(!has_unfinished_clause());
+  m_lits.insert(m_lits.end(), start, stop);
+  finish_clause(is_added);
+}
+
+inline void clause_batch::add_lit(lit literal)
+{
+  m_lits.push_back(literal);
+}
+
+inline void clause_batch::finish_clause(bool is_added)
+{
+  m_offsets.push_back(m_lits.size());
+  m_is_added.push_back(is_added);
+}
+
+inline auto clause_batch::has_unfinished_clause() const noexcept -> bool
+{
+  return m_lits.size() != m_offsets.back();
+}
+
+inline void clause_batch::clear() noexcept
+{
+  m_lits.erase(m_lits.begin(), m_lits.begin() + m_offsets.back());
+  m_offsets.resize(1);
+  m_is_added.clear();
+}
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+/**
+ * \file
+ */
+
+#include <cnfkit/detail/check_cxx_version.h>
+
+#include <cnfkit/clause.h>
+#include <cnfkit/clause_arena.h>
+#include <cnfkit/detail/cnflike_parser.h>
+#include <cnfkit/detail/dimacs_parser.h>
+#include <cnfkit/dimacs_parser.h>
+#include <cnfkit/io.h>
+#include <cnfkit/literal.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace cnfkit {
+
+/**
+ * \brief Clause type of cnf_formula.
+ *
+ * \ingroup formulas
+ */
+class cnf_clause final : public clause<cnf_clause> {
+private:
+  friend class clause<cnf_clause>;
+  explicit cnf_clause(size_type size) : clause<cnf_clause>(size) {}
+};
+
+/**
+ * \brief CNF formula storing its clauses in a clause_arena.
+ *
+ * \ingroup formulas
+ *
+ * The clauses are stored contiguously, each consisting of a 32-bit size
+ * field followed by its literals. Compared to storing clauses as vectors,
+ * this avoids one heap allocation and its bookkeeping per clause.
+ */
+class cnf_formula {
+public:
+  /**
+   * \brief Adds the clause consisting of the literals `[start, stop)` to the formula.
+   *
+   * \throws std::length_error  Thrown when the clause cannot be addressed via 32-bit
+   *                            clause references.
+   */
+  auto add_clause(lit const* start, lit const* stop) -> clause_ref;
+
+  /**
+   * \brief Returns the number of clauses.
+   */
+  auto size() const noexcept -> size_t;
+  auto empty() const noexcept -> bool;
+
+  /**
+   * \brief Returns the `idx`th clause, counting in the order in which the clauses have been added.
+   */
+  auto operator[](size_t idx) noexcept -> cnf_clause&;
+  auto operator[](size_t idx) const noexcept -> cnf_clause const&;
+
+  auto resolve(clause_ref ref) noexcept -> cnf_clause&;
+  auto resolve(clause_ref ref) const noexcept -> cnf_clause const&;
+
+  /**
+   * \brief Returns the references of all clauses, in the order in which they have been added.
+   */
+  auto get_clause_refs() const noexcept -> std::vector<clause_ref> const&;
+
+  /**
+   * \brief Reserves memory for `num_clauses` clauses having `num_lits` literals in total.
+   */
+  void reserve(size_t num_clauses, size_t num_lits);
+
+private:
+  clause_arena<cnf_clause> m_arena;
+  std::vector<clause_ref> m_clause_refs;
+};
+
+/**
+ * \brief Parses a source object containing a DIMACS CNF problem instance into a cnf_formula.
+ *
+ * \ingroup formulas
+ *
+ * The source is parsed as by `parse_cnf()`. Memory for the formula is
+ * reserved in advance according to the number of clauses given in the
+ * DIMACS header.
+ *
+ * \throws std::invalid_argument   when parsing the input failed.
+ * \throws std::runtime_error      on I/O failure.
+ * \throws std::length_error       when the formula is too large to be addressed via 32-bit
+ *                                 clause references.
+ */
+auto load_cnf(source& source) -> cnf_formula;
+
+// *** Implementation ***
+
+inline auto cnf_formula::add_clause(lit const* start, lit const* stop) -> clause_ref
+{
+  clause_ref const result = m_arena.add_clause(start, stop);
+  m_clause_refs.push_back(result);
+  return result;
+}
+
+inline auto cnf_formula::size() const noexcept -> size_t
+{
+  return m_clause_refs.size();
+}
+
+inline auto cnf_formula::empty() const noexcept -> bool
+{
+  return m_clause_refs.empty();
+}
+
+inline auto cnf_formula::operator[](size_t idx) noexcept -> cnf_clause&
+{
+  assert(idx < m_clause_refs.size());
+  return m_arena.resolve(m_clause_refs[idx]);
+}
+
+inline auto cnf_formula::operator[](size_t idx) const noexcept -> cnf_clause const&
+{
+  assert(idx < m_clause_refs.size());
+  return m_arena.resolve(m_clause_refs[idx]);
+}
+
+inline auto cnf_formula::resolve(clause_ref ref) noexcept -> cnf_clause&
+{
+  return m_arena.resolve(ref);
+}
+
+inline auto cnf_formula::resolve(clause_ref ref) const noexcept -> cnf_clause const&
+{
+  return m_arena.resolve(ref);
+}
+
+inline auto cnf_formula::get_clause_refs() const noexcept -> std::vector<clause_ref> const&
+{
+  return m_clause_refs;
+}
+
+inline void cnf_formula::reserve(size_t num_clauses, size_t num_lits)
+{
+  m_arena.reserve(num_clauses, num_lits);
+  m_clause_refs.reserve(m_clause_refs.size() + num_clauses);
+}
+
+inline auto load_cnf(source& source) -> cnf_formula
+{
+  using namespace cnfkit::detail;
+
+  cnf_formula result;
+
+  auto reserve = [&result](dimacs_problem_header const& header) {
+    size_t const num_clauses = std::min(header.num_clauses, max_reserved_clauses);
+    result.reserve(num_clauses, num_clauses * estimated_clause_size);
+  };
+
+  auto add_clause = [&result](lit const* start, lit const* stop) {
+    result.add_clause(start, stop);
+  };
+
+  parse_cnf_with_header(source, reserve, add_clause);
+  return result;
+}
+}
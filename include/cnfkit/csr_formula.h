@@ -0,0 +1,381 @@
+#pragma once
+
+/**
+ * \file
+ */
+
+#include <cnfkit/detail/check_cxx_version.h>
+
+#include <cnfkit/detail/cnflike_parser.h>
+#include <cnfkit/detail/dimacs_parser.h>
+#include <cnfkit/dimacs_parser.h>
+#include <cnfkit/io.h>
+#include <cnfkit/literal.h>
+
+#if __has_include(<sys/mman.h>)
+#include <cnfkit/io/io_mmap.h>
+#define CNFKIT_HAS_MMAP_SOURCE 1
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace cnfkit {
+
+/**
+ * \brief Immutable CNF formula stored in CSR (compressed sparse row) layout.
+ *
+ * \ingroup formulas
+ *
+ * The literals of all clauses are stored consecutively in `get_lits()`. The
+ * literals of clause `i` are stored in the range
+ * `[get_lits() + get_offsets()[i], get_lits() + get_offsets()[i+1])`,
+ * with `get_offsets()` having `size() + 1` elements.
+ *
+ * csr_formula objects can be saved in a binary file (see `write_csr_formula()`)
+ * and loaded from it without parsing (see `map_csr_formula()`), e.g. for
+ * caching parsed problem instances.
+ *
+ * Copies of csr_formula objects share their data.
+ */
+class csr_formula {
+public:
+  csr_formula() = default;
+
+  /**
+   * \brief Constructs a csr_formula object from the given literal and offset arrays.
+   *
+   * \throws std::invalid_argument   Thrown when `offsets` is empty, does not start with 0,
+   *                                 is not sorted or does not end with `lits.size()`.
+   */
+  csr_formula(std::vector<lit> lits, std::vector<uint32_t> offsets, size_t num_vars);
+
+  /**
+   * \brief Returns the number of clauses.
+   */
+  auto size() const noexcept -> size_t;
+  auto empty() const noexcept -> bool;
+
+  /**
+   * \brief Returns the number of variables given in the DIMACS header of the formula.
+   */
+  auto get_num_vars() const noexcept -> size_t;
+
+  auto get_num_lits() const noexcept -> size_t;
+  auto get_lits() const noexcept -> lit const*;
+  auto get_offsets() const noexcept -> uint32_t const*;
+
+  auto clause_start(size_t idx) const noexcept -> lit const*;
+  auto clause_stop(size_t idx) const noexcept -> lit const*;
+
+private:
+#if defined(CNFKIT_HAS_MMAP_SOURCE)
+  friend auto map_csr_formula(std::filesystem::path const& path) -> csr_formula;
+#endif
+
+  constexpr static uint32_t empty_offsets[1] = {0};
+
+  // Owner of the data referenced by the members below
+  std::shared_ptr<void const> m_storage;
+
+  lit const* m_lits = nullptr;
+  uint32_t const* m_offsets = empty_offsets;
+  size_t m_num_clauses = 0;
+  size_t m_num_lits = 0;
+  size_t m_num_vars = 0;
+};
+
+/**
+ * \brief Parses a source object containing a DIMACS CNF problem instance into a csr_formula.
+ *
+ * \ingroup formulas
+ *
+ * The source is parsed as by `parse_cnf()`.
+ *
+ * \throws std::invalid_argument   when parsing the input failed.
+ * \throws std::runtime_error      on I/O failure.
+ * \throws std::length_error       when the formula has more than `2^32 - 1` literals.
+ */
+auto parse_cnf_to_csr(source& source) -> csr_formula;
+
+/**
+ * \brief Writes the formula to `sink` in the binary csr_formula file format.
+ *
+ * \ingroup formulas
+ *
+ * The file format consists of a 40-byte header, followed by the offset
+ * array and the literal array of the formula. All values are stored in the
+ * byte order of the writing machine.
+ *
+ * \throws std::runtime_error      on I/O failure.
+ */
+void write_csr_formula(csr_formula const& formula, sink& sink);
+
+/**
+ * \brief Reads a formula in the binary csr_formula file format from `source`.
+ *
+ * \ingroup formulas
+ *
+ * \throws std::invalid_argument   when the data is not a valid csr_formula file written on a
+ *                                 machine with the same byte order.
+ * \throws std::runtime_error      on I/O failure.
+ */
+auto read_csr_formula(source& source) -> csr_formula;
+
+#if defined(CNFKIT_HAS_MMAP_SOURCE)
+/**
+ * \brief Maps a file in the binary csr_formula file format into memory.
+ *
+ * \ingroup formulas
+ *
+ * The returned formula references the mapped file directly, so apart from
+ * checking the offsets array, loading takes constant time. The file must not
+ * be modified while the formula (or any copy) exists.
+ *
+ * Only available on POSIX systems.
+ *
+ * \throws std::invalid_argument   when the file is not a valid csr_formula file written on a
+ *                                 machine with the same byte order.
+ * \throws std::runtime_error      when the file could not be opened or mapped.
+ */
+auto map_csr_formula(std::filesystem::path const& path) -> csr_formula;
+#endif
+
+// *** Implementation ***
+
+namespace detail {
+struct csr_file_header {
+  char magic[8];
+  uint32_t byte_order_mark;
+  uint32_t reserved;
+  uint64_t num_vars;
+  uint64_t num_clauses;
+  uint64_t num_lits;
+};
+
+constexpr char csr_file_magic[8] = {'C', 'N', 'F', 'K', 'C', 'S', 'R', '1'};
+constexpr uint32_t csr_file_byte_order_mark = 0x01020304;
+
+static_assert(sizeof(csr_file_header) == 40);
+static_assert(sizeof(lit) == sizeof(uint32_t));
+
+inline void check_csr_offsets(uint32_t const* offsets, size_t num_clauses, size_t num_lits)
+{
+  if (offsets[0] != 0 || offsets[num_clauses] != num_lits ||
+      !std::is_sorted(offsets, offsets + num_clauses + 1)) {
+    throw std::invalid_argument{"invalid clause offsets"};
+  }
+}
+
+// Returns the size of the offset and literal arrays in bytes
+inline auto check_csr_file_header(csr_file_header const& header) -> size_t
+{
+  if (std::memcmp(header.magic, csr_file_magic, sizeof(csr_file_magic)) != 0) {
+    throw std::invalid_argument{"not a csr_formula file"};
+  }
+
+  if (header.byte_order_mark != csr_file_byte_order_mark) {
+    throw std::invalid_argument{"csr_formula file has been written with a different byte order"};
+  }
+
+  if (header.num_clauses >= std::numeric_limits<uint32_t>::max() ||
+      header.num_lits > std::numeric_limits<uint32_t>::max()) {
+    throw std::invalid_argument{"invalid csr_formula file header"};
+  }
+
+  return (header.num_clauses + 1 + header.num_lits) * sizeof(uint32_t);
+}
+}
+
+inline csr_formula::csr_formula(std::vector<lit> lits,
+                                std::vector<uint32_t> offsets,
+                                size_t num_vars)
+{
+  if (offsets.empty() || lits.size() > std::numeric_limits<uint32_t>::max()) {
+    throw std::invalid_argument{"invalid clause offsets"};
+  }
+  detail::check_csr_offsets(offsets.data(), offsets.size() - 1, lits.size());
+
+  auto storage = std::make_shared<std::pair<std::vector<lit>, std::vector<uint32_t>>>(
+      std::move(lits), std::move(offsets));
+
+  m_lits = storage->first.data();
+  m_offsets = storage->second.data();
+  m_num_clauses = storage->second.size() - 1;
+  m_num_lits = storage->first.size();
+  m_num_vars = num_vars;
+  m_storage = std::move(storage);
+}
+
+inline auto csr_formula::size() const noexcept -> size_t
+{
+  return m_num_clauses;
+}
+
+inline auto csr_formula::empty() const noexcept -> bool
+{
+  return m_num_clauses == 0;
+}
+
+inline auto csr_formula::get_num_vars() const noexcept -> size_t
+{
+  return m_num_vars;
+}
+
+inline auto csr_formula::get_num_lits() const noexcept -> size_t
+{
+  return m_num_lits;
+}
+
+inline auto csr_formula::get_lits() const noexcept -> lit const*
+{
+  return m_lits;
+}
+
+inline auto csr_formula::get_offsets() const noexcept -> uint32_t const*
+{
+  return m_offsets;
+}
+
+inline auto csr_formula::clause_start(size_t idx) const noexcept -> lit const*
+{
+  assert(idx < m_num_clauses);
+  return m_lits + m_offsets[idx];
+}
+
+inline auto csr_formula::clause_stop(size_t idx) const noexcept -> lit const*
+{
+  assert(idx < m_num_clauses);
+  return m_lits + m_offsets[idx + 1];
+}
+
+inline auto parse_cnf_to_csr(source& source) -> csr_formula
+{
+  using namespace cnfkit::detail;
+
+  std::vector<lit> lits;
+  std::vector<uint32_t> offsets{0};
+  size_t num_vars = 0;
+
+  auto reserve = [&](dimacs_problem_header const& header) {
+    size_t const num_clauses = std::min(header.num_clauses, max_reserved_clauses);
+    lits.reserve(num_clauses * estimated_clause_size);
+    offsets.reserve(num_clauses + 1);
+    num_vars = header.num_vars;
+  };
+
+  auto add_clause = [&lits, &offsets](lit const* start, lit const* stop) {
+    if (static_cast<size_t>(stop - start) > std::numeric_limits<uint32_t>::max() - lits.size()) {
+      throw std::length_error{"csr_formula exceeds the maximum number of literals"};
+    }
+    lits.insert(lits.end(), start, stop);
+    offsets.push_back(static_cast<uint32_t>(lits.size()));
+  };
+
+  parse_cnf_with_header(source, reserve, add_clause);
+  return csr_formula{std::move(lits), std::move(offsets), num_vars};
+}
+
+inline void write_csr_formula(csr_formula const& formula, sink& sink)
+{
+  detail::csr_file_header header;
+  std::memcpy(header.magic, detail::csr_file_magic, sizeof(header.magic));
+  header.byte_order_mark = detail::csr_file_byte_order_mark;
+  header.reserved = 0;
+  header.num_vars = formula.get_num_vars();
+  header.num_clauses = formula.size();
+  header.num_lits = formula.get_num_lits();
+
+  auto const* header_start = reinterpret_cast<std::byte const*>(&header);
+  sink.write_bytes(header_start, header_start + sizeof(header));
+
+  auto const* offsets_start = reinterpret_cast<std::byte const*>(formula.get_offsets());
+  sink.write_bytes(offsets_start, offsets_start + (formula.size() + 1) * sizeof(uint32_t));
+
+  auto const* lits_start = reinterpret_cast<std::byte const*>(formula.get_lits());
+  sink.write_bytes(lits_start, lits_start + formula.get_num_lits() * sizeof(lit));
+}
+
+inline auto read_csr_formula(source& source) -> csr_formula
+{
+  auto read_exactly = [&source](void* start, size_t size) {
+    std::byte* const buf_start = static_cast<std::byte*>(start);
+    if (source.read_bytes(buf_start, buf_start + size) != buf_start + size) {
+      throw std::invalid_argument{"unexpected end of csr_formula file"};
+    }
+  };
+
+  detail::csr_file_header header;
+  read_exactly(&header, sizeof(header));
+  detail::check_csr_file_header(header);
+
+  // Not reserving memory according to the header before having checked that
+  // the data is actually present, since the header might be bogus
+  std::vector<uint32_t> offsets;
+  std::vector<lit> lits;
+  auto read_array = [&read_exactly](auto& array, size_t size) {
+    constexpr size_t max_step = size_t{1} << 20;
+    while (array.size() < size) {
+      size_t const old_size = array.size();
+      array.resize(std::min(size, old_size + max_step));
+      read_exactly(array.data() + old_size, (array.size() - old_size) * sizeof(uint32_t));
+    }
+  };
+
+  read_array(offsets, header.num_clauses + 1);
+  read_array(lits, header.num_lits);
+
+  if (!source.is_eof()) {
+    throw std::invalid_argument{"unexpected data at the end of csr_formula file"};
+  }
+
+  return csr_formula{std::move(lits), std::move(offsets), header.num_vars};
+}
+
+#if defined(CNFKIT_HAS_MMAP_SOURCE)
+inline auto map_csr_formula(std::filesystem::path const& path) -> csr_formula
+{
+  auto mapping = std::make_shared<mmap_source>(path);
+  std::optional<byte_range> const data = mapping->borrow_bytes();
+  assert(data.has_value());
+
+  size_t const data_size = data->stop - data->start;
+  if (data_size < sizeof(detail::csr_file_header)) {
+    throw std::invalid_argument{"unexpected end of csr_formula file"};
+  }
+
+  detail::csr_file_header header;
+  std::memcpy(&header, data->start, sizeof(header));
+  size_t const arrays_size = detail::check_csr_file_header(header);
+  if (data_size != sizeof(header) + arrays_size) {
+    throw std::invalid_argument{"invalid csr_formula file size"};
+  }
+
+  // mmap_source advises the kernel that the data is read sequentially, but
+  // formulas are typically accessed repeatedly and in random order
+  ::madvise(const_cast<std::byte*>(data->start), data_size, MADV_NORMAL);
+
+  // The mapping is page-aligned, and the header size is a multiple of 4
+  auto const* offsets = reinterpret_cast<uint32_t const*>(data->start + sizeof(header));
+  detail::check_csr_offsets(offsets, header.num_clauses, header.num_lits);
+
+  csr_formula result;
+  result.m_offsets = offsets;
+  result.m_lits = reinterpret_cast<lit const*>(offsets + header.num_clauses + 1);
+  result.m_num_clauses = header.num_clauses;
+  result.m_num_lits = header.num_lits;
+  result.m_num_vars = header.num_vars;
+  result.m_storage = std::move(mapping);
+  return result;
+}
+#endif
+}
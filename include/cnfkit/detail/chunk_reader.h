@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cnfkit/io.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+namespace cnfkit::detail {
+
+/**
+ * Reads data from a source in chunks ending with a complete token.
+ *
+ * `IsTokenEnd` is a predicate on `std::byte` that returns true if and only if
+ * the given byte terminates a token. Chunks end with such a byte unless the
+ * source has reached EOF.
+ *
+ * The data is obtained block-wise via `source::next_block()`, so the source is
+ * only asked for bulk reads, and the chunks point directly into the blocks
+ * lent by sources (see `source::borrow_bytes()`). Only the unfinished token at
+ * the end of a block is copied to a carry-over buffer and prepended to the
+ * next chunk. Large lent blocks are returned in slices, so callers can bound
+ * the amount of data processed per chunk even for sources lending all of
+ * their data at once.
+ */
+template <typename IsTokenEnd>
+class chunk_reader {
+public:
+  explicit chunk_reader(source& source) : m_source{source} {}
+
+  /**
+   * Returns the next chunk. The returned range is valid until the next call
+   * to `read_chunk()` and may be empty even if the reader has not reached EOF.
+   * Chunks have a size of up to `desired_size` bytes, unless they contain a
+   * token exceeding `desired_size` bytes.
+   */
+  auto read_chunk(size_t desired_size) -> byte_range
+  {
+    drop_returned_chunk();
+
+    size_t const max_size = std::max<size_t>(desired_size, 1);
+    if (m_block.start == m_block.stop && !m_is_source_eof) {
+      m_block_buffer.resize(max_size);
+      m_block = m_source.next_block(m_block_buffer);
+      m_is_source_eof = m_block.start == m_block.stop;
+    }
+
+    if (m_fill != 0) {
+      // Complete the token split at the end of the previous block
+      std::byte const* token_end = std::find_if(m_block.start, m_block.stop, IsTokenEnd{});
+      bool const found_token_end = token_end != m_block.stop;
+      if (found_token_end) {
+        ++token_end;
+      }
+
+      append(m_block.start, token_end);
+      m_block.start = token_end;
+
+      if (!found_token_end && !m_is_source_eof) {
+        return byte_range{};
+      }
+
+      m_chunk_stop = m_fill;
+      return byte_range{m_buffer.data(), m_buffer.data() + m_fill};
+    }
+
+    if (static_cast<size_t>(m_block.stop - m_block.start) > max_size) {
+      // Return the block in slices ending with complete tokens
+      std::byte const* slice_stop = find_last_token_end(m_block.start, m_block.start + max_size);
+      if (slice_stop == m_block.start) {
+        slice_stop = find_first_token_end(m_block.start + max_size, m_block.stop);
+      }
+
+      if (slice_stop != m_block.stop) {
+        byte_range const result{m_block.start, slice_stop};
+        m_block.start = slice_stop;
+        return result;
+      }
+    }
+
+    byte_range result = m_block;
+    result.stop = find_last_token_end(m_block.start, m_block.stop);
+    append(result.stop, m_block.stop);
+    m_block.start = m_block.stop;
+    return result;
+  }
+
+  // The source is not queried while the returned chunk may point into a
+  // block, since this could invalidate the block. Instead, the end of the data
+  // is detected via the empty block returned at EOF.
+  auto is_eof() const -> bool
+  {
+    return m_is_source_eof && m_block.start == m_block.stop && m_chunk_stop == m_fill;
+  }
+
+private:
+  static auto find_last_token_end(std::byte const* start, std::byte const* stop)
+      -> std::byte const*
+  {
+    auto const last_token_end = std::find_if(
+        std::make_reverse_iterator(stop), std::make_reverse_iterator(start), IsTokenEnd{});
+    return last_token_end.base();
+  }
+
+  // Returns the end of the first token in [start, stop), or `stop` if there is none
+  static auto find_first_token_end(std::byte const* start, std::byte const* stop)
+      -> std::byte const*
+  {
+    std::byte const* const token_end = std::find_if(start, stop, IsTokenEnd{});
+    return token_end == stop ? stop : token_end + 1;
+  }
+
+  // Moves the unfinished token following the previously returned chunk to the front of the buffer
+  void drop_returned_chunk()
+  {
+    if (m_chunk_stop != 0) {
+      std::memmove(m_buffer.data(), m_buffer.data() + m_chunk_stop, m_fill - m_chunk_stop);
+      m_fill -= m_chunk_stop;
+      m_chunk_stop = 0;
+    }
+  }
+
+  void append(std::byte const* start, std::byte const* stop)
+  {
+    size_t const size = stop - start;
+    reserve(m_fill + size);
+    if (size != 0) {
+      std::memcpy(m_buffer.data() + m_fill, start, size);
+    }
+    m_fill += size;
+  }
+
+  void reserve(size_t size)
+  {
+    if (m_buffer.size() < size) {
+      m_buffer.resize(std::max(size, 2 * m_buffer.size()));
+    }
+  }
+
+  source& m_source;
+
+  // The unconsumed part of the current block
+  byte_range m_block;
+  std::vector<std::byte> m_block_buffer;
+  bool m_is_source_eof = false;
+
+  // m_buffer[0, m_chunk_stop) has been returned by read_chunk(), and
+  // m_buffer[m_chunk_stop, m_fill) is carried over to the next chunk
+  std::vector<std::byte> m_buffer;
+  size_t m_chunk_stop = 0;
+  size_t m_fill = 0;
+};
+}
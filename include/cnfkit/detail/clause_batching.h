@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cnfkit/clause_batch.h>
+#include <cnfkit/literal.h>
+
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+
+namespace cnfkit::detail {
+
+inline void check_max_batch_size(size_t max_batch_size)
+{
+  if (max_batch_size == 0) {
+    throw std::invalid_argument{"the maximum batch size must be positive"};
+  }
+}
+
+/**
+ * Collects the clauses passed by `parse` to its argument, a function with
+ * signature `void(bool, lit const*, lit const*)`, into batches of at most
+ * `max_batch_size` clauses, and passes them to `batch_receiver`. The last
+ * batch is only delivered if `parse` returns normally.
+ *
+ * This is used for parsers that cannot build the clauses in a batch directly.
+ */
+template <typename BatchFn, typename ParseFn>
+void parse_in_batches(size_t max_batch_size, BatchFn& batch_receiver, ParseFn&& parse)
+{
+  check_max_batch_size(max_batch_size);
+
+  clause_batch batch;
+  clause_batch const& const_batch = batch;
+
+  parse([&](bool is_added, lit const* start, lit const* stop) {
+    batch.add_clause(start, stop, is_added);
+    if (batch.size() == max_batch_size) {
+      batch_receiver(const_batch);
+      batch.clear();
+    }
+  });
+
+  if (!batch.empty()) {
+    batch_receiver(const_batch);
+  }
+}
+
+/**
+ * Hands out the clauses of a clause_batch one by one, for the pull-based
+ * readers. After all clauses of `batch` have been handed out, the batch is
+ * cleared and refilled by `parse_next_chunk`, a function with signature
+ * `bool()` adding the clauses of the next chunk of input to `batch`, and
+ * returning false at the end of the input. The same batch must be passed to
+ * each call of `next()`. Since clearing a batch keeps its unfinished clause,
+ * a parser can build clauses spanning multiple chunks in the batch.
+ *
+ * Errors thrown by `parse_next_chunk` are reported after the clauses
+ * preceding the error have been handed out, and on every call thereafter.
+ */
+class pulled_clause_batch {
+public:
+  template <typename ParseFn>
+  auto next(clause_batch& batch, ParseFn&& parse_next_chunk) -> std::optional<clause_view>
+  {
+    while (m_cursor == batch.size()) {
+      if (m_error != nullptr) {
+        std::rethrow_exception(m_error);
+      }
+
+      if (m_is_at_end) {
+        return std::nullopt;
+      }
+
+      batch.clear();
+      m_cursor = 0;
+      try {
+        m_is_at_end = !parse_next_chunk();
+      }
+      catch (...) {
+        m_error = std::current_exception();
+      }
+    }
+
+    size_t const idx = m_cursor++;
+    return clause_view{batch.clause_start(idx), batch.clause_stop(idx), batch.is_added(idx)};
+  }
+
+private:
+  size_t m_cursor = 0;
+  bool m_is_at_end = false;
+  std::exception_ptr m_error;
+};
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cnfkit/literal.h>
+
+#include <type_traits>
+#include <vector>
+
+namespace cnfkit::detail {
+
+/*
+ * Clause receivers either accept clauses as `std::vector<lit> const&` or as
+ * spans `(lit const* start, lit const* stop)`, optionally preceded by further
+ * arguments such as the DRAT add/delete flag. Spans are preferred if the
+ * receiver accepts both.
+ */
+
+template <typename Fn, typename... Prefix>
+constexpr bool accepts_lit_span_v = std::is_invocable_v<Fn&, Prefix..., lit const*, lit const*>;
+
+template <typename Fn, typename... Prefix>
+constexpr bool accepts_lit_vector_v = std::is_invocable_v<Fn&, Prefix..., std::vector<lit> const&>;
+
+template <typename Fn, typename... Prefix>
+constexpr void check_clause_receiver()
+{
+  static_assert(accepts_lit_span_v<Fn, Prefix...> || accepts_lit_vector_v<Fn, Prefix...>,
+                "clause receivers must accept either a std::vector<lit> const& or a pair of "
+                "lit const* pointers as clause");
+}
+
+template <typename Fn, typename... Prefix>
+void invoke_clause_receiver(Fn& receiver, std::vector<lit> const& clause, Prefix... prefix)
+{
+  if constexpr (accepts_lit_span_v<Fn, Prefix...>) {
+    receiver(prefix..., clause.data(), clause.data() + clause.size());
+  }
+  else {
+    receiver(prefix..., clause);
+  }
+}
+
+// If the receiver only accepts vectors, the clause is copied to `scratch`
+template <typename Fn, typename... Prefix>
+void invoke_clause_receiver(
+    Fn& receiver, lit const* start, lit const* stop, std::vector<lit>& scratch, Prefix... prefix)
+{
+  if constexpr (accepts_lit_span_v<Fn, Prefix...>) {
+    receiver(prefix..., start, stop);
+  }
+  else {
+    scratch.assign(start, stop);
+    receiver(prefix..., static_cast<std::vector<lit> const&>(scratch));
+  }
+}
+}
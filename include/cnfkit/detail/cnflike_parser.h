@@ -1,127 +1,156 @@
 #pragma once
 
+#include <cnfkit/clause_batch.h>
+#include <cnfkit/detail/chunk_reader.h>
+#include <cnfkit/detail/literal_scanner.h>
+#include <cnfkit/input_policy.h>
 #include <cnfkit/io.h>
 #include <cnfkit/literal.h>
 
+#include <algorithm>
+#include <cctype>
 #include <charconv>
+#include <cstdint>
 #include <optional>
-#include <regex>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 
 
 namespace cnfkit::detail {
 
 constexpr size_t default_chunk_size = (1 << 16);
 
-inline auto is_irrelevant_line(std::string const& line) -> bool
+template <typename It>
+auto skip_whitespace(It start, It stop) -> It
 {
-  return std::regex_match(line, std::regex{"\\s*"}) ||
-         std::regex_match(line, std::regex{"\\s*c.*"});
+  return std::find_if_not(
+      start, stop, [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; });
 }
 
-class cnf_source_reader {
-public:
-  explicit cnf_source_reader(source& source) : m_source{source} {}
+template <typename It>
+auto skip_to_line_end(It start, It stop) -> It
+{
+  return std::find(start, stop, '\n');
+}
 
-  auto read_char() -> std::optional<char>
-  {
-    std::optional<std::byte> result = m_source.read_byte();
-    if (!result.has_value()) {
-      return std::nullopt;
+template <typename It>
+auto skip_dimacs_comments(It start, It stop) -> std::pair<It, bool>
+{
+  auto iter = skip_whitespace(start, stop);
+
+  while (iter != stop && *iter == 'c') {
+    ++iter;
+    iter = skip_to_line_end(iter, stop);
+    if (iter == stop) {
+      return std::make_pair(iter, true);
     }
-    return std::to_integer<char>(*result);
+    iter = skip_whitespace(iter, stop);
+  }
+
+  return std::make_pair(iter, false);
+}
+
+struct is_dimacs_token_end {
+  auto operator()(std::byte byte) const noexcept -> bool
+  {
+    return std::isspace(std::to_integer<unsigned char>(byte)) != 0;
   }
+};
+
+class cnf_source_reader {
+public:
+  explicit cnf_source_reader(source& source) : m_chunk_reader{source} {}
 
   auto read_line() -> std::string
   {
     std::string result;
     constexpr std::string::size_type initial_buf_size = 512;
     result.reserve(initial_buf_size);
-    std::optional<char> character;
-    while ((character = read_char())) {
-      if (*character == '\n') {
+
+    while (!is_eof()) {
+      if (m_pending.empty()) {
+        m_pending = read_raw_chunk(default_chunk_size);
+        continue;
+      }
+
+      size_t const line_end = m_pending.find('\n');
+      if (line_end == std::string_view::npos) {
+        result.append(m_pending);
+        m_pending = std::string_view{};
+      }
+      else {
+        result.append(m_pending.substr(0, line_end));
+        m_pending.remove_prefix(line_end + 1);
         break;
       }
-      result += *character;
     }
+
     return result;
   }
 
+  // Returns the first line that is neither empty nor a comment
   auto read_header_line() -> std::string
   {
-    std::string line;
-    do {
-      line = read_line();
-    } while (is_irrelevant_line(line) && !is_eof());
-
-    return line;
+    skip_header_preamble();
+    return read_line();
   }
 
-  void skip_line()
+  auto read_chunk(size_t desired_size) -> std::string_view
   {
-    std::optional<char> character = '\0';
-    while (character.has_value() && *character != '\n') {
-      character = read_char();
+    if (!m_pending.empty()) {
+      // return the data following the lines read via read_line() first
+      return std::exchange(m_pending, std::string_view{});
     }
+    return read_raw_chunk(desired_size);
   }
 
-  void read_chunk(size_t desired_size, std::string& buffer)
-  {
-    if (desired_size == 0) {
-      buffer.clear();
-      return;
-    }
+  auto is_eof() -> bool { return m_pending.empty() && m_chunk_reader.is_eof(); };
 
-    buffer.resize(desired_size);
-    std::byte* byte_buffer = reinterpret_cast<std::byte*>(buffer.data());
-    std::byte* read_stop = m_source.read_bytes(byte_buffer, byte_buffer + desired_size);
-    buffer.resize(read_stop - byte_buffer);
+private:
+  // Skips whitespace and comment lines in place, without collecting them in lines
+  void skip_header_preamble()
+  {
+    bool is_in_comment = false;
+    while (!is_eof()) {
+      if (m_pending.empty()) {
+        m_pending = read_raw_chunk(default_chunk_size);
+        continue;
+      }
 
-    // if the buffer ends in the middle of a literal, read rest of the literal, too
-    if (!buffer.empty()) {
-      while (!is_eof() && std::isspace(buffer.back()) == 0) {
-        if (std::optional<char> const extra_char = read_char(); extra_char.has_value()) {
-          buffer.push_back(*extra_char);
+      char const* cursor = m_pending.data();
+      char const* const stop = cursor + m_pending.size();
+      if (is_in_comment) {
+        // continuing a comment started in a previous chunk
+        cursor = skip_to_line_end(cursor, stop);
+        if (cursor == stop) {
+          m_pending = std::string_view{};
+          continue;
         }
       }
-    }
-  }
-
-  auto is_eof() -> bool { return m_source.is_eof(); };
-
-private:
-  source& m_source;
-};
-
-template <typename It>
-auto skip_whitespace(It start, It stop) -> It
-{
-  return std::find_if_not(start, stop, [](char c) { return std::isspace(c); });
-}
 
-template <typename It>
-auto skip_to_line_end(It start, It stop) -> It
-{
-  return std::find(start, stop, '\n');
-}
+      auto const [next, ended_in_comment] = skip_dimacs_comments(cursor, stop);
+      is_in_comment = ended_in_comment;
+      m_pending.remove_prefix(next - m_pending.data());
 
-template <typename It>
-auto skip_dimacs_comments(It start, It stop) -> std::pair<It, bool>
-{
-  auto iter = skip_whitespace(start, stop);
-
-  while (iter != stop && *iter == 'c') {
-    ++iter;
-    iter = skip_to_line_end(iter, stop);
-    if (iter == stop) {
-      return std::make_pair(iter, true);
+      if (!m_pending.empty()) {
+        return;
+      }
     }
-    iter = skip_whitespace(iter, stop);
   }
 
-  return std::make_pair(iter, false);
-}
+  auto read_raw_chunk(size_t desired_size) -> std::string_view
+  {
+    byte_range const chunk = m_chunk_reader.read_chunk(desired_size);
+    return std::string_view{reinterpret_cast<char const*>(chunk.start),
+                            static_cast<size_t>(chunk.stop - chunk.start)};
+  }
+
+  chunk_reader<is_dimacs_token_end> m_chunk_reader;
+  std::string_view m_pending;
+};
 
 struct dimacs_problem_header {
   size_t num_vars = 0;
@@ -131,16 +160,37 @@ struct dimacs_problem_header {
 
 enum class cnf_chunk_parser_mode { dimacs, drat };
 
+// Clause receiver used by cnf_chunk_parser::parse_batched(), which makes the
+// parser append the clauses directly to its batch
+template <typename BatchFn>
+struct clause_batch_delivery {
+  BatchFn& batch_receiver;
+  size_t max_batch_size;
+};
+
+template <typename T>
+constexpr bool is_clause_batch_delivery = false;
+
+template <typename BatchFn>
+constexpr bool is_clause_batch_delivery<clause_batch_delivery<BatchFn>> = true;
+
 class cnf_chunk_parser {
 public:
-  explicit cnf_chunk_parser(cnf_chunk_parser_mode mode) : m_mode{mode} {}
+  explicit cnf_chunk_parser(cnf_chunk_parser_mode mode)
+    : cnf_chunk_parser(mode, get_best_scan_kernel())
+  {
+  }
 
-  template <typename UnaryFn>
-  void parse(std::string const& buffer, size_t offset, UnaryFn&& clause_receiver)
+  cnf_chunk_parser(cnf_chunk_parser_mode mode, scan_kernel kernel)
+    : m_mode{mode}, m_classify{get_classify_fn(kernel)}
   {
-    char const* c_end = buffer.c_str() + buffer.size();
-    auto const end = buffer.begin() + buffer.size();
-    auto cursor = buffer.begin() + offset;
+  }
+
+  template <typename InputPolicy = validated_input, typename UnaryFn>
+  void parse(std::string_view buffer, size_t offset, UnaryFn&& clause_receiver)
+  {
+    char const* const end = buffer.data() + buffer.size();
+    char const* cursor = buffer.data() + offset;
 
     if (m_is_in_comment) {
       cursor = skip_to_line_end(cursor, end);
@@ -149,8 +199,14 @@ public:
       }
     }
 
-    int literal = 0;
     while (cursor != end) {
+      cursor = scan_literals(cursor, end, clause_receiver);
+
+      if constexpr (InputPolicy::is_trusted) {
+        cursor = parse_trusted_token(cursor, end, clause_receiver);
+        continue;
+      }
+
       auto [next_lit, ended_in_comment] = skip_dimacs_comments(cursor, end);
 
       m_is_in_comment = ended_in_comment;
@@ -159,7 +215,7 @@ public:
       }
 
       if (m_mode == cnf_chunk_parser_mode::drat && *next_lit == 'd') {
-        if (!m_lit_buffer.empty()) {
+        if (has_open_clause()) {
           throw std::invalid_argument{"syntax error: d may only occur before clauses"};
         }
 
@@ -172,51 +228,237 @@ public:
         m_is_in_delete = true;
       }
 
-      auto [next, errorcode] = std::from_chars(&*next_lit, c_end, literal);
+      int literal = 0;
+      auto [next, errorcode] = std::from_chars(next_lit, end, literal);
 
       if (errorcode != std::errc{}) {
-        if (next == c_end) {
+        if (next == end) {
           return;
         }
         throw std::invalid_argument{"syntax error"};
       }
 
       if (literal != 0) {
-        m_lit_buffer.push_back(dimacs_to_lit(literal));
+        add_lit<UnaryFn>(dimacs_to_lit(literal));
       }
       else {
-        clause_receiver(!m_is_in_delete, m_lit_buffer);
-        m_is_in_delete = false;
-        m_lit_buffer.clear();
-        ++m_num_clauses_read;
+        finish_clause(clause_receiver);
       }
 
-      cursor = buffer.begin() + (next - buffer.c_str());
+      cursor = next;
     }
   }
 
+  // Parses like parse(), but appends the clauses directly to the batch
+  // returned by get_batch(), without building them in a separate buffer first.
+  // Whenever the batch contains `max_batch_size` clauses, it is passed to
+  // `batch_receiver`, a function with signature `void(clause_batch const&)`,
+  // and cleared afterwards.
+  template <typename InputPolicy = validated_input, typename BatchFn>
+  void parse_batched(std::string_view buffer,
+                     size_t offset,
+                     size_t max_batch_size,
+                     BatchFn&& batch_receiver)
+  {
+    clause_batch_delivery<BatchFn> delivery{batch_receiver, max_batch_size};
+    parse<InputPolicy>(buffer, offset, delivery);
+  }
+
+  // The clauses parsed via parse_batched() and not passed to a batch receiver yet
+  auto get_batch() noexcept -> clause_batch& { return m_batch; }
+
   void check_on_dimacs_finish(dimacs_problem_header const& header)
   {
-    if (m_num_clauses_read != header.num_clauses) {
+    check_on_dimacs_finish(header, m_num_clauses_read);
+  }
+
+  // Checks the end of CNF data split between multiple parsers, with this
+  // parser having parsed the last part of the data
+  void check_on_dimacs_finish(dimacs_problem_header const& header, size_t total_num_clauses_read)
+  {
+    if (total_num_clauses_read != header.num_clauses) {
       throw std::invalid_argument{"invalid number of clauses in CNF data"};
     }
 
-    if (!m_lit_buffer.empty()) {
+    if (has_open_clause()) {
       throw std::invalid_argument{"CNF data ends in open clause"};
     }
   }
 
+  auto get_num_clauses_read() const noexcept -> size_t { return m_num_clauses_read; }
+
   void check_on_drat_finish()
   {
-    if (!m_lit_buffer.empty() || m_is_in_delete) {
+    if (has_open_clause() || m_is_in_delete) {
       throw std::invalid_argument{"Proof data ends in open clause"};
     }
   }
 
 private:
+  // Clauses are built in m_batch when parsing via parse_batched(), and in
+  // m_lit_buffer otherwise
+  template <typename UnaryFn>
+  void add_lit(lit literal)
+  {
+    if constexpr (is_clause_batch_delivery<std::decay_t<UnaryFn>>) {
+      m_batch.add_lit(literal);
+    }
+    else {
+      m_lit_buffer.push_back(literal);
+    }
+  }
+
+  template <typename UnaryFn>
+  void finish_clause(UnaryFn& clause_receiver)
+  {
+    if constexpr (is_clause_batch_delivery<std::decay_t<UnaryFn>>) {
+      m_batch.finish_clause(!m_is_in_delete);
+      if (m_batch.size() == clause_receiver.max_batch_size) {
+        clause_receiver.batch_receiver(std::as_const(m_batch));
+        m_batch.clear();
+      }
+    }
+    else {
+      clause_receiver(!m_is_in_delete, m_lit_buffer);
+      m_lit_buffer.clear();
+    }
+    m_is_in_delete = false;
+    ++m_num_clauses_read;
+  }
+
+  auto has_open_clause() const noexcept -> bool
+  {
+    return !m_lit_buffer.empty() || m_batch.has_unfinished_clause();
+  }
+
+  // Parses the token following `cursor`, assuming that it is a literal or a `d`
+  // marker. Tokens not starting with a (possibly negated) number are rejected,
+  // so data truncated after a minus sign is not mistaken for a clause end.
+  // Other malformed tokens yield unspecified literals.
+  template <typename UnaryFn>
+  auto parse_trusted_token(char const* cursor, char const* end, UnaryFn& clause_receiver)
+      -> char const*
+  {
+    // Matches the whitespace characters of the "C" locale, without calling std::isspace()
+    auto const is_space = [](char c) {
+      return c == ' ' || static_cast<unsigned char>(c - '\t') <= '\r' - '\t';
+    };
+
+    char const* const token_start = std::find_if_not(cursor, end, is_space);
+    if (token_start == end) {
+      return end;
+    }
+
+    if (m_mode == cnf_chunk_parser_mode::drat && *token_start == 'd') {
+      m_is_in_delete = true;
+      return token_start + 1;
+    }
+
+    bool const is_negative = *token_start == '-';
+    char const* const digits_start = token_start + (is_negative ? 1 : 0);
+    char const* digits_end = digits_start;
+    uint32_t value = 0;
+    while (digits_end != end && static_cast<unsigned char>(*digits_end - '0') <= 9) {
+      value = value * 10 + static_cast<uint32_t>(*digits_end - '0');
+      ++digits_end;
+    }
+
+    if (digits_end == digits_start) {
+      throw std::invalid_argument{"syntax error"};
+    }
+
+    if (value != 0) {
+      add_lit<UnaryFn>(lit{var{value - 1}, !is_negative});
+    }
+    else {
+      finish_clause(clause_receiver);
+    }
+
+    return digits_end;
+  }
+
+  // Fast path for the common case of whitespace-separated literals: parses
+  // tokens of the form -?[0-9]{1,9} that are followed by whitespace, returning
+  // the start of the first token not matching this pattern. Close to the end of
+  // the buffer, tokens are left to the regular parser, too.
+  template <typename UnaryFn>
+  auto scan_literals(char const* cursor, char const* end, UnaryFn& clause_receiver) -> char const*
+  {
+    // reading 8 bytes at the start of each literal may exceed the block
+    constexpr size_t slack = 8;
+    constexpr size_t max_num_digits = 9;
+
+    if (m_classify == nullptr) {
+      return cursor;
+    }
+
+    while (static_cast<size_t>(end - cursor) >= scan_block_size + slack) {
+      byte_class_masks const masks = m_classify(cursor);
+      uint64_t const non_whitespace = ~masks.whitespace;
+
+      size_t pos = 0;
+      while (pos < scan_block_size) {
+        uint64_t const remaining_tokens = non_whitespace >> pos;
+        if (remaining_tokens == 0) {
+          pos = scan_block_size;
+          break;
+        }
+
+        size_t const token_start = pos + count_trailing_zeros(remaining_tokens);
+        uint64_t const whitespace_after_token = masks.whitespace >> token_start;
+        if (whitespace_after_token == 0) {
+          // the token exceeds the block and is scanned with the next block
+          pos = token_start;
+          break;
+        }
+
+        size_t const token_size = count_trailing_zeros(whitespace_after_token);
+        bool const is_negative = ((masks.minus >> token_start) & 1) != 0;
+        size_t const digits_start = token_start + (is_negative ? 1 : 0);
+        size_t const num_digits = token_size - (is_negative ? 1 : 0);
+
+        uint64_t const digit_bits = ((uint64_t{1} << num_digits) - 1) << digits_start;
+        if (num_digits == 0 || num_digits > max_num_digits ||
+            (masks.digits & digit_bits) != digit_bits) {
+          return cursor + token_start;
+        }
+
+        char const* const digits = cursor + digits_start;
+        uint32_t value = 0;
+        if (num_digits <= 8) {
+          value = parse_digits_swar(digits, num_digits);
+        }
+        else {
+          value = parse_digits_swar(digits, 8) * 10 + (digits[8] - '0');
+        }
+
+        if (value != 0) {
+          // no range check needed, since values with at most 9 digits are valid variables
+          add_lit<UnaryFn>(lit{var{value - 1}, !is_negative});
+        }
+        else {
+          finish_clause(clause_receiver);
+        }
+
+        pos = token_start + token_size + 1;
+      }
+
+      if (pos == 0) {
+        // the token fills the entire block, so it is too long for the fast path
+        return cursor;
+      }
+
+      cursor += pos;
+    }
+
+    return cursor;
+  }
+
   cnf_chunk_parser_mode m_mode;
+  classify_fn m_classify = nullptr;
   size_t m_num_clauses_read = 0;
   std::vector<lit> m_lit_buffer;
+  clause_batch m_batch;
   bool m_is_in_comment = false;
   bool m_is_in_delete = false;
 };
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cnfkit/literal.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace cnfkit::detail {
+
+/*
+ * Encoding of literals as DIMACS text. The functions write directly to memory
+ * provided by the caller, which must be large enough for the result.
+ */
+
+// "-2147483647 "
+constexpr size_t max_encoded_dimacs_lit_size = 12;
+
+constexpr char const decimal_digit_pairs[] = "00010203040506070809"
+                                             "10111213141516171819"
+                                             "20212223242526272829"
+                                             "30313233343536373839"
+                                             "40414243444546474849"
+                                             "50515253545556575859"
+                                             "60616263646566676869"
+                                             "70717273747576777879"
+                                             "80818283848586878889"
+                                             "90919293949596979899";
+
+inline auto floor_log2(uint32_t value) noexcept -> uint32_t
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return 31 - static_cast<uint32_t>(__builtin_clz(value | 1));
+#else
+  uint32_t result = 0;
+  while ((value >>= 1) != 0) {
+    ++result;
+  }
+  return result;
+#endif
+}
+
+// Returns the number of decimal digits of `value`, without branching on the value
+inline auto count_decimal_digits(uint32_t value) noexcept -> uint32_t
+{
+  // Entry i holds the number of digits of 2^i in its upper 32 bits. The lower
+  // bits are chosen such that adding value carries into the upper half iff
+  // value has one digit more than 2^i (K. Willets, D. Lemire).
+  constexpr uint64_t table[] = {
+      4294967296,  8589934582,  8589934582,  8589934582,  12884901788, 12884901788, 12884901788,
+      17179868184, 17179868184, 17179868184, 21474826480, 21474826480, 21474826480, 21474826480,
+      25769703776, 25769703776, 25769703776, 30063771072, 30063771072, 30063771072, 34349738368,
+      34349738368, 34349738368, 34349738368, 38554705664, 38554705664, 38554705664, 41949672960,
+      41949672960, 41949672960, 42949672960, 42949672960};
+  return static_cast<uint32_t>((value + table[floor_log2(value)]) >> 32);
+}
+
+// Writes the decimal representation of `value` to `out`, returning the end of
+// the written data. At most 10 bytes are written.
+inline auto encode_decimal(char* out, uint32_t value) noexcept -> char*
+{
+  char* const stop = out + count_decimal_digits(value);
+  char* cursor = stop;
+
+  while (value >= 100) {
+    cursor -= 2;
+    std::memcpy(cursor, decimal_digit_pairs + 2 * (value % 100), 2);
+    value /= 100;
+  }
+
+  if (value >= 10) {
+    std::memcpy(cursor - 2, decimal_digit_pairs + 2 * value, 2);
+  }
+  else {
+    *(cursor - 1) = static_cast<char>('0' + value);
+  }
+
+  return stop;
+}
+
+// Throws std::invalid_argument if any of the literals cannot be represented
+// as DIMACS literal (see lit_to_dimacs())
+inline void check_dimacs_lit_range(lit const* start, lit const* stop)
+{
+  uint32_t max_raw_var = 0;
+  for (lit const* cursor = start; cursor != stop; ++cursor) {
+    uint32_t const raw_var = cursor->get_var().get_raw_value();
+    max_raw_var = raw_var > max_raw_var ? raw_var : max_raw_var;
+  }
+
+  if (max_raw_var >= static_cast<uint32_t>(std::numeric_limits<int32_t>::max())) {
+    throw std::invalid_argument{"DIMACS literal out of range"};
+  }
+}
+
+// Writes the DIMACS representation of `literal`, followed by a space. At most
+// max_encoded_dimacs_lit_size bytes are written. `literal` must be in the range
+// of DIMACS literals.
+inline auto encode_dimacs_lit(char* out, lit literal) noexcept -> char*
+{
+  *out = '-';
+  out += literal.is_positive() ? 0 : 1;
+  out = encode_decimal(out, literal.get_var().get_raw_value() + 1);
+  *out = ' ';
+  return out + 1;
+}
+}
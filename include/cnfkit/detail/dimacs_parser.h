@@ -3,49 +3,215 @@
 #include <cnfkit/detail/cnflike_parser.h>
 #include <cnfkit/literal.h>
 
+#include <algorithm>
+#include <cctype>
 #include <charconv>
-#include <regex>
+#include <exception>
 #include <stdexcept>
-#include <string>
 #include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace cnfkit::detail {
 
+// When loading formulas into memory, the number of literals is not known in
+// advance. Reserving memory for ternary clauses, since larger clauses are
+// typically less frequent.
+constexpr size_t estimated_clause_size = 3;
+
+// Limits the memory reserved in advance according to DIMACS headers, guarding
+// against bogus headers. Larger formulas are still loaded, growing the memory
+// as needed.
+constexpr size_t max_reserved_clauses = size_t{1} << 26;
+
 inline auto parse_cnf_header_line(std::string_view buffer) -> dimacs_problem_header
 {
-  auto const [buffer_past_comments, ended_in_comment] =
-      skip_dimacs_comments(buffer.begin(), buffer.end());
-  // ignoring ended_in_comment since it can only be true if
-  // buffer_past_comments == buffer.end(), causing parse failure
-
-  std::regex const header_regex{"^\\s*p\\s*cnf\\s*([0-9]+)\\s*([0-9]+)"};
-  std::match_results<std::string_view::const_iterator> header_match;
-  if (std::regex_search(buffer_past_comments, buffer.end(), header_match, header_regex)) {
-    if (header_match.size() != 3) {
+  char const* const start = buffer.data();
+  char const* const stop = start + buffer.size();
+
+  // ignoring ended_in_comment since it can only be true if the cursor is at
+  // stop, causing parse failure
+  char const* cursor = skip_dimacs_comments(start, stop).first;
+
+  auto const skip_keyword = [&cursor, stop](std::string_view keyword) {
+    cursor = skip_whitespace(cursor, stop);
+    if (std::string_view{cursor, static_cast<size_t>(stop - cursor)}.substr(0, keyword.size()) !=
+        keyword) {
       throw std::invalid_argument{"Syntax error in CNF header"};
     }
+    cursor += keyword.size();
+  };
 
-    dimacs_problem_header result;
-
-    result.header_size = header_match[0].second - header_match[0].first +
-                         std::distance(buffer.begin(), buffer_past_comments);
+  auto const parse_count = [&cursor, stop](size_t& result, char const* error_message) {
+    cursor = skip_whitespace(cursor, stop);
+    char const* const digits_stop =
+        std::find_if_not(cursor, stop, [](char c) { return c >= '0' && c <= '9'; });
+    if (digits_stop == cursor) {
+      throw std::invalid_argument{"Syntax error in CNF header"};
+    }
 
-    auto const [next, ec] =
-        std::from_chars(header_match[1].first, header_match[1].second, result.num_vars);
+    auto const [next, ec] = std::from_chars(cursor, digits_stop, result);
     if (ec != std::errc{}) {
-      throw std::invalid_argument{"Invalid number of variables"};
+      throw std::invalid_argument{error_message};
     }
+    cursor = digits_stop;
+  };
 
-    auto const [next2, ec2] =
-        std::from_chars(header_match[2].first, header_match[2].second, result.num_clauses);
-    if (ec2 != std::errc{}) {
-      throw std::invalid_argument{"Invalid number of clauses"};
-    }
+  dimacs_problem_header result;
+  skip_keyword("p");
+  skip_keyword("cnf");
+  parse_count(result.num_vars, "Invalid number of variables");
+  parse_count(result.num_clauses, "Invalid number of clauses");
+  result.header_size = cursor - start;
+  return result;
+}
+
+constexpr size_t min_parallel_range_size = (1 << 16);
 
-    return result;
+// Parses the header of in-memory CNF data, returning the header and the
+// offset of the data following the header
+inline auto parse_cnf_header(std::string_view input) -> std::pair<dimacs_problem_header, size_t>
+{
+  char const* const header_start =
+      skip_dimacs_comments(input.data(), input.data() + input.size()).first;
+  size_t const line_start = header_start - input.data();
+  size_t const line_end = std::min(input.find('\n', line_start), input.size());
+
+  dimacs_problem_header const header =
+      parse_cnf_header_line(input.substr(line_start, line_end - line_start));
+  return std::make_pair(header, line_start + header.header_size);
+}
+
+// Returns the position following the first clause-terminating 0 that ends at
+// or after `pos`, or `stop` if there is none. The parser state at
+// `body_start` must be outside of clauses and comments.
+inline auto find_cnf_clause_boundary(char const* body_start, char const* pos, char const* stop)
+    -> char const*
+{
+  auto const is_space = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
+
+  // Comments extend to the end of the line, so pos may be located in a comment
+  // if a c precedes it on the same line. In that case, the search starts at
+  // the next line. Otherwise, it starts at the token containing pos.
+  char const* cursor = pos;
+  while (cursor != body_start && cursor[-1] != '\n' && cursor[-1] != 'c') {
+    --cursor;
+  }
+
+  if (cursor != body_start && cursor[-1] == 'c') {
+    cursor = skip_to_line_end(pos, stop);
   }
   else {
-    throw std::invalid_argument{"Syntax error in CNF header"};
+    cursor = pos;
+    while (cursor != body_start && !is_space(cursor[-1])) {
+      --cursor;
+    }
+  }
+
+  while (cursor != stop) {
+    char const* const token_start = skip_dimacs_comments(cursor, stop).first;
+    char const* const token_end = std::find_if(token_start, stop, is_space);
+    if (token_end - token_start == 1 && *token_start == '0') {
+      return token_end;
+    }
+    cursor = token_end;
+  }
+
+  return stop;
+}
+
+struct cnf_body_split {
+  dimacs_problem_header header;
+  std::vector<std::string_view> ranges;
+};
+
+// Splits the data following the CNF header into at most max_num_ranges
+// ranges starting at clause boundaries
+inline auto split_cnf_body(std::string_view input, size_t max_num_ranges, size_t min_range_size)
+    -> cnf_body_split
+{
+  cnf_body_split result;
+  auto const [header, body_offset] = parse_cnf_header(input);
+  result.header = header;
+
+  char const* const body_start = input.data() + body_offset;
+  char const* const stop = input.data() + input.size();
+  size_t const body_size = stop - body_start;
+  size_t const num_ranges =
+      std::clamp<size_t>(body_size / std::max<size_t>(min_range_size, 1), 1, max_num_ranges);
+
+  char const* range_start = body_start;
+  for (size_t index = 1; index < num_ranges && range_start != stop; ++index) {
+    char const* const split_pos = std::max(range_start, body_start + index * body_size / num_ranges);
+    char const* const range_stop = find_cnf_clause_boundary(body_start, split_pos, stop);
+    result.ranges.emplace_back(range_start, range_stop - range_start);
+    range_start = range_stop;
+  }
+  result.ranges.emplace_back(range_start, stop - range_start);
+
+  return result;
+}
+
+// Invokes parse_range(i) for each i in [0, num_ranges) concurrently and
+// on_range_parsed(i) on the calling thread in ascending order of i, as soon as
+// all ranges up to and including i have been parsed. If parse_range(i) throws,
+// on_range_parsed(i) is still invoked, but not on_range_parsed(j) for j > i.
+// The first exception (in range order) is rethrown after all threads have
+// finished.
+template <typename RangeFn, typename ParsedFn>
+void run_concurrently(size_t num_ranges, RangeFn&& parse_range, ParsedFn&& on_range_parsed)
+{
+  std::vector<std::exception_ptr> errors(num_ranges);
+  std::vector<std::thread> threads;
+  threads.reserve(num_ranges);
+
+  std::exception_ptr error;
+  try {
+    for (size_t index = 1; index < num_ranges; ++index) {
+      threads.emplace_back([index, &errors, &parse_range]() {
+        try {
+          parse_range(index);
+        }
+        catch (...) {
+          errors[index] = std::current_exception();
+        }
+      });
+    }
+
+    parse_range(0);
+  }
+  catch (...) {
+    error = std::current_exception();
+  }
+
+  try {
+    on_range_parsed(0);
+  }
+  catch (...) {
+    if (error == nullptr) {
+      error = std::current_exception();
+    }
+  }
+
+  for (size_t index = 1; index <= threads.size(); ++index) {
+    threads[index - 1].join();
+    if (error == nullptr) {
+      try {
+        on_range_parsed(index);
+      }
+      catch (...) {
+        error = std::current_exception();
+      }
+    }
+
+    if (error == nullptr) {
+      error = errors[index];
+    }
+  }
+
+  if (error != nullptr) {
+    std::rethrow_exception(error);
   }
 }
 }
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <cnfkit/detail/chunk_reader.h>
 #include <cnfkit/detail/cnflike_parser.h>
+#include <cnfkit/detail/leb128.h>
 #include <cnfkit/io.h>
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <string>
@@ -50,39 +53,39 @@ inline auto parse_drat_binary_lit(std::byte const* start, std::byte const* stop)
 
 class drat_binary_chunk_parser {
 public:
+  drat_binary_chunk_parser() : drat_binary_chunk_parser(get_best_leb128_kernel()) {}
+
+  explicit drat_binary_chunk_parser(leb128_kernel kernel)
+    : m_decode_lits{get_leb128_decode_fn(kernel)}
+  {
+  }
+
   template <typename BinaryFn>
   void parse(std::byte const* start, std::byte const* stop, BinaryFn&& clause_receiver)
   {
     std::byte const* cursor = start;
     while (cursor != stop) {
-      if (*cursor == std::byte{0x61}) {
-        m_is_in_add_mode = true;
-        m_is_in_clause = true;
-        ++cursor;
-      }
-      else if (*cursor == std::byte{0x64}) {
-        m_is_in_add_mode = false;
+      if (!m_is_in_clause) {
+        if (*cursor == std::byte{0x61}) {
+          m_is_in_add_mode = true;
+        }
+        else if (*cursor == std::byte{0x64}) {
+          m_is_in_add_mode = false;
+        }
+        else {
+          throw std::invalid_argument{"clause not preceded by a or d"};
+        }
         m_is_in_clause = true;
         ++cursor;
       }
       else if (*cursor == std::byte{0}) {
-        if (!m_is_in_clause) {
-          throw std::invalid_argument{"clause not preceded by a or d"};
-        }
-
-        clause_receiver(m_is_in_add_mode, m_lit_buffer);
+        clause_receiver(m_is_in_add_mode, m_lit_buffer.data(), m_lit_buffer.data() + m_num_lits);
         m_is_in_clause = false;
-        m_lit_buffer.clear();
+        m_num_lits = 0;
         ++cursor;
       }
       else {
-        if (!m_is_in_clause) {
-          throw std::invalid_argument{"clause not preceded by a or d"};
-        }
-
-        auto const [lit, next] = parse_drat_binary_lit(cursor, stop);
-        cursor = next;
-        m_lit_buffer.push_back(lit);
+        cursor = parse_lits(cursor, stop);
       }
     }
   }
@@ -95,39 +98,66 @@ public:
   }
 
 private:
+  // Parses literals until reaching the end of the clause or `stop`
+  auto parse_lits(std::byte const* start, std::byte const* stop) -> std::byte const*
+  {
+    constexpr size_t min_free_lits = 256;
+
+    std::byte const* cursor = start;
+    while (cursor != stop && *cursor != std::byte{0}) {
+      if (m_lit_buffer.size() - m_num_lits < min_free_lits) {
+        m_lit_buffer.resize(std::max(m_num_lits + min_free_lits, 2 * m_lit_buffer.size()));
+      }
+
+      if (m_decode_lits != nullptr) {
+        lit* const out = m_lit_buffer.data() + m_num_lits;
+        leb128_decode_result const result =
+            m_decode_lits(cursor, stop, out, m_lit_buffer.data() + m_lit_buffer.size() - 1);
+        m_num_lits += result.out - out;
+        cursor = result.cursor;
+
+        if (cursor == stop || *cursor == std::byte{0}) {
+          break;
+        }
+      }
+
+      // Literals not decoded by the kernel, including invalid ones
+      auto const [lit, next] = parse_drat_binary_lit(cursor, stop);
+      m_lit_buffer[m_num_lits++] = lit;
+      cursor = next;
+    }
+    return cursor;
+  }
+
+  leb128_decode_fn m_decode_lits = nullptr;
+
+  // m_lit_buffer[0, m_num_lits) contains the literals of the current clause
   std::vector<lit> m_lit_buffer;
+  size_t m_num_lits = 0;
+
   bool m_is_in_add_mode = false;
   bool m_is_in_clause = false;
 };
 
+struct is_drat_binary_token_end {
+  auto operator()(std::byte byte) const noexcept -> bool
+  {
+    return (byte & std::byte{0x80}) == std::byte{0};
+  }
+};
+
 class drat_source_reader {
 public:
-  drat_source_reader(source& source) : m_source{source} {}
+  drat_source_reader(source& source) : m_chunk_reader{source} {}
 
-  auto is_eof() -> bool { return m_source.is_eof(); }
+  auto is_eof() -> bool { return m_chunk_reader.is_eof(); }
 
-  auto read_chunk(size_t desired_size) -> std::vector<std::byte> const&
+  auto read_chunk(size_t desired_size) -> byte_range
   {
-    m_buffer.resize(desired_size);
-    std::byte* byte_buffer = reinterpret_cast<std::byte*>(m_buffer.data());
-    std::byte* read_stop = m_source.read_bytes(byte_buffer, byte_buffer + desired_size);
-    m_buffer.resize(read_stop - byte_buffer);
-
-    // stopped in the middle of a literal ~> read rest, too
-    // TODO: only read at most 4 additional chars
-    if (!m_buffer.empty()) {
-      while (!is_eof() && (m_buffer.back() & std::byte{0x80}) != std::byte{0}) {
-        if (std::optional<std::byte> extra_byte = m_source.read_byte(); extra_byte.has_value()) {
-          m_buffer.push_back(*extra_byte);
-        }
-      }
-    }
-
-    return m_buffer;
+    return m_chunk_reader.read_chunk(desired_size);
   }
 
 private:
-  std::vector<std::byte> m_buffer;
-  source& m_source;
+  chunk_reader<is_drat_binary_token_end> m_chunk_reader;
 };
 }
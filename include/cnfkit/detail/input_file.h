@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+
+namespace cnfkit::detail {
+
+/*
+ * Raw file input for sources decompressing data themselves. The compressed
+ * data is read in large blocks via the C standard library.
+ */
+
+struct input_file_closer {
+  void operator()(std::FILE* file) const noexcept
+  {
+    if (file != stdin) {
+      std::fclose(file);
+    }
+  }
+};
+
+using input_file = std::unique_ptr<std::FILE, input_file_closer>;
+
+// Throws std::runtime_error if the file could not be opened
+inline auto open_input_file(std::filesystem::path const& path) -> input_file
+{
+  input_file result{std::fopen(path.string().c_str(), "rb")};
+  if (result == nullptr) {
+    throw std::runtime_error{"Could not open input file."};
+  }
+  return result;
+}
+
+inline auto open_stdin() -> input_file
+{
+  return input_file{stdin};
+}
+
+// Reads up to `stop - start` bytes, returning the end of the read data. Less
+// data is only read at EOF. Throws std::runtime_error on I/O failure.
+inline auto read_input_file(std::FILE* file, std::byte* start, std::byte* stop) -> std::byte*
+{
+  size_t const num_read = std::fread(start, 1, stop - start, file);
+  if (num_read != static_cast<size_t>(stop - start) && std::ferror(file) != 0) {
+    throw std::runtime_error{"Could not read input file."};
+  }
+  return start + num_read;
+}
+
+// Moves the file position to the given offset. Throws std::runtime_error on failure.
+inline void seek_input_file(std::FILE* file, uint64_t offset)
+{
+#if defined(_WIN32)
+  int const result = _fseeki64(file, static_cast<__int64>(offset), SEEK_SET);
+#else
+  int const result = fseeko(file, static_cast<off_t>(offset), SEEK_SET);
+#endif
+  if (result != 0) {
+    throw std::runtime_error{"Could not seek in input file."};
+  }
+}
+}
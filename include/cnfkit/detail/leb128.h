@@ -0,0 +1,470 @@
+#pragma once
+
+#include <cnfkit/detail/dimacs_encoding.h>
+#include <cnfkit/detail/literal_scanner.h>
+#include <cnfkit/literal.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace cnfkit::detail {
+
+/*
+ * Conversion kernels between literals and their binary DRAT encoding, i.e.
+ * 2 * (var + 1) + (is_positive ? 0 : 1) in LEB128 encoding. Instead of
+ * processing one byte at a time, the kernels load 8 bytes at once and convert
+ * the bits of a literal via shifts and masks (SWAR) or via the BMI2
+ * instructions pext and pdep. The SSSE3 and AVX2 decoding kernels convert 4
+ * or 8 literals at once, shuffling the bytes of each literal into a 32-bit
+ * lane (masked VByte, J. Plaisance, N. Kurz, D. Lemire). The kernel is
+ * selected at runtime, depending on the instruction sets supported by the CPU.
+ *
+ * Decoding kernels do not report errors. Instead, they stop before the first
+ * literal that needs special treatment, i.e. before clause terminators,
+ * invalid literals and literals close to the end of the input. These are
+ * left to the regular parser (see parse_drat_binary_lit()), which performs
+ * the full validation.
+ */
+
+enum class leb128_kernel { disabled, scalar, bmi2, ssse3, avx2 };
+
+constexpr size_t max_leb128_lit_size = 5;
+
+// Encoding kernels may write up to this many bytes past the end of the encoded data
+constexpr size_t max_leb128_encoding_overrun = 7;
+
+struct leb128_decode_result {
+  std::byte const* cursor;
+  lit* out;
+};
+
+// Decodes literals from [start, stop) to [out, out_stop), returning the end of
+// the consumed input and of the decoded literals
+using leb128_decode_fn = leb128_decode_result (*)(std::byte const* start,
+                                                  std::byte const* stop,
+                                                  lit* out,
+                                                  lit* out_stop);
+
+// Encodes the literals [start, stop), returning the end of the encoded data.
+// The literals must be in the range of DIMACS literals.
+using leb128_encode_fn = std::byte* (*)(lit const* start, lit const* stop, std::byte* out);
+
+static_assert(sizeof(lit) == sizeof(uint32_t));
+
+inline auto load_le64(std::byte const* bytes) noexcept -> uint64_t
+{
+  uint64_t result = 0;
+  std::memcpy(&result, bytes, sizeof(result));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  result = __builtin_bswap64(result);
+#endif
+  return result;
+}
+
+inline void store_le64(std::byte* out, uint64_t value) noexcept
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  value = __builtin_bswap64(value);
+#endif
+  std::memcpy(out, &value, sizeof(value));
+}
+
+// The raw value of lit is 2 * var + (is_positive ? 1 : 0)
+inline auto to_drat_binary_value(lit literal) noexcept -> uint32_t
+{
+  return (literal.get_raw_value() ^ 1) + 2;
+}
+
+inline auto is_valid_drat_binary_value(uint64_t value) noexcept -> bool
+{
+  return value - 2 <= uint64_t{std::numeric_limits<uint32_t>::max() - 2};
+}
+
+inline auto from_drat_binary_value(uint32_t value) noexcept -> lit
+{
+  uint32_t const raw_lit = (value - 2) ^ 1;
+  return lit{var{raw_lit >> 1}, (raw_lit & 1) == 1};
+}
+
+// Bits of the values stored in the bytes of a literal of maximum size
+constexpr uint64_t leb128_payload_bits = 0x7F7F7F7F7FULL;
+
+// Returns the size of the LEB128 value at the start of `word`, or a value
+// larger than max_leb128_lit_size if the value is longer than that
+inline auto get_leb128_size(uint64_t word) noexcept -> size_t
+{
+  uint64_t const terminators = ~word & 0x8080808080808080ULL;
+  return count_trailing_zeros(terminators | (uint64_t{1} << 63)) / 8 + 1;
+}
+
+inline auto get_leb128_payload_mask(size_t size) noexcept -> uint64_t
+{
+  return leb128_payload_bits & ((uint64_t{1} << (8 * size)) - 1);
+}
+
+inline auto compact_leb128_swar(uint64_t payload) noexcept -> uint64_t
+{
+  return (payload & 0x7F) | ((payload >> 1) & 0x3F80) | ((payload >> 2) & 0x1FC000) |
+         ((payload >> 3) & 0xFE00000) | ((payload >> 4) & 0x7F0000000);
+}
+
+inline auto spread_leb128_swar(uint64_t value) noexcept -> uint64_t
+{
+  return (value & 0x7F) | ((value << 1) & 0x7F00) | ((value << 2) & 0x7F0000) |
+         ((value << 3) & 0x7F000000) | ((value << 4) & 0x7F00000000);
+}
+
+// Entry i is the size of the LEB128 encoding of values v with floor(log2(v)) == i
+constexpr uint8_t leb128_encoded_sizes[32] = {1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 3, 3,
+                                              3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 5, 5, 5, 5};
+
+// Entry i contains the continuation bits of a LEB128 value of size i. Looking
+// up the bits is faster than computing them via a variable shift.
+constexpr uint64_t leb128_continuation_bits[max_leb128_lit_size + 1] = {
+    0, 0, 0x80, 0x8080, 0x808080, 0x80808080};
+
+// Decodes the literal at the start of [cursor, cursor + 8), storing it in
+// `out`. Returns the size of the literal, or 0 if the literal has not been
+// decoded.
+inline auto decode_leb128_swar_step(std::byte const* cursor, lit* out) noexcept -> size_t
+{
+  uint64_t const word = load_le64(cursor);
+  size_t const size = get_leb128_size(word);
+  if (size > max_leb128_lit_size) {
+    return 0;
+  }
+
+  uint64_t const value = compact_leb128_swar(word & get_leb128_payload_mask(size));
+  if (!is_valid_drat_binary_value(value)) {
+    return 0;
+  }
+
+  *out = from_drat_binary_value(static_cast<uint32_t>(value));
+  return size;
+}
+
+inline auto decode_leb128_scalar(std::byte const* start,
+                                 std::byte const* stop,
+                                 lit* out,
+                                 lit* out_stop) -> leb128_decode_result
+{
+  std::byte const* cursor = start;
+  while (stop - cursor >= 8 && out != out_stop) {
+    size_t const size = decode_leb128_swar_step(cursor, out);
+    if (size == 0) {
+      break;
+    }
+    cursor += size;
+    ++out;
+  }
+  return {cursor, out};
+}
+
+inline auto encode_leb128_scalar(lit const* start, lit const* stop, std::byte* out) -> std::byte*
+{
+  for (lit const* cursor = start; cursor != stop; ++cursor) {
+    uint32_t const value = to_drat_binary_value(*cursor);
+    size_t const size = leb128_encoded_sizes[floor_log2(value)];
+    store_le64(out, spread_leb128_swar(value) | leb128_continuation_bits[size]);
+    out += size;
+  }
+  return out;
+}
+
+#if defined(CNFKIT_HAS_X86_64_SIMD)
+__attribute__((target("bmi2"))) inline auto decode_leb128_bmi2(std::byte const* start,
+                                                               std::byte const* stop,
+                                                               lit* out,
+                                                               lit* out_stop)
+    -> leb128_decode_result
+{
+  std::byte const* cursor = start;
+  while (stop - cursor >= 8 && out != out_stop) {
+    uint64_t const word = load_le64(cursor);
+    size_t const size = get_leb128_size(word);
+    if (size > max_leb128_lit_size) {
+      break;
+    }
+
+    uint64_t const value = _pext_u64(word, get_leb128_payload_mask(size));
+    if (!is_valid_drat_binary_value(value)) {
+      break;
+    }
+
+    *out++ = from_drat_binary_value(static_cast<uint32_t>(value));
+    cursor += size;
+  }
+  return {cursor, out};
+}
+
+__attribute__((target("bmi2"))) inline auto
+encode_leb128_bmi2(lit const* start, lit const* stop, std::byte* out) -> std::byte*
+{
+  for (lit const* cursor = start; cursor != stop; ++cursor) {
+    uint32_t const value = to_drat_binary_value(*cursor);
+    size_t const size = leb128_encoded_sizes[floor_log2(value)];
+    store_le64(out, _pdep_u64(value, leb128_payload_bits) | leb128_continuation_bits[size]);
+    out += size;
+  }
+  return out;
+}
+
+/*
+ * Shuffle table for the vectorized decoding kernels, indexed by the
+ * continuation bits of the next 12 input bytes. An entry moves the bytes of
+ * the first up to 4 literals having at most 4 bytes each to separate 32-bit
+ * lanes, zeroing the remaining bytes.
+ */
+struct leb128_shuffle_table {
+  static constexpr size_t num_pattern_bytes = 12;
+  static constexpr size_t num_patterns = size_t{1} << num_pattern_bytes;
+  static constexpr size_t num_lanes = 4;
+
+  leb128_shuffle_table()
+  {
+    for (size_t pattern = 0; pattern < num_patterns; ++pattern) {
+      shuffles[pattern].fill(0x80);
+      num_lits[pattern] = 0;
+      num_bytes[pattern].fill(0);
+
+      size_t lit_start = 0;
+      for (size_t lane = 0; lane < num_lanes; ++lane) {
+        size_t lit_end = lit_start;
+        while (lit_end < num_pattern_bytes && ((pattern >> lit_end) & 1) != 0) {
+          ++lit_end;
+        }
+        if (lit_end == num_pattern_bytes || lit_end - lit_start >= 4) {
+          break;
+        }
+        ++lit_end;
+
+        for (size_t idx = lit_start; idx < lit_end; ++idx) {
+          shuffles[pattern][4 * lane + idx - lit_start] = static_cast<uint8_t>(idx);
+        }
+        ++num_lits[pattern];
+        num_bytes[pattern][num_lits[pattern]] = static_cast<uint8_t>(lit_end);
+        lit_start = lit_end;
+      }
+
+      for (size_t idx = num_lits[pattern] + 1; idx <= num_lanes; ++idx) {
+        num_bytes[pattern][idx] = num_bytes[pattern][num_lits[pattern]];
+      }
+    }
+  }
+
+  alignas(16) std::array<std::array<uint8_t, 16>, num_patterns> shuffles;
+
+  std::array<uint8_t, num_patterns> num_lits;
+
+  // num_bytes[pattern][k]: size of the first k literals, for k <= num_lits[pattern];
+  // size of all literals, for k > num_lits[pattern]
+  std::array<std::array<uint8_t, num_lanes + 1>, num_patterns> num_bytes;
+};
+
+inline auto get_leb128_shuffle_table() -> leb128_shuffle_table const&
+{
+  static leb128_shuffle_table const table;
+  return table;
+}
+
+__attribute__((target("ssse3"))) inline auto decode_leb128_ssse3(std::byte const* start,
+                                                                 std::byte const* stop,
+                                                                 lit* out,
+                                                                 lit* out_stop)
+    -> leb128_decode_result
+{
+  leb128_shuffle_table const& table = get_leb128_shuffle_table();
+
+  std::byte const* cursor = start;
+  while (stop - cursor >= 16 && out_stop - out >= 4) {
+    __m128i const bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(cursor));
+    size_t const pattern = static_cast<uint32_t>(_mm_movemask_epi8(bytes)) & 0xFFF;
+    __m128i const shuffle =
+        _mm_load_si128(reinterpret_cast<__m128i const*>(table.shuffles[pattern].data()));
+
+    __m128i const lanes = _mm_shuffle_epi8(bytes, shuffle);
+
+    __m128i const values = _mm_or_si128(
+        _mm_or_si128(_mm_and_si128(lanes, _mm_set1_epi32(0x7F)),
+                     _mm_and_si128(_mm_srli_epi32(lanes, 1), _mm_set1_epi32(0x3F80))),
+        _mm_or_si128(_mm_and_si128(_mm_srli_epi32(lanes, 2), _mm_set1_epi32(0x1FC000)),
+                     _mm_and_si128(_mm_srli_epi32(lanes, 3), _mm_set1_epi32(0xFE00000))));
+
+    __m128i const is_invalid = _mm_cmplt_epi32(values, _mm_set1_epi32(2));
+    __m128i const lits =
+        _mm_xor_si128(_mm_sub_epi32(values, _mm_set1_epi32(2)), _mm_set1_epi32(1));
+    uint32_t const invalid_lanes =
+        static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(is_invalid)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), lits);
+
+    // Lanes without literals contain 0, so num_valid <= num_lits[pattern]
+    size_t const num_valid = count_trailing_zeros(invalid_lanes | 0x10);
+    size_t num_decoded_bytes = table.num_bytes[pattern][num_valid];
+    out += num_valid;
+
+    if (num_valid == 0) {
+      // Only literals of up to 4 bytes are decoded via the shuffle table
+      num_decoded_bytes = decode_leb128_swar_step(cursor, out);
+      if (num_decoded_bytes == 0) {
+        return {cursor, out};
+      }
+      ++out;
+    }
+
+    cursor += num_decoded_bytes;
+  }
+
+  return decode_leb128_scalar(cursor, stop, out, out_stop);
+}
+
+__attribute__((target("avx2"))) inline auto decode_leb128_avx2(std::byte const* start,
+                                                               std::byte const* stop,
+                                                               lit* out,
+                                                               lit* out_stop)
+    -> leb128_decode_result
+{
+  leb128_shuffle_table const& table = get_leb128_shuffle_table();
+
+  std::byte const* cursor = start;
+
+  // Two windows of 16 bytes are decoded at once, the second one starting after
+  // the literals decoded via the first one
+  while (stop - cursor >= 12 + 16 && out_stop - out >= 8) {
+    __m128i const lo_bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(cursor));
+    size_t const lo_pattern = static_cast<uint32_t>(_mm_movemask_epi8(lo_bytes)) & 0xFFF;
+    size_t const lo_num_lits = table.num_lits[lo_pattern];
+    std::byte const* const hi_start = cursor + table.num_bytes[lo_pattern][4];
+
+    __m128i const hi_bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(hi_start));
+    size_t const hi_pattern = static_cast<uint32_t>(_mm_movemask_epi8(hi_bytes)) & 0xFFF;
+
+    __m256i const bytes = _mm256_inserti128_si256(_mm256_castsi128_si256(lo_bytes), hi_bytes, 1);
+    __m256i const shuffle = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(
+            _mm_load_si128(reinterpret_cast<__m128i const*>(table.shuffles[lo_pattern].data()))),
+        _mm_load_si128(reinterpret_cast<__m128i const*>(table.shuffles[hi_pattern].data())),
+        1);
+    __m256i const lanes = _mm256_shuffle_epi8(bytes, shuffle);
+
+    __m256i const values = _mm256_or_si256(
+        _mm256_or_si256(_mm256_and_si256(lanes, _mm256_set1_epi32(0x7F)),
+                        _mm256_and_si256(_mm256_srli_epi32(lanes, 1), _mm256_set1_epi32(0x3F80))),
+        _mm256_or_si256(
+            _mm256_and_si256(_mm256_srli_epi32(lanes, 2), _mm256_set1_epi32(0x1FC000)),
+            _mm256_and_si256(_mm256_srli_epi32(lanes, 3), _mm256_set1_epi32(0xFE00000))));
+
+    __m256i const is_invalid = _mm256_cmpgt_epi32(_mm256_set1_epi32(2), values);
+    __m256i const lits =
+        _mm256_xor_si256(_mm256_sub_epi32(values, _mm256_set1_epi32(2)), _mm256_set1_epi32(1));
+    uint32_t const invalid_lanes =
+        static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(is_invalid)));
+
+    size_t const lo_num_valid = count_trailing_zeros(invalid_lanes | 0x10);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(lits));
+    size_t num_decoded_bytes = table.num_bytes[lo_pattern][lo_num_valid];
+    out += lo_num_valid;
+
+    if (lo_num_valid == lo_num_lits) {
+      size_t const hi_num_valid = count_trailing_zeros((invalid_lanes >> 4) | 0x10);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_extracti128_si256(lits, 1));
+      num_decoded_bytes += table.num_bytes[hi_pattern][hi_num_valid];
+      out += hi_num_valid;
+    }
+
+    if (num_decoded_bytes == 0) {
+      // Only literals of up to 4 bytes are decoded via the shuffle table
+      num_decoded_bytes = decode_leb128_swar_step(cursor, out);
+      if (num_decoded_bytes == 0) {
+        return {cursor, out};
+      }
+      ++out;
+    }
+
+    cursor += num_decoded_bytes;
+  }
+
+  return decode_leb128_scalar(cursor, stop, out, out_stop);
+}
+#endif
+
+inline auto is_leb128_kernel_supported(leb128_kernel kernel) -> bool
+{
+  switch (kernel) {
+  case leb128_kernel::disabled:
+  case leb128_kernel::scalar:
+    return true;
+#if defined(CNFKIT_HAS_X86_64_SIMD)
+  case leb128_kernel::bmi2:
+    return __builtin_cpu_supports("bmi2");
+  case leb128_kernel::ssse3:
+    return __builtin_cpu_supports("ssse3");
+  case leb128_kernel::avx2:
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2");
+#endif
+  default:
+    return false;
+  }
+}
+
+inline auto get_best_leb128_kernel() -> leb128_kernel
+{
+  static leb128_kernel const best_kernel = []() {
+    for (leb128_kernel kernel : {leb128_kernel::avx2, leb128_kernel::ssse3}) {
+      if (is_leb128_kernel_supported(kernel)) {
+        return kernel;
+      }
+    }
+    return leb128_kernel::scalar;
+  }();
+  return best_kernel;
+}
+
+// Returns nullptr for leb128_kernel::disabled or unsupported kernels
+inline auto get_leb128_decode_fn(leb128_kernel kernel) -> leb128_decode_fn
+{
+  if (!is_leb128_kernel_supported(kernel)) {
+    return nullptr;
+  }
+
+  switch (kernel) {
+  case leb128_kernel::scalar:
+    return &decode_leb128_scalar;
+#if defined(CNFKIT_HAS_X86_64_SIMD)
+  case leb128_kernel::bmi2:
+    return &decode_leb128_bmi2;
+  case leb128_kernel::ssse3:
+    return &decode_leb128_ssse3;
+  case leb128_kernel::avx2:
+    return &decode_leb128_avx2;
+#endif
+  default:
+    return nullptr;
+  }
+}
+
+// Returns nullptr for leb128_kernel::disabled or unsupported kernels. There
+// are no vectorized encoding kernels: the SIMD kernels encode via SWAR or
+// BMI2. Note that pdep is slow on AMD CPUs before Zen 3.
+inline auto get_leb128_encode_fn(leb128_kernel kernel) -> leb128_encode_fn
+{
+  if (!is_leb128_kernel_supported(kernel)) {
+    return nullptr;
+  }
+
+  switch (kernel) {
+  case leb128_kernel::scalar:
+  case leb128_kernel::ssse3:
+    return &encode_leb128_scalar;
+#if defined(CNFKIT_HAS_X86_64_SIMD)
+  case leb128_kernel::bmi2:
+  case leb128_kernel::avx2:
+    return &encode_leb128_bmi2;
+#endif
+  default:
+    return nullptr;
+  }
+}
+}
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CNFKIT_HAS_X86_64_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace cnfkit::detail {
+
+/*
+ * Byte classification kernels for the fast path of the DIMACS-like text
+ * parser. A kernel classifies a block of 64 bytes at once, producing bit masks
+ * in which bit i refers to byte i of the block. The kernel is selected at
+ * runtime, depending on the instruction sets supported by the CPU.
+ */
+
+enum class scan_kernel { disabled, scalar, sse2, avx2 };
+
+constexpr size_t scan_block_size = 64;
+
+struct byte_class_masks {
+  uint64_t whitespace = 0;
+  uint64_t digits = 0;
+  uint64_t minus = 0;
+};
+
+using classify_fn = byte_class_masks (*)(char const* block);
+
+enum byte_class : uint8_t { whitespace_class = 1, digit_class = 2, minus_class = 4 };
+
+constexpr auto make_byte_class_table() -> std::array<uint8_t, 256>
+{
+  std::array<uint8_t, 256> result{};
+  for (char const ch : {' ', '\t', '\n', '\v', '\f', '\r'}) {
+    result[static_cast<unsigned char>(ch)] = whitespace_class;
+  }
+  for (char ch = '0'; ch <= '9'; ++ch) {
+    result[static_cast<unsigned char>(ch)] = digit_class;
+  }
+  result[static_cast<unsigned char>('-')] = minus_class;
+  return result;
+}
+
+constexpr std::array<uint8_t, 256> byte_class_table = make_byte_class_table();
+
+inline auto classify_scalar(char const* block) -> byte_class_masks
+{
+  byte_class_masks result;
+  for (size_t idx = 0; idx < scan_block_size; ++idx) {
+    uint8_t const byte_class = byte_class_table[static_cast<unsigned char>(block[idx])];
+    result.whitespace |= static_cast<uint64_t>(byte_class & whitespace_class) << idx;
+    result.digits |= static_cast<uint64_t>((byte_class & digit_class) >> 1) << idx;
+    result.minus |= static_cast<uint64_t>((byte_class & minus_class) >> 2) << idx;
+  }
+  return result;
+}
+
+#if defined(CNFKIT_HAS_X86_64_SIMD)
+__attribute__((target("sse2"))) inline auto classify_sse2(char const* block) -> byte_class_masks
+{
+  __m128i const space = _mm_set1_epi8(' ');
+  __m128i const tab = _mm_set1_epi8('\t');
+  __m128i const num_other_spaces = _mm_set1_epi8('\r' - '\t');
+  __m128i const zero = _mm_set1_epi8('0');
+  __m128i const nine = _mm_set1_epi8(9);
+  __m128i const minus = _mm_set1_epi8('-');
+
+  byte_class_masks result;
+  for (size_t offset = 0; offset < scan_block_size; offset += 16) {
+    __m128i const bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(block + offset));
+
+    // '\t' <= byte <= '\r' holds iff min(byte - '\t', '\r' - '\t') == byte - '\t' (unsigned)
+    __m128i const minus_tab = _mm_sub_epi8(bytes, tab);
+    __m128i const is_other_space =
+        _mm_cmpeq_epi8(_mm_min_epu8(minus_tab, num_other_spaces), minus_tab);
+    __m128i const is_space = _mm_or_si128(_mm_cmpeq_epi8(bytes, space), is_other_space);
+
+    __m128i const minus_zero = _mm_sub_epi8(bytes, zero);
+    __m128i const is_digit = _mm_cmpeq_epi8(_mm_min_epu8(minus_zero, nine), minus_zero);
+
+    __m128i const is_minus = _mm_cmpeq_epi8(bytes, minus);
+
+    result.whitespace |=
+        static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(is_space))) << offset;
+    result.digits |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(is_digit)))
+                     << offset;
+    result.minus |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(is_minus)))
+                    << offset;
+  }
+  return result;
+}
+
+__attribute__((target("avx2"))) inline auto classify_avx2(char const* block) -> byte_class_masks
+{
+  __m256i const space = _mm256_set1_epi8(' ');
+  __m256i const tab = _mm256_set1_epi8('\t');
+  __m256i const num_other_spaces = _mm256_set1_epi8('\r' - '\t');
+  __m256i const zero = _mm256_set1_epi8('0');
+  __m256i const nine = _mm256_set1_epi8(9);
+  __m256i const minus = _mm256_set1_epi8('-');
+
+  byte_class_masks result;
+  for (size_t offset = 0; offset < scan_block_size; offset += 32) {
+    __m256i const bytes = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(block + offset));
+
+    __m256i const minus_tab = _mm256_sub_epi8(bytes, tab);
+    __m256i const is_other_space =
+        _mm256_cmpeq_epi8(_mm256_min_epu8(minus_tab, num_other_spaces), minus_tab);
+    __m256i const is_space = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, space), is_other_space);
+
+    __m256i const minus_zero = _mm256_sub_epi8(bytes, zero);
+    __m256i const is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(minus_zero, nine), minus_zero);
+
+    __m256i const is_minus = _mm256_cmpeq_epi8(bytes, minus);
+
+    result.whitespace |=
+        static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(is_space))) << offset;
+    result.digits |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(is_digit)))
+                     << offset;
+    result.minus |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(is_minus)))
+                    << offset;
+  }
+  return result;
+}
+#endif
+
+inline auto is_scan_kernel_supported(scan_kernel kernel) -> bool
+{
+  switch (kernel) {
+  case scan_kernel::disabled:
+  case scan_kernel::scalar:
+    return true;
+#if defined(CNFKIT_HAS_X86_64_SIMD)
+  case scan_kernel::sse2:
+    return true;
+  case scan_kernel::avx2:
+    return __builtin_cpu_supports("avx2");
+#endif
+  default:
+    return false;
+  }
+}
+
+inline auto get_best_scan_kernel() -> scan_kernel
+{
+  static scan_kernel const best_kernel = []() {
+    for (scan_kernel kernel : {scan_kernel::avx2, scan_kernel::sse2}) {
+      if (is_scan_kernel_supported(kernel)) {
+        return kernel;
+      }
+    }
+    return scan_kernel::scalar;
+  }();
+  return best_kernel;
+}
+
+// Returns nullptr for scan_kernel::disabled or unsupported kernels
+inline auto get_classify_fn(scan_kernel kernel) -> classify_fn
+{
+  if (!is_scan_kernel_supported(kernel)) {
+    return nullptr;
+  }
+
+  switch (kernel) {
+  case scan_kernel::scalar:
+    return &classify_scalar;
+#if defined(CNFKIT_HAS_X86_64_SIMD)
+  case scan_kernel::sse2:
+    return &classify_sse2;
+  case scan_kernel::avx2:
+    return &classify_avx2;
+#endif
+  default:
+    return nullptr;
+  }
+}
+
+inline auto count_trailing_zeros(uint64_t value) noexcept -> size_t
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<size_t>(__builtin_ctzll(value));
+#else
+  size_t result = 0;
+  while ((value & 1) == 0) {
+    value >>= 1;
+    ++result;
+  }
+  return result;
+#endif
+}
+
+// Returns the value of the 1 to 8 ASCII digits starting at `digits`, converting
+// them at once. 8 bytes starting at `digits` must be readable.
+inline auto parse_digits_swar(char const* digits, size_t num_digits) noexcept -> uint32_t
+{
+  uint64_t value = 0;
+  std::memcpy(&value, digits, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  value = __builtin_bswap64(value);
+#endif
+
+  // Subtract '0' from each byte and move the digits to the most significant
+  // bytes, padding the number with leading zeros
+  value -= 0x3030303030303030ULL;
+  value <<= 8 * (8 - num_digits);
+
+  // Combine pairs of digits, then pairs of pairs, then pairs of quadruples
+  value = (value * 10) + (value >> 8);
+  value = (((value & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+           (((value >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >>
+          32;
+  return static_cast<uint32_t>(value);
+}
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cnfkit/io.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace cnfkit::detail {
+
+/**
+ * Buffer collecting data to be written to a sink. The data is passed to the
+ * sink when at least `capacity` bytes have been collected, or on flush().
+ *
+ * Data is added by writing to the space returned by get_space(), followed by
+ * a call to commit().
+ *
+ * When the buffer is destroyed, the remaining data is passed to the sink,
+ * ignoring errors.
+ */
+class write_buffer {
+public:
+  write_buffer(sink& sink, size_t capacity) : m_sink{&sink}, m_capacity{capacity}
+  {
+    m_data.resize(capacity);
+  }
+
+  // Returns a pointer to at least `size` writable bytes following the collected data
+  auto get_space(size_t size) -> std::byte*
+  {
+    if (m_data.size() - m_fill < size) {
+      // Only growing the buffer, so the bytes are not repeatedly zero-initialized
+      m_data.resize(std::max(m_fill + size, 2 * m_data.size()));
+    }
+    return m_data.data() + m_fill;
+  }
+
+  // Adds the first `size` bytes of the space returned by get_space() to the data
+  void commit(size_t size)
+  {
+    m_fill += size;
+    if (m_fill >= m_capacity) {
+      write_to_sink();
+    }
+  }
+
+  auto size() const noexcept -> size_t { return m_fill; }
+
+  void flush()
+  {
+    write_to_sink();
+    m_sink->flush();
+  }
+
+  ~write_buffer() { write_to_sink_ignoring_errors(); }
+
+  auto operator=(write_buffer const&) -> write_buffer& = delete;
+  write_buffer(write_buffer const&) = delete;
+
+  auto operator=(write_buffer&& rhs) noexcept -> write_buffer&
+  {
+    if (this != &rhs) {
+      write_to_sink_ignoring_errors();
+      m_sink = rhs.m_sink;
+      m_capacity = rhs.m_capacity;
+      m_data = std::move(rhs.m_data);
+      m_fill = std::exchange(rhs.m_fill, 0);
+    }
+    return *this;
+  }
+
+  write_buffer(write_buffer&& rhs) noexcept
+    : m_sink{rhs.m_sink}
+    , m_capacity{rhs.m_capacity}
+    , m_data{std::move(rhs.m_data)}
+    , m_fill{std::exchange(rhs.m_fill, 0)}
+  {
+  }
+
+private:
+  void write_to_sink()
+  {
+    if (m_fill != 0) {
+      m_sink->write_bytes(m_data.data(), m_data.data() + m_fill);
+      m_fill = 0;
+    }
+  }
+
+  void write_to_sink_ignoring_errors() noexcept
+  {
+    try {
+      write_to_sink();
+    }
+    catch (...) {
+      // Errors can only be reported by flush()
+    }
+  }
+
+  sink* m_sink;
+  size_t m_capacity;
+
+  // m_data[0, m_fill) contains the collected data
+  std::vector<std::byte> m_data;
+  size_t m_fill = 0;
+};
+}
@@ -6,12 +6,20 @@
 
 #include <cnfkit/detail/check_cxx_version.h>
 
+#include <cnfkit/clause_batch.h>
+#include <cnfkit/detail/clause_batching.h>
+#include <cnfkit/detail/clause_receiver.h>
 #include <cnfkit/detail/cnflike_parser.h>
 #include <cnfkit/detail/dimacs_parser.h>
+#include <cnfkit/input_policy.h>
 #include <cnfkit/io.h>
 #include <cnfkit/literal.h>
 
+#include <limits>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 /**
  * \defgroup dimacs_parsers DIMACS CNF Parsers
@@ -21,6 +29,21 @@
 
 namespace cnfkit {
 
+/**
+ * \brief The counts given in the header of a DIMACS CNF problem instance.
+ *
+ * \ingroup dimacs_parsers
+ *
+ * The counts are taken from the input as they are. The number of clauses is
+ * checked by the parsers after the last clause has been parsed, while the
+ * number of variables is not checked at all (see `parse_cnf()`). Thus, memory
+ * reserved according to the header should be bounded.
+ */
+struct cnf_header {
+  size_t num_vars = 0;
+  size_t num_clauses = 0;
+};
+
 /**
  * \brief Parses a source object containing a DIMACS CNF problem instance.
  *
@@ -38,45 +61,465 @@ namespace cnfkit {
  *  - the parser does not require comments to start at the beginning of lines,
  *    though they may not start within the DIMACS header.
  *
+ * \tparam InputPolicy       `validated_input` (default) or `trusted_input`. With `trusted_input`,
+ *                           the input is assumed to be well-formed, which speeds up parsing
+ *                           considerably (see `trusted_input`).
  *
  * \param source             The object to be parsed.
- * \param clause_receiver    A function with signature `void(std::vector<lit> const&)`.
- *                           `clause_receiver` is invoked for each parsed clause. `clause_receiver` may
- *                           throw. Exceptions thrown by `clause_receiver` are not caught by the parser.
+ * \param clause_receiver    A function with signature `void(std::vector<lit> const&)` or
+ *                           `void(lit const* start, lit const* stop)`. `clause_receiver` is invoked
+ *                           for each parsed clause. If `clause_receiver` accepts both signatures,
+ *                           the clause is passed as the range `[start, stop)`, which is valid until
+ *                           `clause_receiver` returns. `clause_receiver` may throw. Exceptions thrown
+ *                           by `clause_receiver` are not caught by the parser.
  *
  * \throws std::invalid_argument   when parsing the input failed.
  * \throws std::runtimer_error     on I/O failure.
  */
-template <typename UnaryFn>
+template <typename InputPolicy = validated_input, typename UnaryFn>
 auto parse_cnf(source& source, UnaryFn&& clause_receiver);
 
-// *** Implementation ***
+/**
+ * \brief Parses a source object containing a DIMACS CNF problem instance,
+ *        passing the DIMACS header to `header_receiver` first.
+ *
+ * \ingroup dimacs_parsers
+ *
+ * Like `parse_cnf()`, but lets the caller prepare for the clauses, e.g. by
+ * reserving memory for the clause database and per-variable data.
+ *
+ * \tparam InputPolicy       `validated_input` (default) or `trusted_input`, as for `parse_cnf()`.
+ *
+ * \param source             The object to be parsed.
+ * \param header_receiver    A function with signature `void(cnf_header const&)`, invoked once
+ *                           before `clause_receiver` is invoked for the first clause.
+ *                           `header_receiver` may throw, in which case no clauses are parsed.
+ *                           Exceptions thrown by `header_receiver` are not caught by the parser.
+ * \param clause_receiver    A function receiving the clauses, as for `parse_cnf()`.
+ *
+ * \throws std::invalid_argument   when parsing the input failed.
+ * \throws std::runtime_error      on I/O failure.
+ */
+template <typename InputPolicy = validated_input, typename HeaderFn, typename UnaryFn>
+void parse_cnf(source& source, HeaderFn&& header_receiver, UnaryFn&& clause_receiver);
 
+/**
+ * \brief Parses a source object containing a DIMACS CNF problem instance,
+ *        delivering the clauses in batches.
+ *
+ * \ingroup dimacs_parsers
+ *
+ * Like `parse_cnf()`, but collects the clauses in a flat buffer and passes
+ * them to `batch_receiver` in batches, saving the overhead of delivering each
+ * clause separately. The batches are delivered in input order, and each
+ * batch except the last one contains exactly `max_batch_size` clauses. When
+ * parsing fails, the clauses of the incomplete batch are not delivered.
+ *
+ * \param source             The object to be parsed.
+ * \param batch_receiver     A function with signature `void(clause_batch const&)`. The batch
+ *                           is valid until `batch_receiver` returns. `batch_receiver` may
+ *                           throw. Exceptions thrown by `batch_receiver` are not caught by the
+ *                           parser.
+ * \param max_batch_size     The maximum number of clauses per batch. Must be positive.
+ *
+ * \throws std::invalid_argument   when parsing the input failed or `max_batch_size` is 0.
+ * \throws std::runtime_error      on I/O failure.
+ */
 template <typename UnaryFn>
-auto parse_cnf(source& source, UnaryFn&& clause_receiver)
-{
-  using namespace cnfkit::detail;
+void parse_cnf_batched(source& source,
+                       UnaryFn&& batch_receiver,
+                       size_t max_batch_size = default_max_clause_batch_size);
+
+/**
+ * \brief Parses in-memory data containing a DIMACS CNF problem instance on
+ *        multiple threads, delivering the clauses in their original order.
+ *
+ * \ingroup dimacs_parsers
+ *
+ * The data following the DIMACS header is split into at most `num_threads`
+ * ranges at clause boundaries, which are then parsed concurrently. Small
+ * inputs are split into fewer ranges. The data is parsed as by `parse_cnf()`.
+ *
+ * The data of files can be made available in memory via `mmap_source`,
+ * which lends the entire file in a single block (see `source::borrow_bytes()`).
+ *
+ * \param input              The data to be parsed.
+ * \param num_threads        The maximum number of threads used for parsing, including
+ *                           the calling thread. Must be positive.
+ * \param clause_receiver    A function with signature `void(std::vector<lit> const&)` or
+ *                           `void(lit const* start, lit const* stop)`, as for `parse_cnf()`.
+ *                           `clause_receiver` is invoked on the calling thread for each parsed
+ *                           clause, in the order of the clauses in `input`. Clauses parsed
+ *                           ahead of their delivery are buffered. `clause_receiver` may throw.
+ *                           Exceptions thrown by `clause_receiver` are not caught by the parser.
+ *
+ * \throws std::invalid_argument   when parsing the input failed or `num_threads` is 0.
+ * \throws std::system_error       when a thread could not be started.
+ */
+template <typename UnaryFn>
+void parse_cnf_parallel(byte_range input, size_t num_threads, UnaryFn&& clause_receiver);
+
+/**
+ * \brief Parses in-memory data containing a DIMACS CNF problem instance on
+ *        multiple threads, passing the DIMACS header to `header_receiver` first.
+ *
+ * \ingroup dimacs_parsers
+ *
+ * Like `parse_cnf_parallel()`. `header_receiver` is a function with signature
+ * `void(cnf_header const&)`, invoked on the calling thread before any clause is
+ * parsed. `header_receiver` may throw. Exceptions thrown by `header_receiver`
+ * are not caught by the parser.
+ *
+ * \throws std::invalid_argument   when parsing the input failed or `num_threads` is 0.
+ * \throws std::system_error       when a thread could not be started.
+ */
+template <typename HeaderFn, typename UnaryFn>
+void parse_cnf_parallel(byte_range input,
+                        size_t num_threads,
+                        HeaderFn&& header_receiver,
+                        UnaryFn&& clause_receiver);
+
+/**
+ * \brief Parses in-memory data containing a DIMACS CNF problem instance on
+ *        multiple threads, delivering the clauses on the parsing threads.
+ *
+ * \ingroup dimacs_parsers
+ *
+ * Like `parse_cnf_parallel()`, but without buffering clauses: each range of
+ * the input is delivered by the thread parsing it.
+ *
+ * \param input              The data to be parsed.
+ * \param num_threads        The maximum number of threads used for parsing, including
+ *                           the calling thread. Must be positive.
+ * \param clause_receiver    A function with signature `void(size_t, std::vector<lit> const&)` or
+ *                           `void(size_t, lit const* start, lit const* stop)`, with clauses passed
+ *                           as for `parse_cnf()`. `clause_receiver` is invoked for each parsed clause, with the first
+ *                           argument being the index of the range containing the clause.
+ *                           Range indices are smaller than `num_threads`, and clauses in ranges
+ *                           with smaller indices precede those in ranges with larger indices.
+ *                           `clause_receiver` is invoked concurrently for distinct ranges, and
+ *                           in input order for clauses of the same range. `clause_receiver` may
+ *                           throw. Exceptions thrown by `clause_receiver` are not caught by the
+ *                           parser.
+ *
+ * \throws std::invalid_argument   when parsing the input failed or `num_threads` is 0.
+ * \throws std::system_error       when a thread could not be started.
+ */
+template <typename BinaryFn>
+void parse_cnf_parallel_per_range(byte_range input, size_t num_threads, BinaryFn&& clause_receiver);
+
+/**
+ * \brief Parses in-memory data containing a DIMACS CNF problem instance on
+ *        multiple threads, passing the DIMACS header to `header_receiver` first.
+ *
+ * \ingroup dimacs_parsers
+ *
+ * Like `parse_cnf_parallel_per_range()`. `header_receiver` is invoked as for
+ * `parse_cnf_parallel()`.
+ *
+ * \throws std::invalid_argument   when parsing the input failed or `num_threads` is 0.
+ * \throws std::system_error       when a thread could not be started.
+ */
+template <typename HeaderFn, typename BinaryFn>
+void parse_cnf_parallel_per_range(byte_range input,
+                                  size_t num_threads,
+                                  HeaderFn&& header_receiver,
+                                  BinaryFn&& clause_receiver);
+
+/**
+ * \brief Pull-based parser for DIMACS CNF problem instances.
+ *
+ * \ingroup dimacs_parsers
+ *
+ * Parses the input like `parse_cnf()`, but hands out the clauses one by one
+ * via `next()`, parsing the next chunk of the input when needed. This allows
+ * consuming the clauses on the caller's terms, e.g. stopping early by simply
+ * destroying the reader:
+ *
+ *     cnf_reader reader{source};
+ *     reserve(reader.get_header().num_vars);
+ *     while (std::optional<clause_view> clause = reader.next()) {
+ *       add_clause(clause->start, clause->stop);
+ *     }
+ *
+ * The source object must outlive the reader.
+ */
+class cnf_reader final {
+public:
+  /**
+   * \brief Constructs a cnf_reader object reading from `source`, parsing the
+   *        DIMACS header.
+   *
+   * \throws std::invalid_argument   when parsing the header failed.
+   * \throws std::runtime_error      on I/O failure.
+   */
+  explicit cnf_reader(source& source);
+
+  /**
+   * \brief Returns the DIMACS header of the problem instance.
+   */
+  auto get_header() const noexcept -> cnf_header const&;
+
+  /**
+   * \brief Returns the next clause, or `std::nullopt` after the last clause.
+   *
+   * The literals of the returned clause are valid until the next call to
+   * `next()` or the destruction of the reader.
+   *
+   * \throws std::invalid_argument   when parsing the input failed. Clauses preceding the
+   *                                 error are returned before the error is reported.
+   *                                 Subsequent calls throw as well.
+   * \throws std::runtime_error      on I/O failure.
+   */
+  auto next() -> std::optional<clause_view>;
+
+  auto operator=(cnf_reader const&) -> cnf_reader& = delete;
+  cnf_reader(cnf_reader const&) = delete;
+  auto operator=(cnf_reader&&) -> cnf_reader& = delete;
+  cnf_reader(cnf_reader&&) = delete;
+
+private:
+  auto parse_next_chunk() -> bool;
+
+  detail::cnf_source_reader m_source_reader;
+  detail::cnf_chunk_parser m_parser{detail::cnf_chunk_parser_mode::dimacs};
+
+  std::string m_header_line;
+  detail::dimacs_problem_header m_dimacs_header;
+  cnf_header m_header;
+  bool m_is_header_line_parsed = false;
+
+  detail::pulled_clause_batch m_clauses;
+};
 
+// *** Implementation ***
+
+namespace detail {
+// Reads CNF data, passing the DIMACS header to `header_receiver` and the
+// clause data to `parse_chunk`, a function with signature
+// `void(std::string_view buffer, size_t offset)` parsing `buffer` from
+// `offset` on via `parser`
+template <typename HeaderFn, typename ParseFn>
+void read_cnf_chunks(source& source,
+                     cnf_chunk_parser& parser,
+                     HeaderFn&& header_receiver,
+                     ParseFn&& parse_chunk)
+{
   cnf_source_reader reader{source};
 
   std::string const header_line = reader.read_header_line();
   dimacs_problem_header header = parse_cnf_header_line(header_line);
+  header_receiver(static_cast<dimacs_problem_header const&>(header));
 
-  cnf_chunk_parser parser{cnf_chunk_parser_mode::dimacs};
-  parser.parse(header_line,
-               header.header_size,
-               [&clause_receiver](bool /*ignored*/, std::vector<lit> const& clause) {
-                 clause_receiver(clause);
-               });
+  parse_chunk(std::string_view{header_line}, header.header_size);
 
-  std::string buffer;
   while (!reader.is_eof()) {
-    reader.read_chunk(default_chunk_size, buffer);
-    parser.parse(buffer, 0, [&clause_receiver](bool /*ignored*/, std::vector<lit> const& clause) {
-      clause_receiver(clause);
-    });
+    std::string_view const buffer = reader.read_chunk(default_chunk_size);
+    parse_chunk(buffer, 0);
   }
 
   parser.check_on_dimacs_finish(header);
 }
+
+// Parses CNF data like parse_cnf(), passing the DIMACS header to
+// `header_receiver` before delivering the first clause
+template <typename InputPolicy = validated_input, typename HeaderFn, typename UnaryFn>
+void parse_cnf_with_header(source& source, HeaderFn&& header_receiver, UnaryFn&& clause_receiver)
+{
+  check_clause_receiver<UnaryFn>();
+
+  auto receiver = [&clause_receiver](bool /*ignored*/, std::vector<lit> const& clause) {
+    invoke_clause_receiver(clause_receiver, clause);
+  };
+
+  cnf_chunk_parser parser{cnf_chunk_parser_mode::dimacs};
+  read_cnf_chunks(source, parser, header_receiver, [&](std::string_view buffer, size_t offset) {
+    parser.parse<InputPolicy>(buffer, offset, receiver);
+  });
+}
+}
+
+template <typename InputPolicy, typename UnaryFn>
+auto parse_cnf(source& source, UnaryFn&& clause_receiver)
+{
+  detail::parse_cnf_with_header<InputPolicy>(
+      source, [](detail::dimacs_problem_header const& /*ignored*/) {}, clause_receiver);
+}
+
+template <typename InputPolicy, typename HeaderFn, typename UnaryFn>
+void parse_cnf(source& source, HeaderFn&& header_receiver, UnaryFn&& clause_receiver)
+{
+  auto receive_header = [&header_receiver](detail::dimacs_problem_header const& header) {
+    header_receiver(cnf_header{header.num_vars, header.num_clauses});
+  };
+  detail::parse_cnf_with_header<InputPolicy>(source, receive_header, clause_receiver);
+}
+
+template <typename UnaryFn>
+void parse_cnf_batched(source& source, UnaryFn&& batch_receiver, size_t max_batch_size)
+{
+  using namespace cnfkit::detail;
+  check_max_batch_size(max_batch_size);
+
+  cnf_chunk_parser parser{cnf_chunk_parser_mode::dimacs};
+  read_cnf_chunks(
+      source,
+      parser,
+      [](dimacs_problem_header const& /*ignored*/) {},
+      [&](std::string_view buffer, size_t offset) {
+        parser.parse_batched(buffer, offset, max_batch_size, batch_receiver);
+      });
+
+  clause_batch const& last_batch = parser.get_batch();
+  if (!last_batch.empty()) {
+    batch_receiver(last_batch);
+  }
+}
+
+namespace detail {
+template <typename HeaderFn, typename RangeReceiverFn, typename ParsedFn>
+void parse_cnf_ranges(byte_range input,
+                      size_t num_threads,
+                      HeaderFn&& header_receiver,
+                      RangeReceiverFn&& get_range_receiver,
+                      ParsedFn&& on_range_parsed)
+{
+  if (num_threads == 0) {
+    throw std::invalid_argument{"the number of threads must be positive"};
+  }
+
+  std::string_view const text{reinterpret_cast<char const*>(input.start),
+                              static_cast<size_t>(input.stop - input.start)};
+  cnf_body_split const split = split_cnf_body(text, num_threads, min_parallel_range_size);
+  header_receiver(cnf_header{split.header.num_vars, split.header.num_clauses});
+
+  std::vector<cnf_chunk_parser> parsers(split.ranges.size(),
+                                        cnf_chunk_parser{cnf_chunk_parser_mode::dimacs});
+
+  run_concurrently(
+      split.ranges.size(),
+      [&](size_t index) {
+        parsers[index].parse(split.ranges[index], 0, get_range_receiver(index));
+      },
+      on_range_parsed);
+
+  size_t total_num_clauses_read = 0;
+  for (cnf_chunk_parser const& parser : parsers) {
+    total_num_clauses_read += parser.get_num_clauses_read();
+  }
+  parsers.back().check_on_dimacs_finish(split.header, total_num_clauses_read);
+}
+}
+
+template <typename UnaryFn>
+void parse_cnf_parallel(byte_range input, size_t num_threads, UnaryFn&& clause_receiver)
+{
+  parse_cnf_parallel(
+      input, num_threads, [](cnf_header const& /*ignored*/) {}, clause_receiver);
+}
+
+template <typename HeaderFn, typename UnaryFn>
+void parse_cnf_parallel(byte_range input,
+                        size_t num_threads,
+                        HeaderFn&& header_receiver,
+                        UnaryFn&& clause_receiver)
+{
+  using namespace cnfkit::detail;
+  check_clause_receiver<UnaryFn>();
+
+  // The first range is delivered while parsing it, the other ranges are buffered
+  std::vector<clause_batch> buffers(num_threads);
+
+  auto get_range_receiver = [&clause_receiver, &buffers](size_t index) {
+    return [index, &clause_receiver, &buffers](bool /*ignored*/, std::vector<lit> const& clause) {
+      if (index == 0) {
+        invoke_clause_receiver(clause_receiver, clause);
+      }
+      else {
+        buffers[index].add_clause(clause.data(), clause.data() + clause.size());
+      }
+    };
+  };
+
+  std::vector<lit> clause;
+  auto on_range_parsed = [&clause_receiver, &buffers, &clause](size_t index) {
+    clause_batch& buffer = buffers[index];
+    for (size_t idx = 0; idx < buffer.size(); ++idx) {
+      invoke_clause_receiver(
+          clause_receiver, buffer.clause_start(idx), buffer.clause_stop(idx), clause);
+    }
+    buffer = clause_batch{};
+  };
+
+  parse_cnf_ranges(input, num_threads, header_receiver, get_range_receiver, on_range_parsed);
+}
+
+template <typename BinaryFn>
+void parse_cnf_parallel_per_range(byte_range input, size_t num_threads, BinaryFn&& clause_receiver)
+{
+  parse_cnf_parallel_per_range(
+      input, num_threads, [](cnf_header const& /*ignored*/) {}, clause_receiver);
+}
+
+template <typename HeaderFn, typename BinaryFn>
+void parse_cnf_parallel_per_range(byte_range input,
+                                  size_t num_threads,
+                                  HeaderFn&& header_receiver,
+                                  BinaryFn&& clause_receiver)
+{
+  using namespace cnfkit::detail;
+  check_clause_receiver<BinaryFn, size_t>();
+
+  auto get_range_receiver = [&clause_receiver](size_t index) {
+    return [index, &clause_receiver](bool /*ignored*/, std::vector<lit> const& clause) {
+      invoke_clause_receiver(clause_receiver, clause, index);
+    };
+  };
+
+  parse_cnf_ranges(
+      input, num_threads, header_receiver, get_range_receiver, [](size_t /*ignored*/) {});
+}
+
+inline cnf_reader::cnf_reader(source& source)
+  : m_source_reader{source}
+  , m_header_line{m_source_reader.read_header_line()}
+  , m_dimacs_header{detail::parse_cnf_header_line(m_header_line)}
+  , m_header{m_dimacs_header.num_vars, m_dimacs_header.num_clauses}
+{
+}
+
+inline auto cnf_reader::get_header() const noexcept -> cnf_header const&
+{
+  return m_header;
+}
+
+inline auto cnf_reader::next() -> std::optional<clause_view>
+{
+  return m_clauses.next(m_parser.get_batch(), [this]() { return parse_next_chunk(); });
+}
+
+inline auto cnf_reader::parse_next_chunk() -> bool
+{
+  // The whole chunk is parsed into the batch of m_parser, which is handed out
+  // by m_clauses afterwards
+  constexpr size_t max_batch_size = std::numeric_limits<size_t>::max();
+  auto receiver = [](clause_batch const& /*unreachable*/) {};
+
+  if (!m_is_header_line_parsed) {
+    // The header line may contain clauses, too
+    m_is_header_line_parsed = true;
+    m_parser.parse_batched(m_header_line, m_dimacs_header.header_size, max_batch_size, receiver);
+    m_header_line = std::string{};
+    return true;
+  }
+
+  if (m_source_reader.is_eof()) {
+    m_parser.check_on_dimacs_finish(m_dimacs_header);
+    return false;
+  }
+
+  std::string_view const buffer = m_source_reader.read_chunk(detail::default_chunk_size);
+  m_parser.parse_batched(buffer, 0, max_batch_size, receiver);
+  return true;
+}
 }
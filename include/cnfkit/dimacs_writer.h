@@ -0,0 +1,324 @@
+#pragma once
+
+/**
+ * \file
+ */
+
+#include <cnfkit/detail/check_cxx_version.h>
+
+#include <cnfkit/detail/dimacs_encoding.h>
+#include <cnfkit/detail/write_buffer.h>
+#include <cnfkit/io.h>
+#include <cnfkit/literal.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+/**
+ * \defgroup dimacs_writers DIMACS CNF Writers
+ *
+ * \brief Writers for DIMACS CNF problem instances
+ */
+
+namespace cnfkit {
+
+/**
+ * \brief Writer for problem instances in the DIMACS CNF format.
+ *
+ * \ingroup dimacs_writers
+ *
+ * The DIMACS header is written on construction, so its counts must either be
+ * known in advance (e.g. determined in a first pass over the clauses), or be
+ * patched after writing the instance: when constructed without counts, a
+ * fixed-size placeholder header is written, which can be overwritten with
+ * the actual counts via `patch_dimacs_header()` once the instance has been
+ * written to a file.
+ *
+ * The writer does not check that the clauses match the counts of the header.
+ */
+class dimacs_writer final {
+public:
+  constexpr static size_t default_buffer_size = (1 << 20);
+
+  /**
+   * \brief The size of the placeholder header, including the terminating newline.
+   */
+  constexpr static size_t placeholder_header_size = 38;
+
+  /**
+   * \brief Constructs a dimacs_writer object writing to `sink`, using the given
+   *        counts for the DIMACS header.
+   *
+   * The encoded clauses are collected in a buffer, which is written to the
+   * sink when it contains at least `buffer_size` bytes, on `flush()`, and on
+   * destruction. With `buffer_size` 0, each clause is written to the sink
+   * immediately. Errors occurring on destruction are ignored, so `flush()`
+   * should be called after writing the instance.
+   *
+   * \throws std::invalid_argument  Thrown if `num_vars` exceeds the range of DIMACS variables.
+   */
+  dimacs_writer(sink& sink,
+                size_t num_vars,
+                size_t num_clauses,
+                size_t buffer_size = default_buffer_size);
+
+  /**
+   * \brief Constructs a dimacs_writer object writing to `sink`, writing a
+   *        placeholder header to be patched via `patch_dimacs_header()`.
+   *
+   * The placeholder header consists of `placeholder_header_size` bytes. The
+   * buffer is used as described for the other constructor.
+   */
+  explicit dimacs_writer(sink& sink, size_t buffer_size = default_buffer_size);
+
+  /**
+   * \brief Writes the given clause.
+   *
+   * \throws std::runtime_error     Thrown on I/O failure.
+   * \throws std::invalid_argument  Thrown when a literal cannot be represented in the
+   *                                supported range of DIMACS literals (see
+   *                                `lit_to_dimacs()`). In this case, the clause is not
+   *                                written.
+   */
+  void add_clause(lit const* start, lit const* stop);
+
+  /**
+   * \brief Flushes the sink backing the writer.
+   *
+   * \throws std::runtime_error     Thrown on I/O failure.
+   */
+  void flush();
+
+  /**
+   * \brief Returns the number of clauses written so far.
+   */
+  auto get_num_clauses() const noexcept -> size_t;
+
+  /**
+   * \brief Returns the maximum DIMACS variable occurring in the clauses written so far,
+   *        or 0 if no literals have been written.
+   */
+  auto get_num_vars() const noexcept -> size_t;
+
+  /**
+   * \brief Returns the number of bytes not yet written to the sink.
+   */
+  auto get_num_buffered_bytes() const noexcept -> size_t;
+
+  auto operator=(dimacs_writer const&) -> dimacs_writer& = delete;
+  dimacs_writer(dimacs_writer const&) = delete;
+  auto operator=(dimacs_writer&&) noexcept -> dimacs_writer& = default;
+  dimacs_writer(dimacs_writer&&) noexcept = default;
+
+private:
+  void write_header(size_t num_vars, size_t num_clauses, bool is_placeholder);
+
+  detail::write_buffer m_buffer;
+  size_t m_num_clauses = 0;
+  uint32_t m_max_raw_var_plus_one = 0;
+};
+
+/**
+ * \brief Overwrites the placeholder header of a DIMACS CNF file with the given counts.
+ *
+ * \ingroup dimacs_writers
+ *
+ * The file must have been written by a dimacs_writer object constructed without
+ * counts, e.g. via:
+ *
+ *     {
+ *       fd_sink sink{path};
+ *       dimacs_writer writer{sink};
+ *       // ... add the clauses
+ *       writer.flush();
+ *       num_vars = writer.get_num_vars();
+ *       num_clauses = writer.get_num_clauses();
+ *     }
+ *     patch_dimacs_header(path, num_vars, num_clauses);
+ *
+ * \throws std::runtime_error     Thrown on I/O failure.
+ * \throws std::invalid_argument  Thrown if the file does not start with a placeholder
+ *                                header, or if `num_vars` exceeds the range of DIMACS
+ *                                variables.
+ */
+void patch_dimacs_header(std::filesystem::path const& path, size_t num_vars, size_t num_clauses);
+
+// *** Implementation ***
+
+namespace detail {
+// "p cnf " + num_vars + " " + num_clauses + "\n". The fields of placeholder headers
+// are padded with spaces to the maximum size of the respective number.
+constexpr size_t max_dimacs_num_vars_size = 10;
+constexpr size_t max_dimacs_num_clauses_size = 20;
+
+inline void check_dimacs_num_vars(size_t num_vars)
+{
+  if (num_vars > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+    throw std::invalid_argument{"number of DIMACS variables out of range"};
+  }
+}
+
+// Writes the DIMACS header, with both numbers right-aligned in fields of the given
+// sizes. Returns the end of the written data.
+inline auto encode_dimacs_header(char* out,
+                                 size_t num_vars,
+                                 size_t num_clauses,
+                                 size_t num_vars_field_size,
+                                 size_t num_clauses_field_size) -> char*
+{
+  auto encode_field = [](char* cursor, uint64_t value, size_t field_size) -> char* {
+    char digits[20];
+    char* digits_start = std::end(digits);
+    do {
+      *--digits_start = static_cast<char>('0' + value % 10);
+      value /= 10;
+    } while (value != 0);
+
+    size_t const num_digits = std::end(digits) - digits_start;
+    if (field_size > num_digits) {
+      std::memset(cursor, ' ', field_size - num_digits);
+      cursor += field_size - num_digits;
+    }
+    std::memcpy(cursor, digits_start, num_digits);
+    return cursor + num_digits;
+  };
+
+  std::memcpy(out, "p cnf ", 6);
+  out = encode_field(out + 6, num_vars, num_vars_field_size);
+  *out++ = ' ';
+  out = encode_field(out, num_clauses, num_clauses_field_size);
+  *out++ = '\n';
+  return out;
+}
+}
+
+inline dimacs_writer::dimacs_writer(sink& sink,
+                                    size_t num_vars,
+                                    size_t num_clauses,
+                                    size_t buffer_size)
+  : m_buffer{sink, buffer_size}
+{
+  detail::check_dimacs_num_vars(num_vars);
+  write_header(num_vars, num_clauses, false);
+}
+
+inline dimacs_writer::dimacs_writer(sink& sink, size_t buffer_size) : m_buffer{sink, buffer_size}
+{
+  write_header(0, 0, true);
+}
+
+inline void dimacs_writer::write_header(size_t num_vars, size_t num_clauses, bool is_placeholder)
+{
+  // Headers with unpadded fields are at most as large as placeholder headers
+  static_assert(placeholder_header_size == 6 + detail::max_dimacs_num_vars_size + 1 +
+                                               detail::max_dimacs_num_clauses_size + 1);
+
+  char* const header_start =
+      reinterpret_cast<char*>(m_buffer.get_space(placeholder_header_size));
+  char* const header_stop = detail::encode_dimacs_header(
+      header_start,
+      num_vars,
+      num_clauses,
+      is_placeholder ? detail::max_dimacs_num_vars_size : 0,
+      is_placeholder ? detail::max_dimacs_num_clauses_size : 0);
+  m_buffer.commit(header_stop - header_start);
+}
+
+inline void dimacs_writer::add_clause(lit const* start, lit const* stop)
+{
+  // literals + "0\n"
+  size_t const max_size = (stop - start) * detail::max_encoded_dimacs_lit_size + 2;
+  char* const clause_start = reinterpret_cast<char*>(m_buffer.get_space(max_size));
+  char* cursor = clause_start;
+
+  // Checking the literal range while encoding, since the encoded data is only
+  // committed afterwards
+  uint32_t max_raw_var = 0;
+  for (lit const* lit_cursor = start; lit_cursor != stop; ++lit_cursor) {
+    uint32_t const raw_var = lit_cursor->get_var().get_raw_value();
+    max_raw_var = raw_var > max_raw_var ? raw_var : max_raw_var;
+    cursor = detail::encode_dimacs_lit(cursor, *lit_cursor);
+  }
+
+  if (max_raw_var >= static_cast<uint32_t>(std::numeric_limits<int32_t>::max())) {
+    throw std::invalid_argument{"DIMACS literal out of range"};
+  }
+
+  *cursor++ = '0';
+  *cursor++ = '\n';
+
+  if (start != stop) {
+    m_max_raw_var_plus_one = std::max(m_max_raw_var_plus_one, max_raw_var + 1);
+  }
+  ++m_num_clauses;
+  m_buffer.commit(cursor - clause_start);
+}
+
+inline void dimacs_writer::flush()
+{
+  m_buffer.flush();
+}
+
+inline auto dimacs_writer::get_num_clauses() const noexcept -> size_t
+{
+  return m_num_clauses;
+}
+
+inline auto dimacs_writer::get_num_vars() const noexcept -> size_t
+{
+  return m_max_raw_var_plus_one;
+}
+
+inline auto dimacs_writer::get_num_buffered_bytes() const noexcept -> size_t
+{
+  return m_buffer.size();
+}
+
+inline void patch_dimacs_header(std::filesystem::path const& path,
+                                size_t num_vars,
+                                size_t num_clauses)
+{
+  detail::check_dimacs_num_vars(num_vars);
+
+  std::fstream file{path, std::ios::in | std::ios::out | std::ios::binary};
+  if (!file) {
+    throw std::runtime_error{"Could not open DIMACS file."};
+  }
+
+  char old_header[dimacs_writer::placeholder_header_size];
+  if (!file.read(old_header, sizeof(old_header))) {
+    throw std::invalid_argument{"DIMACS file does not start with a placeholder header"};
+  }
+
+  char expected_header[dimacs_writer::placeholder_header_size];
+  detail::encode_dimacs_header(expected_header,
+                               0,
+                               0,
+                               detail::max_dimacs_num_vars_size,
+                               detail::max_dimacs_num_clauses_size);
+  if (std::memcmp(old_header, expected_header, sizeof(old_header)) != 0) {
+    throw std::invalid_argument{"DIMACS file does not start with a placeholder header"};
+  }
+
+  char header[dimacs_writer::placeholder_header_size];
+  detail::encode_dimacs_header(header,
+                               num_vars,
+                               num_clauses,
+                               detail::max_dimacs_num_vars_size,
+                               detail::max_dimacs_num_clauses_size);
+
+  file.seekp(0);
+  file.write(header, sizeof(header));
+  file.flush();
+  if (!file) {
+    throw std::runtime_error{"Could not write DIMACS file."};
+  }
+}
+}
@@ -6,10 +6,18 @@
 
 #include <cnfkit/detail/check_cxx_version.h>
 
+#include <cnfkit/clause_batch.h>
+#include <cnfkit/detail/clause_batching.h>
+#include <cnfkit/detail/clause_receiver.h>
 #include <cnfkit/detail/drat_parser.h>
+#include <cnfkit/input_policy.h>
 #include <cnfkit/io.h>
 
+#include <limits>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 /**
  * \defgroup drat_parsers DRAT Proof Parsers
@@ -32,17 +40,24 @@ namespace cnfkit {
  *
  * \ingroup drat_parsers
  *
+ * \tparam InputPolicy       `validated_input` (default) or `trusted_input`. With `trusted_input`,
+ *                           the proof is assumed to be well-formed, which speeds up parsing
+ *                           considerably (see `trusted_input`).
+ *
  * \param source             The object to be parsed.
- * \param clause_receiver    A function with signature `void(bool, std::vector<lit> const&)`.
- *                           `clause_receiver` is invoked for each parsed clause. The first argument is true
- *                           if and only if the clause is added to the proof.
+ * \param clause_receiver    A function with signature `void(bool, std::vector<lit> const&)` or
+ *                           `void(bool, lit const* start, lit const* stop)`. `clause_receiver` is
+ *                           invoked for each parsed clause. The first argument is true if and only if
+ *                           the clause is added to the proof. If `clause_receiver` accepts both
+ *                           signatures, the clause is passed as the range `[start, stop)`, which is
+ *                           valid until `clause_receiver` returns.
  *                           `clause_receiver` may throw. Exceptions thrown by
  *                           `clause_receiver` are not caught by the parser.
  *
  * \throws std::invalid_argument   Thrown when parsing the input failed.
  * \throws std::runtime_error      Thrown on I/O failure.
  */
-template <typename BinaryFn>
+template <typename InputPolicy = validated_input, typename BinaryFn>
 void parse_drat_text(source& source, BinaryFn&& clause_receiver);
 
 /**
@@ -51,9 +66,12 @@ void parse_drat_text(source& source, BinaryFn&& clause_receiver);
  * \ingroup drat_parsers
  *
  * \param source             The object to be parsed.
- * \param clause_receiver    A function with signature `void(bool, std::vector<lit> const&)`.
- *                           `clause_receiver` is invoked for each parsed clause. The first argument is true
- *                           if and only if the clause is added to the proof.
+ * \param clause_receiver    A function with signature `void(bool, std::vector<lit> const&)` or
+ *                           `void(bool, lit const* start, lit const* stop)`. `clause_receiver` is
+ *                           invoked for each parsed clause. The first argument is true if and only if
+ *                           the clause is added to the proof. If `clause_receiver` accepts both
+ *                           signatures, the clause is passed as the range `[start, stop)`, which is
+ *                           valid until `clause_receiver` returns.
  *                           `clause_receiver` may throw. Exceptions thrown by
  *                           `clause_receiver` are not caught by the parser.
  *
@@ -63,20 +81,153 @@ void parse_drat_text(source& source, BinaryFn&& clause_receiver);
 template <typename BinaryFn>
 void parse_drat_binary(source& source, BinaryFn&& clause_receiver);
 
+/**
+ * \brief Parses a source object containing a DRAT proof in text format,
+ *        delivering the clauses in batches.
+ *
+ * \ingroup drat_parsers
+ *
+ * Like `parse_drat_text()`, but collects the clauses in a flat buffer and
+ * passes them to `batch_receiver` in batches (see `parse_cnf_batched()`).
+ * `clause_batch::is_added()` indicates whether a clause is added to the proof.
+ *
+ * \param source             The object to be parsed.
+ * \param batch_receiver     A function with signature `void(clause_batch const&)`. The batch
+ *                           is valid until `batch_receiver` returns. `batch_receiver` may
+ *                           throw. Exceptions thrown by `batch_receiver` are not caught by the
+ *                           parser.
+ * \param max_batch_size     The maximum number of clauses per batch. Must be positive.
+ *
+ * \throws std::invalid_argument   Thrown when parsing the input failed or `max_batch_size` is 0.
+ * \throws std::runtime_error      Thrown on I/O failure.
+ */
+template <typename UnaryFn>
+void parse_drat_text_batched(source& source,
+                             UnaryFn&& batch_receiver,
+                             size_t max_batch_size = default_max_clause_batch_size);
+
+/**
+ * \brief Parses a source object containing a DRAT proof in binary format,
+ *        delivering the clauses in batches.
+ *
+ * \ingroup drat_parsers
+ *
+ * Like `parse_drat_text_batched()`, but for proofs in binary format.
+ *
+ * \throws std::invalid_argument   Thrown when parsing the input failed or `max_batch_size` is 0.
+ * \throws std::runtime_error      Thrown on I/O failure.
+ */
+template <typename UnaryFn>
+void parse_drat_binary_batched(source& source,
+                               UnaryFn&& batch_receiver,
+                               size_t max_batch_size = default_max_clause_batch_size);
+
+/**
+ * \brief Interface for pull-based DRAT proof parsers.
+ *
+ * \ingroup drat_parsers
+ *
+ * The readers parse the proof like `parse_drat_text()` and `parse_drat_binary()`,
+ * but hand out the clauses one by one via `next()`, parsing the next chunk of
+ * the input when needed. This allows interleaving reading the proof with
+ * checking it, and stopping early by simply destroying the reader:
+ *
+ *     drat_binary_reader reader{source};
+ *     while (std::optional<clause_view> clause = reader.next()) {
+ *       if (!check(clause->is_added, clause->start, clause->stop)) {
+ *         break;
+ *       }
+ *     }
+ */
+class drat_reader {
+public:
+  /**
+   * \brief Returns the next clause, or `std::nullopt` after the last clause.
+   *
+   * `clause_view::is_added` is true if and only if the clause is added to the
+   * proof. The literals of the returned clause are valid until the next call to
+   * `next()` or the destruction of the reader.
+   *
+   * \throws std::invalid_argument   Thrown when parsing the input failed. Clauses preceding
+   *                                 the error are returned before the error is reported.
+   *                                 Subsequent calls throw as well.
+   * \throws std::runtime_error      Thrown on I/O failure.
+   */
+  virtual auto next() -> std::optional<clause_view> = 0;
+
+  virtual ~drat_reader() = default;
+};
+
+/**
+ * \brief drat_reader implementation reading proofs in the text DRAT format.
+ *
+ * \ingroup drat_parsers
+ *
+ * The source object must outlive the reader.
+ */
+class drat_text_reader final : public drat_reader {
+public:
+  explicit drat_text_reader(source& source);
+
+  auto next() -> std::optional<clause_view> override;
+
+  auto operator=(drat_text_reader const&) -> drat_text_reader& = delete;
+  drat_text_reader(drat_text_reader const&) = delete;
+  auto operator=(drat_text_reader&&) -> drat_text_reader& = delete;
+  drat_text_reader(drat_text_reader&&) = delete;
+
+private:
+  auto parse_next_chunk() -> bool;
+
+  detail::cnf_source_reader m_source_reader;
+  detail::cnf_chunk_parser m_parser{detail::cnf_chunk_parser_mode::drat};
+  detail::pulled_clause_batch m_clauses;
+};
+
+/**
+ * \brief drat_reader implementation reading proofs in the binary DRAT format.
+ *
+ * \ingroup drat_parsers
+ *
+ * The source object must outlive the reader.
+ */
+class drat_binary_reader final : public drat_reader {
+public:
+  explicit drat_binary_reader(source& source);
+
+  auto next() -> std::optional<clause_view> override;
+
+  auto operator=(drat_binary_reader const&) -> drat_binary_reader& = delete;
+  drat_binary_reader(drat_binary_reader const&) = delete;
+  auto operator=(drat_binary_reader&&) -> drat_binary_reader& = delete;
+  drat_binary_reader(drat_binary_reader&&) = delete;
+
+private:
+  auto parse_next_chunk() -> bool;
+
+  detail::drat_source_reader m_source_reader;
+  detail::drat_binary_chunk_parser m_parser;
+  clause_batch m_batch;
+  detail::pulled_clause_batch m_clauses;
+};
 
 // *** Implementation ***
 
-template <typename BinaryFn>
+template <typename InputPolicy, typename BinaryFn>
 void parse_drat_text(source& source, BinaryFn&& clause_receiver)
 {
   using namespace cnfkit::detail;
+  check_clause_receiver<BinaryFn, bool>();
+
+  auto receiver = [&clause_receiver](bool is_added, std::vector<lit> const& clause) {
+    invoke_clause_receiver(clause_receiver, clause, is_added);
+  };
 
   cnf_chunk_parser parser{cnf_chunk_parser_mode::drat};
   cnf_source_reader reader{source};
-  std::string buffer;
   while (!reader.is_eof()) {
-    reader.read_chunk(default_chunk_size, buffer);
-    parser.parse(buffer, 0, clause_receiver);
+    std::string_view const buffer = reader.read_chunk(default_chunk_size);
+    parser.parse<InputPolicy>(buffer, 0, receiver);
   }
 
   parser.check_on_drat_finish();
@@ -86,14 +237,93 @@ template <typename BinaryFn>
 void parse_drat_binary(source& source, BinaryFn&& clause_receiver)
 {
   using namespace cnfkit::detail;
+  check_clause_receiver<BinaryFn, bool>();
+
+  std::vector<lit> scratch;
+  auto receiver = [&clause_receiver, &scratch](bool is_added, lit const* start, lit const* stop) {
+    invoke_clause_receiver(clause_receiver, start, stop, scratch, is_added);
+  };
 
   drat_binary_chunk_parser parser;
   drat_source_reader reader{source};
   while (!reader.is_eof()) {
-    auto const& buffer = reader.read_chunk(default_chunk_size);
-    parser.parse(buffer.data(), buffer.data() + buffer.size(), clause_receiver);
+    byte_range const buffer = reader.read_chunk(default_chunk_size);
+    parser.parse(buffer.start, buffer.stop, receiver);
   }
 
   parser.check_on_drat_finish();
 }
+
+template <typename UnaryFn>
+void parse_drat_text_batched(source& source, UnaryFn&& batch_receiver, size_t max_batch_size)
+{
+  using namespace cnfkit::detail;
+  check_max_batch_size(max_batch_size);
+
+  cnf_chunk_parser parser{cnf_chunk_parser_mode::drat};
+  cnf_source_reader reader{source};
+  while (!reader.is_eof()) {
+    std::string_view const buffer = reader.read_chunk(default_chunk_size);
+    parser.parse_batched(buffer, 0, max_batch_size, batch_receiver);
+  }
+
+  parser.check_on_drat_finish();
+
+  clause_batch const& last_batch = parser.get_batch();
+  if (!last_batch.empty()) {
+    batch_receiver(last_batch);
+  }
+}
+
+template <typename UnaryFn>
+void parse_drat_binary_batched(source& source, UnaryFn&& batch_receiver, size_t max_batch_size)
+{
+  detail::parse_in_batches(max_batch_size, batch_receiver, [&source](auto&& clause_receiver) {
+    parse_drat_binary(source, clause_receiver);
+  });
+}
+
+inline drat_text_reader::drat_text_reader(source& source) : m_source_reader{source} {}
+
+inline auto drat_text_reader::next() -> std::optional<clause_view>
+{
+  return m_clauses.next(m_parser.get_batch(), [this]() { return parse_next_chunk(); });
+}
+
+inline auto drat_text_reader::parse_next_chunk() -> bool
+{
+  if (m_source_reader.is_eof()) {
+    m_parser.check_on_drat_finish();
+    return false;
+  }
+
+  std::string_view const buffer = m_source_reader.read_chunk(detail::default_chunk_size);
+  m_parser.parse_batched(buffer,
+                         0,
+                         std::numeric_limits<size_t>::max(),
+                         [](clause_batch const& /*unreachable*/) {});
+  return true;
+}
+
+inline drat_binary_reader::drat_binary_reader(source& source) : m_source_reader{source} {}
+
+inline auto drat_binary_reader::next() -> std::optional<clause_view>
+{
+  return m_clauses.next(m_batch, [this]() { return parse_next_chunk(); });
+}
+
+inline auto drat_binary_reader::parse_next_chunk() -> bool
+{
+  if (m_source_reader.is_eof()) {
+    m_parser.check_on_drat_finish();
+    return false;
+  }
+
+  byte_range const buffer = m_source_reader.read_chunk(detail::default_chunk_size);
+  m_parser.parse(
+      buffer.start, buffer.stop, [this](bool is_added, lit const* start, lit const* stop) {
+        m_batch.add_clause(start, stop, is_added);
+      });
+  return true;
+}
 }
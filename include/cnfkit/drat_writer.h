@@ -6,14 +6,14 @@
 
 #include <cnfkit/detail/check_cxx_version.h>
 
+#include <cnfkit/detail/dimacs_encoding.h>
+#include <cnfkit/detail/leb128.h>
+#include <cnfkit/detail/write_buffer.h>
 #include <cnfkit/io.h>
 #include <cnfkit/literal.h>
 
-#include <array>
-#include <charconv>
 #include <cstddef>
-#include <cstring>
-#include <vector>
+#include <cstdint>
 
 /**
  * \defgroup drat_writers DRAT Proof Writers
@@ -70,11 +70,28 @@ public:
  */
 class drat_text_writer final : public drat_writer {
 public:
-  drat_text_writer(sink& sink);
+  constexpr static size_t default_buffer_size = (1 << 20);
+
+  /**
+   * \brief Constructs a drat_text_writer object writing to `sink`.
+   *
+   * The encoded clauses are collected in a buffer, which is written to the
+   * sink when it contains at least `buffer_size` bytes, on `flush()`, and on
+   * destruction. With `buffer_size` 0, each clause is written to the sink
+   * immediately. Errors occurring on destruction are ignored, so `flush()`
+   * should be called after writing the proof.
+   */
+  explicit drat_text_writer(sink& sink, size_t buffer_size = default_buffer_size);
+
   void add_clause(lit const* start, lit const* stop) override;
   void del_clause(lit const* start, lit const* stop) override;
   void flush() override;
 
+  /**
+   * \brief Returns the number of bytes not yet written to the sink.
+   */
+  auto get_num_buffered_bytes() const noexcept -> size_t;
+
   auto operator=(drat_text_writer const&) -> drat_text_writer& = delete;
   drat_text_writer(drat_text_writer const&) = delete;
   auto operator=(drat_text_writer&&) noexcept -> drat_text_writer& = default;
@@ -82,13 +99,8 @@ public:
 
 private:
   void write_clause(char prefix, lit const* start, lit const* stop);
-  void write_lit(lit literal);
-
-  void begin_clause(char prefix);
-  void end_clause();
 
-  sink* m_sink;
-  std::vector<std::byte> m_buffer;
+  detail::write_buffer m_buffer;
 };
 
 /**
@@ -98,11 +110,28 @@ private:
  */
 class drat_binary_writer final : public drat_writer {
 public:
-  drat_binary_writer(sink& sink);
+  constexpr static size_t default_buffer_size = (1 << 20);
+
+  /**
+   * \brief Constructs a drat_binary_writer object writing to `sink`.
+   *
+   * The encoded clauses are collected in a buffer, which is written to the
+   * sink when it contains at least `buffer_size` bytes, on `flush()`, and on
+   * destruction. With `buffer_size` 0, each clause is written to the sink
+   * immediately. Errors occurring on destruction are ignored, so `flush()`
+   * should be called after writing the proof.
+   */
+  explicit drat_binary_writer(sink& sink, size_t buffer_size = default_buffer_size);
+
   void add_clause(lit const* start, lit const* stop) override;
   void del_clause(lit const* start, lit const* stop) override;
   void flush() override;
 
+  /**
+   * \brief Returns the number of bytes not yet written to the sink.
+   */
+  auto get_num_buffered_bytes() const noexcept -> size_t;
+
   auto operator=(drat_binary_writer const&) -> drat_binary_writer& = delete;
   drat_binary_writer(drat_binary_writer const&) = delete;
   auto operator=(drat_binary_writer&&) noexcept -> drat_binary_writer& = default;
@@ -110,19 +139,18 @@ public:
 
 private:
   void write_clause(char prefix, lit const* start, lit const* stop);
-  void write_lit(lit literal);
-
-  void begin_clause(char prefix);
-  void end_clause();
 
-  sink* m_sink;
-  std::vector<std::byte> m_buffer;
+  detail::write_buffer m_buffer;
+  detail::leb128_encode_fn m_encode_lits;
 };
 
 
 // *** Implementation ***
 
-inline drat_text_writer::drat_text_writer(sink& sink) : m_sink{&sink} {}
+inline drat_text_writer::drat_text_writer(sink& sink, size_t buffer_size)
+  : m_buffer{sink, buffer_size}
+{
+}
 
 inline void drat_text_writer::add_clause(lit const* start, lit const* stop)
 {
@@ -136,50 +164,44 @@ inline void drat_text_writer::del_clause(lit const* start, lit const* stop)
 
 inline void drat_text_writer::flush()
 {
-  m_sink->flush();
+  m_buffer.flush();
 }
 
-inline void drat_text_writer::write_clause(char prefix, lit const* start, lit const* stop)
+inline auto drat_text_writer::get_num_buffered_bytes() const noexcept -> size_t
 {
-  m_buffer.clear();
-
-  begin_clause(prefix);
-  for (lit const* cursor = start; cursor != stop; ++cursor) {
-    write_lit(*cursor);
-  }
-  end_clause();
-
-  m_sink->write_bytes(m_buffer.data(), m_buffer.data() + m_buffer.size());
+  return m_buffer.size();
 }
 
-inline void drat_text_writer::write_lit(lit literal)
+inline void drat_text_writer::write_clause(char prefix, lit const* start, lit const* stop)
 {
-  std::array<char, 11> buffer;
-  auto [ptr, ec] =
-      std::to_chars(buffer.data(), buffer.data() + buffer.size(), lit_to_dimacs(literal));
-  size_t const old_size = m_buffer.size();
-  size_t const lit_size = ptr - buffer.begin();
-  m_buffer.resize(m_buffer.size() + lit_size + 1);
-  std::memcpy(m_buffer.data() + old_size, buffer.data(), lit_size);
-  m_buffer.back() = std::byte{' '};
-}
+  detail::check_dimacs_lit_range(start, stop);
+
+  // "d " + literals + "0\n"
+  size_t const max_size = 2 + (stop - start) * detail::max_encoded_dimacs_lit_size + 2;
+  char* const clause_start = reinterpret_cast<char*>(m_buffer.get_space(max_size));
+  char* cursor = clause_start;
 
-inline void drat_text_writer::begin_clause(char prefix)
-{
   if (prefix == 'd') {
-    m_buffer.push_back(std::byte('d'));
-    m_buffer.push_back(std::byte(' '));
+    *cursor++ = 'd';
+    *cursor++ = ' ';
+  }
+
+  for (lit const* lit_cursor = start; lit_cursor != stop; ++lit_cursor) {
+    cursor = detail::encode_dimacs_lit(cursor, *lit_cursor);
   }
+
+  *cursor++ = '0';
+  *cursor++ = '\n';
+
+  m_buffer.commit(cursor - clause_start);
 }
 
-inline void drat_text_writer::end_clause()
+inline drat_binary_writer::drat_binary_writer(sink& sink, size_t buffer_size)
+  : m_buffer{sink, buffer_size}
+  , m_encode_lits{detail::get_leb128_encode_fn(detail::get_best_leb128_kernel())}
 {
-  m_buffer.push_back(std::byte('0'));
-  m_buffer.push_back(std::byte('\n'));
 }
 
-inline drat_binary_writer::drat_binary_writer(sink& sink) : m_sink{&sink} {}
-
 inline void drat_binary_writer::add_clause(lit const* start, lit const* stop)
 {
   write_clause('a', start, stop);
@@ -192,48 +214,28 @@ inline void drat_binary_writer::del_clause(lit const* start, lit const* stop)
 
 inline void drat_binary_writer::flush()
 {
-  m_sink->flush();
+  m_buffer.flush();
 }
 
-inline void drat_binary_writer::write_clause(char prefix, lit const* start, lit const* stop)
+inline auto drat_binary_writer::get_num_buffered_bytes() const noexcept -> size_t
 {
-  m_buffer.clear();
-
-  begin_clause(prefix);
-  for (lit const* cursor = start; cursor != stop; ++cursor) {
-    write_lit(*cursor);
-  }
-  end_clause();
-
-  m_sink->write_bytes(m_buffer.data(), m_buffer.data() + m_buffer.size());
+  return m_buffer.size();
 }
 
-inline void drat_binary_writer::write_lit(lit literal)
+inline void drat_binary_writer::write_clause(char prefix, lit const* start, lit const* stop)
 {
-  std::array<std::byte, 6> buffer;
+  detail::check_dimacs_lit_range(start, stop);
 
-  uint32_t binary_lit =
-      (literal.get_var().get_raw_value() + 1) * 2 + (literal.is_positive() ? 0 : 1);
-  size_t index = 0;
+  // prefix + literals + 0
+  size_t const max_size = 1 + (stop - start) * detail::max_leb128_lit_size + 1;
+  std::byte* const clause_start =
+      m_buffer.get_space(max_size + detail::max_leb128_encoding_overrun);
+  std::byte* cursor = clause_start;
 
-  while (binary_lit != 0) {
-    buffer[index] = std::byte((binary_lit & 0xff) | 0x80);
-    binary_lit = binary_lit >> 7;
-    ++index;
-  }
+  *cursor++ = std::byte(prefix);
+  cursor = m_encode_lits(start, stop, cursor);
+  *cursor++ = std::byte(0);
 
-  buffer[index - 1] &= std::byte(0x7f);
-  m_buffer.insert(m_buffer.end(), buffer.begin(), buffer.begin() + index);
+  m_buffer.commit(cursor - clause_start);
 }
-
-inline void drat_binary_writer::begin_clause(char prefix)
-{
-  m_buffer.push_back(std::byte(prefix));
-}
-
-inline void drat_binary_writer::end_clause()
-{
-  m_buffer.push_back(std::byte(0));
-}
-
 }
@@ -0,0 +1,39 @@
+#pragma once
+
+/**
+ * \file
+ */
+
+#include <cnfkit/detail/check_cxx_version.h>
+
+namespace cnfkit {
+
+/**
+ * \brief Input policy for parsing data of unknown origin, checking it for errors.
+ *
+ * \ingroup dimacs_parsers drat_parsers
+ *
+ * This is the default policy of the text parsers.
+ */
+struct validated_input {
+  constexpr static bool is_trusted = false;
+};
+
+/**
+ * \brief Input policy for parsing well-formed data, e.g. intermediate files
+ *        written via `dimacs_writer` or `drat_text_writer`.
+ *
+ * \ingroup dimacs_parsers drat_parsers
+ *
+ * With this policy, the text parsers assume that the data following the
+ * DIMACS header consists of whitespace-separated DIMACS literals (and, for
+ * DRAT proofs, `d` markers), skipping comment detection, syntax checks and
+ * range checks of literals. The DIMACS header is still checked, as are the
+ * number of clauses, the termination of the last clause and the presence of
+ * digits in each literal, so truncated data is detected. For other malformed
+ * data, the parsed clauses are unspecified.
+ */
+struct trusted_input {
+  constexpr static bool is_trusted = true;
+};
+}
@@ -8,6 +8,7 @@
 
 #include <cstddef>
 #include <optional>
+#include <vector>
 
 /**
  * \defgroup io I/O Utilities
@@ -17,6 +18,16 @@
 
 namespace cnfkit {
 
+/**
+ * \brief Non-owning view of the bytes in `[start, stop)`.
+ *
+ * \ingroup io
+ */
+struct byte_range {
+  std::byte const* start = nullptr;
+  std::byte const* stop = nullptr;
+};
+
 /**
  * \brief Interface for objects containing data to be parsed.
  *
@@ -51,6 +62,39 @@ public:
    */
   virtual auto is_eof() -> bool = 0;
 
+  /**
+   * \brief Lends the next block of data to the caller without copying it.
+   *
+   * Sources keeping their data in memory (e.g. memory-mapped files) can
+   * implement this function to let parsers read the data in place. The
+   * returned range is valid until the next call to a member function of
+   * the source, and the source is advanced past the returned range. An empty
+   * range is returned if the source has reached EOF.
+   *
+   * If the source cannot lend its data, nothing is returned, the source is
+   * not advanced and the data must be read via `read_bytes()`. This is the
+   * default behavior.
+   *
+   * \throws std::runtime_error   Thrown on I/O failure.
+   */
+  virtual auto borrow_bytes() -> std::optional<byte_range> { return std::nullopt; }
+
+  /**
+   * \brief Returns the next block of data, without copying it if possible.
+   *
+   * If the source lends its data (see `borrow_bytes()`), the lent block is
+   * returned. Otherwise, up to `fallback_buffer.size()` bytes are read into
+   * `fallback_buffer` via `read_bytes()`, and the read data is returned. The
+   * returned range is valid until the next call to a member function of the
+   * source or the next modification of `fallback_buffer`. An empty range is
+   * returned if and only if the source has reached EOF.
+   *
+   * `fallback_buffer` must not be empty.
+   *
+   * \throws std::runtime_error   Thrown on I/O failure.
+   */
+  auto next_block(std::vector<std::byte>& fallback_buffer) -> byte_range;
+
   virtual ~source() = default;
 };
 
@@ -78,4 +122,17 @@ public:
 
   virtual ~sink() = default;
 };
+
+// *** Implementation ***
+
+inline auto source::next_block(std::vector<std::byte>& fallback_buffer) -> byte_range
+{
+  if (std::optional<byte_range> const borrowed = borrow_bytes(); borrowed.has_value()) {
+    return *borrowed;
+  }
+
+  std::byte* const buf_start = fallback_buffer.data();
+  std::byte* const buf_stop = read_bytes(buf_start, buf_start + fallback_buffer.size());
+  return byte_range{buf_start, buf_stop};
+}
 }
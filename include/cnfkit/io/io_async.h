@@ -0,0 +1,252 @@
+#pragma once
+
+/**
+ * \file
+ */
+
+#include <cnfkit/detail/check_cxx_version.h>
+
+#include <cnfkit/io.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace cnfkit {
+
+/**
+ * \brief Decorator writing to another sink on a background thread.
+ *
+ * An async_sink object collects the written data in a ring of buffers. Filled
+ * buffers are handed to a dedicated thread writing them to the wrapped sink,
+ * so the writing thread does not block on disk I/O or compression. Buffers
+ * are passed via a lock-free single-producer/single-consumer queue; the
+ * threads only synchronize via a mutex when one of them needs to wait.
+ *
+ * The amount of memory is bounded: when all buffers are waiting to be
+ * written, `write_bytes()` blocks until a buffer has been written.
+ *
+ * After the construction of an async_sink object, the wrapped sink must not
+ * be accessed until the async_sink object has been destroyed. Errors
+ * occurring while writing to the wrapped sink are reported by subsequent
+ * calls to `write_bytes()` or `flush()`. On destruction, the remaining data
+ * is written to the wrapped sink, ignoring errors. Thus, `flush()` should be
+ * called after writing the data.
+ *
+ * \ingroup io
+ */
+class async_sink final : public sink {
+public:
+  constexpr static size_t default_buffer_size = (1 << 20);
+  constexpr static size_t default_num_buffers = 4;
+
+  /**
+   * \brief Constructs an async_sink object writing to `sink`.
+   *
+   * At most `num_buffers` buffers of size `buffer_size` are held in memory.
+   *
+   * \throws std::invalid_argument  Thrown if `buffer_size` or `num_buffers` is 0.
+   * \throws std::system_error      Thrown if the background thread could not be started.
+   */
+  explicit async_sink(sink& sink,
+                      size_t buffer_size = default_buffer_size,
+                      size_t num_buffers = default_num_buffers);
+
+  /**
+   * \brief Copies the given data to the buffers, without waiting for it to be written.
+   *
+   * \throws std::runtime_error   Thrown if writing previously passed data failed.
+   */
+  void write_bytes(std::byte const* start, std::byte const* stop) override;
+
+  /**
+   * \brief Waits until all data has been written to the wrapped sink, then
+   *        flushes the wrapped sink.
+   *
+   * \throws std::runtime_error   Thrown on I/O failure.
+   */
+  void flush() override;
+
+  virtual ~async_sink();
+
+  auto operator=(async_sink const&) -> async_sink& = delete;
+  async_sink(async_sink const&) = delete;
+  auto operator=(async_sink&&) -> async_sink& = delete;
+  async_sink(async_sink&&) = delete;
+
+private:
+  struct buffer {
+    std::vector<std::byte> data;
+    size_t fill = 0;
+    bool flush_sink = false;
+  };
+
+  void write_buffers();
+  void submit_current_buffer(bool flush_sink);
+  void wait_for_completion(size_t num_buffers);
+  void throw_on_error();
+
+  sink& m_sink;
+  std::vector<buffer> m_buffers;
+
+  // Buffers m_buffers[i % m_buffers.size()] with m_num_completed <= i < m_num_submitted
+  // are owned by the writer thread. The remaining buffers are owned by the
+  // producer, which fills m_buffers[m_num_submitted % m_buffers.size()].
+  std::atomic<size_t> m_num_submitted = 0;
+  std::atomic<size_t> m_num_completed = 0;
+  std::atomic<bool> m_has_failed = false;
+
+  // Only used for waiting. m_error is set before m_has_failed.
+  std::mutex m_mutex;
+  std::condition_variable m_submitted_cv;
+  std::condition_variable m_completed_cv;
+  bool m_is_stop_requested = false;
+  std::exception_ptr m_error;
+
+  std::thread m_writer;
+};
+
+// *** Implementation ***
+
+inline async_sink::async_sink(sink& sink, size_t buffer_size, size_t num_buffers) : m_sink{sink}
+{
+  if (buffer_size == 0 || num_buffers == 0) {
+    throw std::invalid_argument{"buffer size and number of buffers must be positive"};
+  }
+
+  m_buffers.resize(num_buffers);
+  for (buffer& buf : m_buffers) {
+    buf.data.resize(buffer_size);
+  }
+
+  m_writer = std::thread{[this]() { write_buffers(); }};
+}
+
+inline async_sink::~async_sink()
+{
+  if (m_buffers[m_num_submitted % m_buffers.size()].fill != 0) {
+    submit_current_buffer(false);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_is_stop_requested = true;
+  }
+  m_submitted_cv.notify_one();
+  m_writer.join();
+}
+
+inline void async_sink::write_bytes(std::byte const* start, std::byte const* stop)
+{
+  throw_on_error();
+
+  while (start != stop) {
+    buffer& buf = m_buffers[m_num_submitted.load(std::memory_order_relaxed) % m_buffers.size()];
+    size_t const to_copy =
+        std::min(static_cast<size_t>(stop - start), buf.data.size() - buf.fill);
+    std::memcpy(buf.data.data() + buf.fill, start, to_copy);
+    buf.fill += to_copy;
+    start += to_copy;
+
+    if (buf.fill == buf.data.size()) {
+      submit_current_buffer(false);
+    }
+  }
+}
+
+inline void async_sink::flush()
+{
+  throw_on_error();
+  submit_current_buffer(true);
+  wait_for_completion(0);
+  throw_on_error();
+}
+
+inline void async_sink::submit_current_buffer(bool flush_sink)
+{
+  size_t const num_submitted = m_num_submitted.load(std::memory_order_relaxed);
+  m_buffers[num_submitted % m_buffers.size()].flush_sink = flush_sink;
+  m_num_submitted.store(num_submitted + 1, std::memory_order_release);
+
+  // Locking the mutex before notifying prevents the writer thread from missing
+  // the submission between checking the queue and waiting
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+  }
+  m_submitted_cv.notify_one();
+
+  // Wait for the next buffer to become available (backpressure)
+  wait_for_completion(m_buffers.size() - 1);
+}
+
+// Waits until at most `num_buffers` buffers are owned by the writer thread
+inline void async_sink::wait_for_completion(size_t num_buffers)
+{
+  size_t const num_submitted = m_num_submitted.load(std::memory_order_relaxed);
+  auto const is_done = [this, num_submitted, num_buffers]() {
+    return num_submitted - m_num_completed.load(std::memory_order_acquire) <= num_buffers;
+  };
+
+  if (!is_done()) {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_completed_cv.wait(lock, is_done);
+  }
+}
+
+inline void async_sink::throw_on_error()
+{
+  if (m_has_failed.load(std::memory_order_acquire)) {
+    std::rethrow_exception(m_error);
+  }
+}
+
+inline void async_sink::write_buffers()
+{
+  size_t num_completed = 0;
+
+  while (true) {
+    if (m_num_submitted.load(std::memory_order_acquire) == num_completed) {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_submitted_cv.wait(lock, [this, num_completed]() {
+        return m_is_stop_requested ||
+               m_num_submitted.load(std::memory_order_acquire) != num_completed;
+      });
+      if (m_num_submitted.load(std::memory_order_acquire) == num_completed) {
+        break;
+      }
+    }
+
+    buffer& buf = m_buffers[num_completed % m_buffers.size()];
+
+    // After an error, the remaining data is dropped
+    if (!m_has_failed.load(std::memory_order_relaxed)) {
+      try {
+        m_sink.write_bytes(buf.data.data(), buf.data.data() + buf.fill);
+        if (buf.flush_sink) {
+          m_sink.flush();
+        }
+      }
+      catch (...) {
+        m_error = std::current_exception();
+        m_has_failed.store(true, std::memory_order_release);
+      }
+    }
+
+    buf.fill = 0;
+    ++num_completed;
+    m_num_completed.store(num_completed, std::memory_order_release);
+
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+    }
+    m_completed_cv.notify_one();
+  }
+}
+}
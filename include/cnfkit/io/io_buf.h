@@ -44,6 +44,11 @@ public:
   auto read_byte() -> std::optional<std::byte> override;
   auto is_eof() -> bool override;
 
+  /**
+   * \brief Lends all remaining data in a single block.
+   */
+  auto borrow_bytes() -> std::optional<byte_range> override;
+
   auto operator=(buf_source const&) noexcept -> buf_source& = default;
   buf_source(buf_source const&) noexcept = default;
   auto operator=(buf_source&&) noexcept -> buf_source& = default;
@@ -94,4 +99,12 @@ inline auto buf_source::is_eof() -> bool
 {
   return m_remaining_size == 0;
 }
+
+inline auto buf_source::borrow_bytes() -> std::optional<byte_range>
+{
+  byte_range const result{m_cursor, m_cursor + m_remaining_size};
+  m_cursor += m_remaining_size;
+  m_remaining_size = 0;
+  return result;
+}
 }
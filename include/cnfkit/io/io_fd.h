@@ -0,0 +1,397 @@
+#pragma once
+
+/**
+ * \file
+ */
+
+#include <cnfkit/detail/check_cxx_version.h>
+
+#if !__has_include(<unistd.h>)
+#error "unistd.h not found. fd_source and fd_sink are only supported on POSIX systems."
+#endif
+
+#include <cnfkit/io.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace cnfkit {
+
+/**
+ * \brief Reader for uncompressed data, using a POSIX file descriptor.
+ *
+ * The data is read via `read()` in large blocks, bypassing the buffering of
+ * the C and C++ standard libraries. In contrast to mmap_source, this class
+ * also supports pipes, e.g. for reading instances piped to the standard input
+ * via `fd_source{STDIN_FILENO}`.
+ *
+ * `borrow_bytes()` lends the data read by a single `read()` call, so the
+ * parsers read the data in place. Requests for more data than the buffer
+ * holds are read directly into the caller's buffer.
+ *
+ * \ingroup io
+ */
+class fd_source final : public source {
+public:
+  constexpr static size_t default_buffer_size = (1 << 20);
+
+  /**
+   * \brief Constructs an fd_source object backed by the given file.
+   *
+   * The kernel is advised that the file is read sequentially, where supported.
+   *
+   * \throws std::runtime_error     Thrown when opening the file failed.
+   * \throws std::invalid_argument  Thrown if `buffer_size` is 0.
+   */
+  explicit fd_source(std::filesystem::path const& path,
+                     size_t buffer_size = default_buffer_size);
+
+  /**
+   * \brief Constructs an fd_source object reading from the given file descriptor.
+   *
+   * The file descriptor is not closed by the fd_source object. The kernel is
+   * advised that the file is read sequentially, where supported.
+   *
+   * \throws std::invalid_argument  Thrown if `buffer_size` is 0.
+   */
+  explicit fd_source(int fd, size_t buffer_size = default_buffer_size);
+
+  auto read_bytes(std::byte* buf_start, std::byte* buf_stop) -> std::byte* override;
+  auto read_byte() -> std::optional<std::byte> override;
+  auto is_eof() -> bool override;
+  auto borrow_bytes() -> std::optional<byte_range> override;
+
+  virtual ~fd_source();
+
+  auto operator=(fd_source const&) -> fd_source& = delete;
+  fd_source(fd_source const&) = delete;
+
+  auto operator=(fd_source&& rhs) noexcept -> fd_source&;
+  fd_source(fd_source&& rhs) noexcept;
+
+private:
+  void init(size_t buffer_size);
+  void refill_buffer();
+
+  int m_fd = -1;
+  bool m_owns_fd = false;
+
+  std::vector<std::byte> m_buffer;
+  std::byte* m_cursor = nullptr;
+  std::byte* m_stop = nullptr;
+  bool m_eof = false;
+};
+
+/**
+ * \brief Non-compressing writer using a POSIX file descriptor.
+ *
+ * The data is collected in a large buffer and written via `write()`,
+ * bypassing the buffering of the C and C++ standard libraries. Writes larger
+ * than the buffer are passed to `write()` directly. On destruction, the
+ * remaining data is written, ignoring errors. Thus, `flush()` should be
+ * called after writing the data.
+ *
+ * \ingroup io
+ */
+class fd_sink final : public sink {
+public:
+  constexpr static size_t default_buffer_size = (1 << 20);
+
+  /**
+   * \brief Constructs an fd_sink object writing to the given file.
+   *
+   * If the file exists, it is truncated.
+   *
+   * \throws std::runtime_error     Thrown when opening the file failed.
+   * \throws std::invalid_argument  Thrown if `buffer_size` is 0.
+   */
+  explicit fd_sink(std::filesystem::path const& path, size_t buffer_size = default_buffer_size);
+
+  /**
+   * \brief Constructs an fd_sink object writing to the given file descriptor.
+   *
+   * The file descriptor is not closed by the fd_sink object.
+   *
+   * \throws std::invalid_argument  Thrown if `buffer_size` is 0.
+   */
+  explicit fd_sink(int fd, size_t buffer_size = default_buffer_size);
+
+  /**
+   * \throws std::runtime_error   Thrown on I/O failure.
+   */
+  void write_bytes(std::byte const* start, std::byte const* stop) override;
+
+  /**
+   * \brief Passes the buffered data to the operating system.
+   *
+   * The data is not synchronized with the storage device.
+   *
+   * \throws std::runtime_error   Thrown on I/O failure.
+   */
+  void flush() override;
+
+  virtual ~fd_sink();
+
+  auto operator=(fd_sink const&) -> fd_sink& = delete;
+  fd_sink(fd_sink const&) = delete;
+
+  auto operator=(fd_sink&& rhs) noexcept -> fd_sink&;
+  fd_sink(fd_sink&& rhs) noexcept;
+
+private:
+  int m_fd = -1;
+  bool m_owns_fd = false;
+
+  std::vector<std::byte> m_buffer;
+  size_t m_fill = 0;
+};
+
+// *** Implementation ***
+
+namespace detail {
+// Reads up to `stop - start` bytes via a single successful read() call. `start`
+// is returned exactly at EOF.
+inline auto read_fd(int fd, std::byte* start, std::byte* stop) -> std::byte*
+{
+  while (true) {
+    ssize_t const num_read = ::read(fd, start, stop - start);
+    if (num_read >= 0) {
+      return start + num_read;
+    }
+    if (errno != EINTR) {
+      throw std::runtime_error{"Could not read input file."};
+    }
+  }
+}
+
+inline void write_fd(int fd, std::byte const* start, std::byte const* stop)
+{
+  while (start != stop) {
+    ssize_t const num_written = ::write(fd, start, stop - start);
+    if (num_written >= 0) {
+      start += num_written;
+    }
+    else if (errno != EINTR) {
+      throw std::runtime_error{"Could not write output file."};
+    }
+  }
+}
+}
+
+inline fd_source::fd_source(std::filesystem::path const& path, size_t buffer_size)
+{
+  if (buffer_size == 0) {
+    throw std::invalid_argument{"buffer size must be positive"};
+  }
+
+  m_fd = ::open(path.string().c_str(), O_RDONLY);
+  if (m_fd == -1) {
+    throw std::runtime_error{"Could not open input file."};
+  }
+  m_owns_fd = true;
+  init(buffer_size);
+}
+
+inline fd_source::fd_source(int fd, size_t buffer_size) : m_fd{fd}
+{
+  if (buffer_size == 0) {
+    throw std::invalid_argument{"buffer size must be positive"};
+  }
+  init(buffer_size);
+}
+
+inline void fd_source::init(size_t buffer_size)
+{
+  m_buffer.resize(buffer_size);
+  m_cursor = m_buffer.data();
+  m_stop = m_buffer.data();
+
+#if defined(POSIX_FADV_SEQUENTIAL)
+  // The advice is merely a hint, so failures (e.g. for pipes) are ignored
+  ::posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+inline fd_source::~fd_source()
+{
+  if (m_owns_fd) {
+    ::close(m_fd);
+  }
+}
+
+inline void fd_source::refill_buffer()
+{
+  m_cursor = m_buffer.data();
+  m_stop = detail::read_fd(m_fd, m_buffer.data(), m_buffer.data() + m_buffer.size());
+  m_eof = m_cursor == m_stop;
+}
+
+inline auto fd_source::read_bytes(std::byte* buf_start, std::byte* buf_stop) -> std::byte*
+{
+  size_t const num_buffered =
+      std::min(static_cast<size_t>(buf_stop - buf_start), static_cast<size_t>(m_stop - m_cursor));
+  if (num_buffered != 0) {
+    std::memcpy(buf_start, m_cursor, num_buffered);
+    m_cursor += num_buffered;
+    buf_start += num_buffered;
+  }
+
+  while (buf_start != buf_stop && !m_eof) {
+    if (static_cast<size_t>(buf_stop - buf_start) >= m_buffer.size()) {
+      // Copying large requests via the buffer would not save any read() calls
+      std::byte* const stop = detail::read_fd(m_fd, buf_start, buf_stop);
+      m_eof = stop == buf_start;
+      buf_start = stop;
+    }
+    else {
+      refill_buffer();
+      size_t const to_copy = std::min(static_cast<size_t>(buf_stop - buf_start),
+                                      static_cast<size_t>(m_stop - m_cursor));
+      if (to_copy != 0) {
+        std::memcpy(buf_start, m_cursor, to_copy);
+        m_cursor += to_copy;
+        buf_start += to_copy;
+      }
+    }
+  }
+
+  return buf_start;
+}
+
+inline auto fd_source::read_byte() -> std::optional<std::byte>
+{
+  if (m_cursor == m_stop && !m_eof) {
+    refill_buffer();
+  }
+
+  if (m_cursor == m_stop) {
+    return std::nullopt;
+  }
+  return *(m_cursor++);
+}
+
+inline auto fd_source::is_eof() -> bool
+{
+  return m_cursor == m_stop && m_eof;
+}
+
+inline auto fd_source::borrow_bytes() -> std::optional<byte_range>
+{
+  if (m_cursor == m_stop && !m_eof) {
+    refill_buffer();
+  }
+
+  byte_range const result{m_cursor, m_stop};
+  m_cursor = m_stop;
+  return result;
+}
+
+inline auto fd_source::operator=(fd_source&& rhs) noexcept -> fd_source&
+{
+  std::swap(m_fd, rhs.m_fd);
+  std::swap(m_owns_fd, rhs.m_owns_fd);
+  std::swap(m_buffer, rhs.m_buffer);
+  std::swap(m_cursor, rhs.m_cursor);
+  std::swap(m_stop, rhs.m_stop);
+  std::swap(m_eof, rhs.m_eof);
+  return *this;
+}
+
+inline fd_source::fd_source(fd_source&& rhs) noexcept
+{
+  std::swap(m_fd, rhs.m_fd);
+  std::swap(m_owns_fd, rhs.m_owns_fd);
+  std::swap(m_buffer, rhs.m_buffer);
+  std::swap(m_cursor, rhs.m_cursor);
+  std::swap(m_stop, rhs.m_stop);
+  std::swap(m_eof, rhs.m_eof);
+}
+
+inline fd_sink::fd_sink(std::filesystem::path const& path, size_t buffer_size)
+{
+  if (buffer_size == 0) {
+    throw std::invalid_argument{"buffer size must be positive"};
+  }
+
+  m_fd = ::open(path.string().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (m_fd == -1) {
+    throw std::runtime_error{"Could not open output file."};
+  }
+  m_owns_fd = true;
+  m_buffer.resize(buffer_size);
+}
+
+inline fd_sink::fd_sink(int fd, size_t buffer_size) : m_fd{fd}
+{
+  if (buffer_size == 0) {
+    throw std::invalid_argument{"buffer size must be positive"};
+  }
+  m_buffer.resize(buffer_size);
+}
+
+inline fd_sink::~fd_sink()
+{
+  if (m_fill != 0) {
+    try {
+      flush();
+    }
+    catch (...) {
+      // Errors can only be reported by flush()
+    }
+  }
+
+  if (m_owns_fd) {
+    ::close(m_fd);
+  }
+}
+
+inline void fd_sink::write_bytes(std::byte const* start, std::byte const* stop)
+{
+  size_t const size = stop - start;
+  if (size > m_buffer.size() - m_fill) {
+    flush();
+  }
+
+  if (size >= m_buffer.size()) {
+    detail::write_fd(m_fd, start, stop);
+  }
+  else if (size != 0) {
+    std::memcpy(m_buffer.data() + m_fill, start, size);
+    m_fill += size;
+  }
+}
+
+inline void fd_sink::flush()
+{
+  // The buffer is emptied even on failure, so the data is not written twice
+  size_t const fill = std::exchange(m_fill, 0);
+  detail::write_fd(m_fd, m_buffer.data(), m_buffer.data() + fill);
+}
+
+inline auto fd_sink::operator=(fd_sink&& rhs) noexcept -> fd_sink&
+{
+  std::swap(m_fd, rhs.m_fd);
+  std::swap(m_owns_fd, rhs.m_owns_fd);
+  std::swap(m_buffer, rhs.m_buffer);
+  std::swap(m_fill, rhs.m_fill);
+  return *this;
+}
+
+inline fd_sink::fd_sink(fd_sink&& rhs) noexcept
+{
+  std::swap(m_fd, rhs.m_fd);
+  std::swap(m_owns_fd, rhs.m_owns_fd);
+  std::swap(m_buffer, rhs.m_buffer);
+  std::swap(m_fill, rhs.m_fill);
+}
+}
@@ -15,31 +15,56 @@
 #include <archive.h>
 #include <archive_entry.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <filesystem>
+#include <optional>
 #include <stdexcept>
 
 namespace cnfkit {
 /**
  * \brief libarchive-based reader.
  *
+ * The data is decompressed block-wise into buffers owned by libarchive. The
+ * parsers read these blocks in place, without copying them (see
+ * `source::borrow_bytes()`).
+ *
  * \ingroup io
  */
 class libarchive_source : public source {
 public:
+  constexpr static size_t default_buffer_size = (1 << 16);
+
   /**
    * Constructs a libarchive_source reading the given file.
    *
    * The file may be compressed using any format supported by libarchive.
    *
-   * \throws std::runtime_error  Thrown when opening the file failed.
+   * \param buffer_size   The size of the blocks in which libarchive reads the file.
+   *
+   * \throws std::invalid_argument  Thrown if `buffer_size` is 0.
+   * \throws std::runtime_error     Thrown when opening the file failed.
    */
-  explicit libarchive_source(std::filesystem::path const& path);
+  explicit libarchive_source(std::filesystem::path const& path,
+                             size_t buffer_size = default_buffer_size);
   virtual ~libarchive_source();
 
   auto read_bytes(std::byte* start, std::byte* stop) -> std::byte* override;
   auto read_byte() -> std::optional<std::byte> override;
   auto is_eof() -> bool override;
 
+  /**
+   * \brief Lends the remainder of the current block decompressed by libarchive.
+   *
+   * The returned range is valid until the next call to a member function of
+   * the libarchive_source object.
+   *
+   * \throws std::runtime_error   Thrown on I/O failure or if the file is corrupt.
+   */
+  auto borrow_bytes() -> std::optional<byte_range> override;
+
   auto operator=(libarchive_source const&) -> libarchive_source& = delete;
   libarchive_source(libarchive_source const&) = delete;
 
@@ -48,15 +73,26 @@ public:
 
 private:
   void close_and_throw(char const* message);
+  auto acquire_block() -> bool;
 
   archive* m_file = nullptr;
   bool m_eof = false;
+
+  // The unconsumed part of the block last returned by libarchive
+  std::byte const* m_cursor = nullptr;
+  std::byte const* m_stop = nullptr;
+  int64_t m_next_offset = 0;
 };
 
 // *** Implementation ***
 
-inline libarchive_source::libarchive_source(std::filesystem::path const& path)
+inline libarchive_source::libarchive_source(std::filesystem::path const& path,
+                                            size_t buffer_size)
 {
+  if (buffer_size == 0) {
+    throw std::invalid_argument{"buffer size must be positive"};
+  }
+
   m_file = archive_read_new();
   if (m_file == nullptr) {
     throw std::bad_alloc{};
@@ -65,7 +101,6 @@ inline libarchive_source::libarchive_source(std::filesystem::path const& path)
   archive_read_support_filter_all(m_file);
   archive_read_support_format_raw(m_file);
 
-  size_t const buffer_size = 16384;
   // TODO: this won't work properly on Windows (lossy narrow string conversion)
   if (archive_read_open_filename(m_file, path.string().c_str(), buffer_size) != ARCHIVE_OK) {
     close_and_throw("opening input file failed");
@@ -90,51 +125,95 @@ inline libarchive_source::~libarchive_source()
 
 inline void libarchive_source::close_and_throw(char const* message)
 {
+  // The message may be owned by m_file
+  std::runtime_error error{message};
   if (m_file != nullptr) {
     archive_read_free(m_file);
     m_file = nullptr;
   }
   m_eof = true;
-  throw std::runtime_error(message);
+  m_cursor = m_stop = nullptr;
+  throw error;
 }
 
-inline auto libarchive_source::read_bytes(std::byte* start, std::byte* stop) -> std::byte*
+// Returns false if the source has reached EOF
+inline auto libarchive_source::acquire_block() -> bool
 {
-  if (m_file == nullptr) {
-    return start;
+  while (m_cursor == m_stop) {
+    if (m_file == nullptr || m_eof) {
+      return false;
+    }
+
+    void const* block = nullptr;
+    size_t size = 0;
+    la_int64_t offset = 0;
+    int const result = archive_read_data_block(m_file, &block, &size, &offset);
+
+    if (result == ARCHIVE_EOF) {
+      m_eof = true;
+      return false;
+    }
+    if (result < ARCHIVE_OK) {
+      // TODO: deal with ARCHIVE_WARN and ARCHIVE_RETRY
+      close_and_throw(archive_error_string(m_file));
+    }
+
+    // Raw data is contiguous, so the blocks never skip sparse regions
+    if (offset != m_next_offset) {
+      close_and_throw("unsupported sparse data");
+    }
+    m_next_offset += static_cast<int64_t>(size);
+
+    m_cursor = static_cast<std::byte const*>(block);
+    m_stop = m_cursor + size;
   }
+  return true;
+}
 
-  int result =
-      archive_read_data(m_file, reinterpret_cast<char*>(start), std::distance(start, stop));
-  if (result == 0) {
-    m_eof = true;
-  }
-  else if (result < 0) {
-    // TODO: deal with ARCHIVE_WARN and ARCHIVE_RETRY
-    close_and_throw(archive_error_string(m_file));
+inline auto libarchive_source::read_bytes(std::byte* start, std::byte* stop) -> std::byte*
+{
+  std::byte* cursor = start;
+  while (cursor != stop && acquire_block()) {
+    size_t const to_copy =
+        std::min(static_cast<size_t>(stop - cursor), static_cast<size_t>(m_stop - m_cursor));
+    std::memcpy(cursor, m_cursor, to_copy);
+    cursor += to_copy;
+    m_cursor += to_copy;
   }
-  return start + result;
+  return cursor;
 }
 
 inline auto libarchive_source::read_byte() -> std::optional<std::byte>
 {
-  std::byte buf;
-  std::byte* result = read_bytes(&buf, &buf + 1);
-  if (result == &buf) {
+  if (!acquire_block()) {
     return std::nullopt;
   }
-  return buf;
+  return *(m_cursor++);
 }
 
 inline auto libarchive_source::is_eof() -> bool
 {
-  return m_eof;
+  return m_cursor == m_stop && m_eof;
+}
+
+inline auto libarchive_source::borrow_bytes() -> std::optional<byte_range>
+{
+  if (!acquire_block()) {
+    return byte_range{};
+  }
+
+  byte_range const result{m_cursor, m_stop};
+  m_cursor = m_stop;
+  return result;
 }
 
 inline auto libarchive_source::operator=(libarchive_source&& rhs) noexcept -> libarchive_source&
 {
   std::swap(m_file, rhs.m_file);
   std::swap(m_eof, rhs.m_eof);
+  std::swap(m_cursor, rhs.m_cursor);
+  std::swap(m_stop, rhs.m_stop);
+  std::swap(m_next_offset, rhs.m_next_offset);
   return *this;
 }
 
@@ -142,6 +221,9 @@ inline libarchive_source::libarchive_source(libarchive_source&& rhs) noexcept
 {
   std::swap(m_file, rhs.m_file);
   std::swap(m_eof, rhs.m_eof);
+  std::swap(m_cursor, rhs.m_cursor);
+  std::swap(m_stop, rhs.m_stop);
+  std::swap(m_next_offset, rhs.m_next_offset);
 }
 
 }
@@ -0,0 +1,214 @@
+#pragma once
+
+/**
+ * \file
+ */
+
+#include <cnfkit/detail/check_cxx_version.h>
+
+#if !__has_include(<lzma.h>)
+#error "lzma.h not found. The headers of liblzma must be added to the include search path."
+#endif
+
+#include <cnfkit/detail/input_file.h>
+#include <cnfkit/io.h>
+
+#include <lzma.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cnfkit {
+
+/**
+ * \brief Reader for xz-compressed files.
+ *
+ * This class uses liblzma directly, reading the compressed data in large
+ * blocks and decompressing it into the buffers passed to `read_bytes()`.
+ * Files consisting of multiple concatenated xz streams are supported.
+ *
+ * With liblzma 5.4 or newer, streams consisting of multiple blocks (e.g.
+ * created via `xz -T0`) are decompressed by multiple threads. Streams with
+ * a single block are always decompressed by a single thread.
+ *
+ * \ingroup io
+ */
+class lzma_source final : public source {
+public:
+  constexpr static size_t input_buffer_size = (1 << 20);
+
+  /**
+   * \brief Constructs an lzma_source object backed by the given file.
+   *
+   * \param num_threads   The maximum number of threads decompressing the data.
+   *                      With 0, the number of hardware threads is used.
+   *
+   * \throws std::runtime_error   Thrown when opening the file or initializing liblzma failed.
+   */
+  explicit lzma_source(std::filesystem::path const& path, uint32_t num_threads = 0);
+
+  /**
+   * \brief Constructs an lzma_source object reading from stdin.
+   *
+   * \param num_threads   The maximum number of threads decompressing the data.
+   *                      With 0, the number of hardware threads is used.
+   *
+   * \throws std::runtime_error   Thrown when initializing liblzma failed.
+   */
+  explicit lzma_source(uint32_t num_threads = 0);
+
+  /**
+   * \throws std::runtime_error   Thrown on I/O failure or if the data is corrupt or truncated.
+   */
+  auto read_bytes(std::byte* buf_start, std::byte* buf_stop) -> std::byte* override;
+
+  /**
+   * \throws std::runtime_error   Thrown on I/O failure or if the data is corrupt or truncated.
+   */
+  auto read_byte() -> std::optional<std::byte> override;
+
+  auto is_eof() -> bool override;
+
+  auto operator=(lzma_source const&) -> lzma_source& = delete;
+  lzma_source(lzma_source const&) = delete;
+
+  auto operator=(lzma_source&& rhs) noexcept -> lzma_source& = default;
+  lzma_source(lzma_source&& rhs) noexcept = default;
+
+private:
+  void init_decoder(uint32_t num_threads);
+
+  struct stream_deleter {
+    void operator()(lzma_stream* stream) const noexcept
+    {
+      lzma_end(stream);
+      delete stream;
+    }
+  };
+
+  detail::input_file m_file;
+
+  // liblzma streams must not be moved after initialization
+  std::unique_ptr<lzma_stream, stream_deleter> m_stream;
+
+  std::vector<std::byte> m_buffer;
+  std::byte m_byte_buffer{0};
+  bool m_is_input_eof = false;
+  bool m_eof = false;
+};
+
+// *** Implementation ***
+
+namespace detail {
+inline auto get_lzma_error_message(lzma_ret result) -> std::string
+{
+  switch (result) {
+  case LZMA_MEM_ERROR:
+    return "out of memory";
+  case LZMA_MEMLIMIT_ERROR:
+    return "memory usage limit reached";
+  case LZMA_FORMAT_ERROR:
+    return "file format not recognized";
+  case LZMA_OPTIONS_ERROR:
+    return "unsupported compression options";
+  case LZMA_DATA_ERROR:
+    return "data is corrupt";
+  case LZMA_BUF_ERROR:
+    return "data is truncated";
+  default:
+    return "error " + std::to_string(static_cast<int>(result));
+  }
+}
+
+inline void throw_on_lzma_error(lzma_ret result, char const* message)
+{
+  if (result != LZMA_OK && result != LZMA_STREAM_END) {
+    throw std::runtime_error{std::string{message} + ": " + get_lzma_error_message(result)};
+  }
+}
+}
+
+inline lzma_source::lzma_source(std::filesystem::path const& path, uint32_t num_threads)
+  : m_file{detail::open_input_file(path)}
+{
+  init_decoder(num_threads);
+}
+
+inline lzma_source::lzma_source(uint32_t num_threads) : m_file{detail::open_stdin()}
+{
+  init_decoder(num_threads);
+}
+
+inline void lzma_source::init_decoder(uint32_t num_threads)
+{
+  m_buffer.resize(input_buffer_size);
+
+  auto stream = std::make_unique<lzma_stream>();
+  *stream = LZMA_STREAM_INIT;
+
+#if LZMA_VERSION >= 50040002
+  // Multithreaded decoding has become stable with liblzma 5.4.0
+  lzma_mt options{};
+  options.flags = LZMA_CONCATENATED;
+  options.threads = num_threads != 0 ? num_threads : std::thread::hardware_concurrency();
+  options.threads = options.threads != 0 ? options.threads : 1;
+  options.timeout = 0;
+
+  // Using fewer threads instead of exceeding a quarter of the memory, like xz
+  uint64_t const physical_memory = lzma_physmem();
+  options.memlimit_threading = physical_memory != 0 ? physical_memory / 4 : UINT64_MAX;
+  options.memlimit_stop = UINT64_MAX;
+
+  lzma_ret const result = lzma_stream_decoder_mt(stream.get(), &options);
+#else
+  static_cast<void>(num_threads);
+  lzma_ret const result = lzma_stream_decoder(stream.get(), UINT64_MAX, LZMA_CONCATENATED);
+#endif
+
+  detail::throw_on_lzma_error(result, "initializing liblzma failed");
+  m_stream = std::unique_ptr<lzma_stream, stream_deleter>{stream.release()};
+}
+
+inline auto lzma_source::read_bytes(std::byte* buf_start, std::byte* buf_stop) -> std::byte*
+{
+  m_stream->next_out = reinterpret_cast<uint8_t*>(buf_start);
+  m_stream->avail_out = buf_stop - buf_start;
+
+  while (m_stream->avail_out != 0 && !m_eof) {
+    if (m_stream->avail_in == 0 && !m_is_input_eof) {
+      std::byte* const stop = detail::read_input_file(
+          m_file.get(), m_buffer.data(), m_buffer.data() + m_buffer.size());
+      m_stream->next_in = reinterpret_cast<uint8_t const*>(m_buffer.data());
+      m_stream->avail_in = stop - m_buffer.data();
+      m_is_input_eof = m_stream->avail_in == 0;
+    }
+
+    // With LZMA_FINISH, truncated input is reported as LZMA_BUF_ERROR
+    lzma_ret const result = lzma_code(m_stream.get(), m_is_input_eof ? LZMA_FINISH : LZMA_RUN);
+    detail::throw_on_lzma_error(result, "xz decompression failed");
+    m_eof = result == LZMA_STREAM_END;
+  }
+
+  return reinterpret_cast<std::byte*>(m_stream->next_out);
+}
+
+inline auto lzma_source::read_byte() -> std::optional<std::byte>
+{
+  if (read_bytes(&m_byte_buffer, &m_byte_buffer + 1) == &m_byte_buffer) {
+    return std::nullopt;
+  }
+  return m_byte_buffer;
+}
+
+inline auto lzma_source::is_eof() -> bool
+{
+  return m_eof;
+}
+}
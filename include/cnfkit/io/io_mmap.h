@@ -0,0 +1,167 @@
+#pragma once
+
+/**
+ * \file
+ */
+
+#include <cnfkit/detail/check_cxx_version.h>
+
+#if !__has_include(<sys/mman.h>)
+#error "sys/mman.h not found. mmap_source is only supported on POSIX systems."
+#endif
+
+#include <cnfkit/io.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace cnfkit {
+
+/**
+ * \brief Reader for uncompressed files, mapping the file into memory.
+ *
+ * The parsers read the data of mmap_source objects in place, without
+ * copying it to intermediate buffers (see `source::borrow_bytes()`).
+ * `borrow_bytes()` lends all remaining data in a single block, which stays
+ * valid until the mmap_source object is destroyed.
+ *
+ * \ingroup io
+ */
+class mmap_source final : public source {
+public:
+  /**
+   * \brief Constructs an mmap_source object backed by the given file.
+   *
+   * The kernel is advised that the mapping is read sequentially and, where
+   * supported, that it may be backed by huge pages.
+   *
+   * \throws std::runtime_error   Thrown when opening or mapping the file failed.
+   */
+  explicit mmap_source(std::filesystem::path const& path);
+
+  auto read_bytes(std::byte* buf_start, std::byte* buf_stop) -> std::byte* override;
+  auto read_byte() -> std::optional<std::byte> override;
+  auto is_eof() -> bool override;
+  auto borrow_bytes() -> std::optional<byte_range> override;
+
+  virtual ~mmap_source();
+
+  auto operator=(mmap_source const&) -> mmap_source& = delete;
+  mmap_source(mmap_source const&) = delete;
+
+  auto operator=(mmap_source&& rhs) noexcept -> mmap_source&;
+  mmap_source(mmap_source&& rhs) noexcept;
+
+private:
+  void* m_mapping = nullptr;
+  size_t m_mapping_size = 0;
+
+  std::byte const* m_cursor = nullptr;
+  std::byte const* m_stop = nullptr;
+};
+
+// *** Implementation ***
+
+inline mmap_source::mmap_source(std::filesystem::path const& path)
+{
+  int const fd = ::open(path.string().c_str(), O_RDONLY);
+  if (fd == -1) {
+    throw std::runtime_error{"Could not open input file."};
+  }
+
+  struct stat file_status;
+  if (::fstat(fd, &file_status) == -1) {
+    ::close(fd);
+    throw std::runtime_error{"Could not determine the size of the input file."};
+  }
+
+  m_mapping_size = static_cast<size_t>(file_status.st_size);
+
+  // mmap() rejects empty mappings, so empty files are represented by an empty range
+  if (m_mapping_size != 0) {
+    m_mapping = ::mmap(nullptr, m_mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (m_mapping == MAP_FAILED) {
+      m_mapping = nullptr;
+      ::close(fd);
+      throw std::runtime_error{"Could not map the input file."};
+    }
+
+    // The advice is merely a hint, so failures are ignored
+    ::madvise(m_mapping, m_mapping_size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    ::madvise(m_mapping, m_mapping_size, MADV_HUGEPAGE);
+#endif
+  }
+
+  // The mapping stays valid after the file has been closed
+  ::close(fd);
+
+  m_cursor = static_cast<std::byte const*>(m_mapping);
+  m_stop = m_cursor + m_mapping_size;
+}
+
+inline mmap_source::~mmap_source()
+{
+  if (m_mapping != nullptr) {
+    ::munmap(m_mapping, m_mapping_size);
+  }
+}
+
+inline auto mmap_source::read_bytes(std::byte* buf_start, std::byte* buf_stop) -> std::byte*
+{
+  size_t const to_copy =
+      std::min(static_cast<size_t>(buf_stop - buf_start), static_cast<size_t>(m_stop - m_cursor));
+  if (to_copy != 0) {
+    std::memcpy(buf_start, m_cursor, to_copy);
+    m_cursor += to_copy;
+  }
+  return buf_start + to_copy;
+}
+
+inline auto mmap_source::read_byte() -> std::optional<std::byte>
+{
+  if (m_cursor == m_stop) {
+    return std::nullopt;
+  }
+  return *(m_cursor++);
+}
+
+inline auto mmap_source::is_eof() -> bool
+{
+  return m_cursor == m_stop;
+}
+
+inline auto mmap_source::borrow_bytes() -> std::optional<byte_range>
+{
+  byte_range const result{m_cursor, m_stop};
+  m_cursor = m_stop;
+  return result;
+}
+
+inline auto mmap_source::operator=(mmap_source&& rhs) noexcept -> mmap_source&
+{
+  std::swap(m_mapping, rhs.m_mapping);
+  std::swap(m_mapping_size, rhs.m_mapping_size);
+  std::swap(m_cursor, rhs.m_cursor);
+  std::swap(m_stop, rhs.m_stop);
+  return *this;
+}
+
+inline mmap_source::mmap_source(mmap_source&& rhs) noexcept
+{
+  std::swap(m_mapping, rhs.m_mapping);
+  std::swap(m_mapping_size, rhs.m_mapping_size);
+  std::swap(m_cursor, rhs.m_cursor);
+  std::swap(m_stop, rhs.m_stop);
+}
+}
@@ -0,0 +1,242 @@
+#pragma once
+
+/**
+ * \file
+ */
+
+#include <cnfkit/detail/check_cxx_version.h>
+
+#include <cnfkit/io.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace cnfkit {
+
+/**
+ * \brief Decorator reading ahead from another source on a background thread.
+ *
+ * A prefetching_source object reads the data of the wrapped source into a
+ * ring of buffers on a dedicated thread, so reading (and in particular
+ * decompressing) the data overlaps with parsing it. The parsers read the
+ * buffers in place, without copying them (see `source::borrow_bytes()`).
+ *
+ * After the construction of a prefetching_source object, the wrapped source
+ * must not be accessed until the prefetching_source object has been
+ * destroyed. Errors occurring while reading the wrapped source are reported
+ * after all data read before the error has been consumed.
+ *
+ * \ingroup io
+ */
+class prefetching_source final : public source {
+public:
+  constexpr static size_t default_buffer_size = (1 << 20);
+  constexpr static size_t default_num_buffers = 4;
+
+  /**
+   * \brief Constructs a prefetching_source object reading from `source`.
+   *
+   * The background thread reads at most `num_buffers` buffers of size
+   * `buffer_size` ahead.
+   *
+   * \throws std::invalid_argument  Thrown if `buffer_size` or `num_buffers` is 0.
+   * \throws std::system_error      Thrown if the background thread could not be started.
+   */
+  explicit prefetching_source(source& source,
+                              size_t buffer_size = default_buffer_size,
+                              size_t num_buffers = default_num_buffers);
+
+  auto read_bytes(std::byte* buf_start, std::byte* buf_stop) -> std::byte* override;
+  auto read_byte() -> std::optional<std::byte> override;
+  auto is_eof() -> bool override;
+  auto borrow_bytes() -> std::optional<byte_range> override;
+
+  virtual ~prefetching_source();
+
+  auto operator=(prefetching_source const&) -> prefetching_source& = delete;
+  prefetching_source(prefetching_source const&) = delete;
+  auto operator=(prefetching_source&&) -> prefetching_source& = delete;
+  prefetching_source(prefetching_source&&) = delete;
+
+private:
+  struct buffer {
+    std::vector<std::byte> data;
+    size_t fill = 0;
+  };
+
+  void prefetch();
+  auto acquire_data() -> bool;
+
+  source& m_source;
+  std::vector<buffer> m_buffers;
+
+  // Buffers m_buffers[i % m_buffers.size()] with m_num_released <= i < m_num_filled
+  // contain data not yet consumed. All members below are protected by m_mutex,
+  // except for the consumer-side cursor.
+  std::mutex m_mutex;
+  std::condition_variable m_filled_cv;
+  std::condition_variable m_released_cv;
+  size_t m_num_filled = 0;
+  size_t m_num_released = 0;
+  bool m_is_prefetching_done = false;
+  bool m_is_stop_requested = false;
+  std::exception_ptr m_error;
+
+  bool m_has_current_buffer = false;
+  std::byte const* m_cursor = nullptr;
+  std::byte const* m_stop = nullptr;
+
+  std::thread m_prefetcher;
+};
+
+// *** Implementation ***
+
+inline prefetching_source::prefetching_source(source& source,
+                                              size_t buffer_size,
+                                              size_t num_buffers)
+  : m_source{source}
+{
+  if (buffer_size == 0 || num_buffers == 0) {
+    throw std::invalid_argument{"buffer size and number of buffers must be positive"};
+  }
+
+  m_buffers.resize(num_buffers);
+  for (buffer& buf : m_buffers) {
+    buf.data.resize(buffer_size);
+  }
+
+  m_prefetcher = std::thread{[this]() { prefetch(); }};
+}
+
+inline prefetching_source::~prefetching_source()
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_is_stop_requested = true;
+  }
+  m_released_cv.notify_one();
+  m_prefetcher.join();
+}
+
+inline void prefetching_source::prefetch()
+{
+  size_t num_filled = 0;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_released_cv.wait(lock, [this, num_filled]() {
+        return m_is_stop_requested || num_filled - m_num_released < m_buffers.size();
+      });
+      if (m_is_stop_requested) {
+        break;
+      }
+    }
+
+    // The buffer is not accessed by the consumer until m_num_filled is incremented
+    buffer& buf = m_buffers[num_filled % m_buffers.size()];
+    bool is_eof = false;
+    std::exception_ptr error;
+    try {
+      std::byte* const buf_start = buf.data.data();
+      std::byte* const read_stop = m_source.read_bytes(buf_start, buf_start + buf.data.size());
+      buf.fill = read_stop - buf_start;
+      is_eof = buf.fill < buf.data.size() || m_source.is_eof();
+    }
+    catch (...) {
+      error = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      if (error == nullptr && buf.fill != 0) {
+        ++num_filled;
+        m_num_filled = num_filled;
+      }
+      m_error = error;
+      m_is_prefetching_done = is_eof || error != nullptr;
+    }
+    m_filled_cv.notify_one();
+
+    if (is_eof || error != nullptr) {
+      break;
+    }
+  }
+}
+
+inline auto prefetching_source::acquire_data() -> bool
+{
+  if (m_cursor != m_stop) {
+    return true;
+  }
+
+  std::unique_lock<std::mutex> lock{m_mutex};
+
+  if (m_has_current_buffer) {
+    m_has_current_buffer = false;
+    ++m_num_released;
+    m_released_cv.notify_one();
+  }
+
+  m_filled_cv.wait(
+      lock, [this]() { return m_num_filled != m_num_released || m_is_prefetching_done; });
+
+  if (m_num_filled == m_num_released) {
+    if (m_error != nullptr) {
+      std::rethrow_exception(m_error);
+    }
+    return false;
+  }
+
+  buffer const& buf = m_buffers[m_num_released % m_buffers.size()];
+  m_has_current_buffer = true;
+  m_cursor = buf.data.data();
+  m_stop = m_cursor + buf.fill;
+  return true;
+}
+
+inline auto prefetching_source::read_bytes(std::byte* buf_start, std::byte* buf_stop) -> std::byte*
+{
+  std::byte* cursor = buf_start;
+  while (cursor != buf_stop && acquire_data()) {
+    size_t const to_copy =
+        std::min(static_cast<size_t>(buf_stop - cursor), static_cast<size_t>(m_stop - m_cursor));
+    std::memcpy(cursor, m_cursor, to_copy);
+    cursor += to_copy;
+    m_cursor += to_copy;
+  }
+  return cursor;
+}
+
+inline auto prefetching_source::read_byte() -> std::optional<std::byte>
+{
+  if (!acquire_data()) {
+    return std::nullopt;
+  }
+  return *(m_cursor++);
+}
+
+inline auto prefetching_source::is_eof() -> bool
+{
+  return !acquire_data();
+}
+
+inline auto prefetching_source::borrow_bytes() -> std::optional<byte_range>
+{
+  if (!acquire_data()) {
+    return byte_range{};
+  }
+
+  byte_range const result{m_cursor, m_stop};
+  m_cursor = m_stop;
+  return result;
+}
+}
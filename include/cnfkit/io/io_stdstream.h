@@ -8,6 +8,8 @@
 #include <istream>
 #include <optional>
 #include <ostream>
+#include <stdexcept>
+#include <streambuf>
 
 namespace cnfkit {
 
@@ -56,6 +58,68 @@ private:
   std::ostream* m_output = nullptr;
 };
 
+/**
+ * \brief Reader for std::streambuf objects.
+ *
+ * Unlike istream_source, this class reads from the stream buffer directly,
+ * without constructing a sentry object and checking the stream state for
+ * each read. This is considerably faster when the parsers read single bytes.
+ *
+ * Stream buffers do not distinguish I/O failures from EOF, so errors are
+ * only reported if the stream buffer throws an exception.
+ *
+ * \ingroup io
+ */
+class streambuf_source final : public source {
+public:
+  explicit streambuf_source(std::streambuf& buf);
+
+  auto read_bytes(std::byte* start, std::byte* stop) -> std::byte* override;
+  auto read_byte() -> std::optional<std::byte> override;
+  auto is_eof() -> bool override;
+
+  auto operator=(streambuf_source const&) -> streambuf_source& = delete;
+  streambuf_source(streambuf_source const&) = delete;
+
+  auto operator=(streambuf_source&& rhs) noexcept -> streambuf_source& = default;
+  streambuf_source(streambuf_source&&) noexcept = default;
+
+private:
+  std::streambuf* m_input = nullptr;
+};
+
+/**
+ * \brief Non-compressing writer for std::streambuf objects.
+ *
+ * Unlike ostream_sink, this class writes to the stream buffer directly,
+ * bypassing the stream state checks of std::ostream.
+ *
+ * \ingroup io
+ */
+class streambuf_sink final : public sink {
+public:
+  explicit streambuf_sink(std::streambuf& buf);
+
+  /**
+   * \throws std::runtime_error   Thrown if the stream buffer did not accept all data.
+   */
+  void write_bytes(std::byte const* start, std::byte const* stop) override;
+
+  /**
+   * \throws std::runtime_error   Thrown if synchronizing the stream buffer failed.
+   */
+  void flush() override;
+
+  auto operator=(streambuf_sink const&) -> streambuf_sink& = delete;
+  streambuf_sink(streambuf_sink const&) = delete;
+
+  auto operator=(streambuf_sink&& rhs) noexcept -> streambuf_sink& = default;
+  streambuf_sink(streambuf_sink&& rhs) noexcept = default;
+
+private:
+  std::streambuf* m_output = nullptr;
+};
+
 
 // *** Implementation ***
 
@@ -126,4 +190,69 @@ inline void ostream_sink::flush()
     throw std::runtime_error{"I/O error"};
   }
 }
+
+inline streambuf_source::streambuf_source(std::streambuf& buf) : m_input{&buf} {}
+
+inline auto streambuf_source::read_bytes(std::byte* start, std::byte* stop) -> std::byte*
+{
+  if (m_input == nullptr) {
+    return start;
+  }
+
+  // sgetn() only returns less data than requested at EOF
+  std::streamsize const num_read =
+      m_input->sgetn(reinterpret_cast<char*>(start), std::distance(start, stop));
+  return start + num_read;
+}
+
+inline auto streambuf_source::read_byte() -> std::optional<std::byte>
+{
+  if (m_input == nullptr) {
+    return std::nullopt;
+  }
+
+  using traits = std::streambuf::traits_type;
+  traits::int_type const result = m_input->sbumpc();
+  if (traits::eq_int_type(result, traits::eof())) {
+    return std::nullopt;
+  }
+  return static_cast<std::byte>(traits::to_char_type(result));
+}
+
+inline auto streambuf_source::is_eof() -> bool
+{
+  if (m_input == nullptr) {
+    return true;
+  }
+
+  // in_avail() is positive iff buffered data is available. Otherwise, sgetc()
+  // tries to refill the buffer without consuming data.
+  using traits = std::streambuf::traits_type;
+  return m_input->in_avail() <= 0 && traits::eq_int_type(m_input->sgetc(), traits::eof());
+}
+
+inline streambuf_sink::streambuf_sink(std::streambuf& buf) : m_output{&buf} {}
+
+inline void streambuf_sink::write_bytes(std::byte const* start, std::byte const* stop)
+{
+  if (m_output == nullptr) {
+    return;
+  }
+
+  std::streamsize const size = std::distance(start, stop);
+  if (m_output->sputn(reinterpret_cast<char const*>(start), size) != size) {
+    throw std::runtime_error{"I/O error"};
+  }
+}
+
+inline void streambuf_sink::flush()
+{
+  if (m_output == nullptr) {
+    return;
+  }
+
+  if (m_output->pubsync() == -1) {
+    throw std::runtime_error{"I/O error"};
+  }
+}
 }
@@ -14,9 +14,14 @@
 
 #include <zlib.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <filesystem>
+#include <memory>
 #include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace cnfkit {
 
@@ -61,6 +66,90 @@ private:
   gzFile m_file = nullptr;
 };
 
+/**
+ * \brief Writer compressing data in the gzip format.
+ *
+ * This class uses the zlib library. The compressed data is written to
+ * another sink. The gzip stream is completed by `finish()`, or on destruction
+ * of the zlib_sink object.
+ *
+ * \ingroup io
+ */
+class zlib_sink final : public sink {
+public:
+  constexpr static size_t default_buffer_size = (1 << 16);
+
+  /**
+   * \brief Constructs a zlib_sink object writing the compressed data to `sink`.
+   *
+   * \param level   The zlib compression level, ranging from 0 (no compression) to 9
+   *                (best compression). Z_DEFAULT_COMPRESSION selects the default level.
+   *
+   * \throws std::invalid_argument   Thrown if `level` is not a valid compression level or
+   *                                `buffer_size` is 0.
+   */
+  explicit zlib_sink(sink& sink,
+                     int level = Z_DEFAULT_COMPRESSION,
+                     size_t buffer_size = default_buffer_size);
+
+  /**
+   * \throws std::runtime_error   Thrown on I/O failure or when called after `finish()`.
+   */
+  void write_bytes(std::byte const* start, std::byte const* stop) override;
+
+  /**
+   * \brief Writes all data passed so far to the wrapped sink, then flushes the wrapped sink.
+   *
+   * Flushing frequently degrades compression.
+   *
+   * \throws std::runtime_error   Thrown on I/O failure.
+   */
+  void flush() override;
+
+  /**
+   * \brief Completes the gzip stream and flushes the wrapped sink.
+   *
+   * After calling this function, no further data may be written.
+   *
+   * \throws std::runtime_error   Thrown on I/O failure.
+   */
+  void finish();
+
+  /**
+   * \brief Calls `finish()` unless it has already been called, ignoring errors.
+   */
+  virtual ~zlib_sink();
+
+  auto operator=(zlib_sink const&) -> zlib_sink& = delete;
+  zlib_sink(zlib_sink const&) = delete;
+
+  /**
+   * \brief Completes the stream of this object like the destructor, then takes
+   *        over the stream of `rhs`.
+   */
+  auto operator=(zlib_sink&& rhs) noexcept -> zlib_sink&;
+  zlib_sink(zlib_sink&& rhs) noexcept = default;
+
+private:
+  void deflate_input(int flush_mode);
+  void finish_ignoring_errors() noexcept;
+
+  struct stream_deleter {
+    void operator()(z_stream* stream) const noexcept
+    {
+      deflateEnd(stream);
+      delete stream;
+    }
+  };
+
+  sink* m_sink = nullptr;
+
+  // zlib streams must not be moved after initialization
+  std::unique_ptr<z_stream, stream_deleter> m_stream;
+  std::vector<std::byte> m_buffer;
+  bool m_is_finished = false;
+};
+
 /** Implementation **/
 
 inline zlib_source::zlib_source(std::filesystem::path const& path)
@@ -148,4 +237,114 @@ inline zlib_source::zlib_source(zlib_source&& rhs) noexcept
 {
   std::swap(m_file, rhs.m_file);
 }
+
+inline zlib_sink::zlib_sink(sink& sink, int level, size_t buffer_size) : m_sink{&sink}
+{
+  if (buffer_size == 0) {
+    throw std::invalid_argument{"buffer size must be positive"};
+  }
+  m_buffer.resize(buffer_size);
+
+  auto stream = std::make_unique<z_stream>();
+  stream->zalloc = Z_NULL;
+  stream->zfree = Z_NULL;
+  stream->opaque = Z_NULL;
+
+  // Window bits 15 + 16: maximum window size, writing gzip headers
+  int const result = deflateInit2(stream.get(), level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+  if (result == Z_STREAM_ERROR) {
+    throw std::invalid_argument{"invalid zlib compression level"};
+  }
+  if (result != Z_OK) {
+    throw std::runtime_error{"initializing zlib failed"};
+  }
+
+  m_stream = std::unique_ptr<z_stream, stream_deleter>{stream.release()};
+}
+
+inline zlib_sink::~zlib_sink()
+{
+  finish_ignoring_errors();
+}
+
+inline auto zlib_sink::operator=(zlib_sink&& rhs) noexcept -> zlib_sink&
+{
+  if (this != &rhs) {
+    finish_ignoring_errors();
+    m_sink = rhs.m_sink;
+    m_stream = std::move(rhs.m_stream);
+    m_buffer = std::move(rhs.m_buffer);
+    m_is_finished = rhs.m_is_finished;
+  }
+  return *this;
+}
+
+inline void zlib_sink::finish_ignoring_errors() noexcept
+{
+  if (m_stream != nullptr && !m_is_finished) {
+    try {
+      finish();
+    }
+    catch (...) {
+      // Errors can only be reported by finish()
+    }
+  }
+}
+
+inline void zlib_sink::write_bytes(std::byte const* start, std::byte const* stop)
+{
+  if (m_is_finished) {
+    throw std::runtime_error{"writing to finished zlib_sink"};
+  }
+
+  // avail_in is an unsigned int, so large inputs are passed in parts
+  constexpr size_t max_part_size = (1 << 30);
+  while (start != stop) {
+    size_t const part_size = std::min(static_cast<size_t>(stop - start), max_part_size);
+    m_stream->next_in = reinterpret_cast<Bytef*>(const_cast<std::byte*>(start));
+    m_stream->avail_in = static_cast<uInt>(part_size);
+    deflate_input(Z_NO_FLUSH);
+    start += part_size;
+  }
+}
+
+inline void zlib_sink::flush()
+{
+  if (!m_is_finished) {
+    deflate_input(Z_SYNC_FLUSH);
+  }
+  m_sink->flush();
+}
+
+inline void zlib_sink::finish()
+{
+  if (!m_is_finished) {
+    m_is_finished = true;
+    deflate_input(Z_FINISH);
+  }
+  m_sink->flush();
+}
+
+inline void zlib_sink::deflate_input(int flush_mode)
+{
+  // With Z_NO_FLUSH, deflate() is done when all input has been consumed. Otherwise,
+  // it is done when the output buffer has not been filled completely.
+  bool is_done = false;
+  while (!is_done) {
+    m_stream->next_out = reinterpret_cast<Bytef*>(m_buffer.data());
+    m_stream->avail_out = static_cast<uInt>(m_buffer.size());
+
+    int const result = deflate(m_stream.get(), flush_mode);
+    if (result == Z_STREAM_ERROR) {
+      throw std::runtime_error{"zlib compression failed"};
+    }
+
+    size_t const num_written = m_buffer.size() - m_stream->avail_out;
+    if (num_written != 0) {
+      m_sink->write_bytes(m_buffer.data(), m_buffer.data() + num_written);
+    }
+
+    is_done = flush_mode == Z_NO_FLUSH ? m_stream->avail_in == 0 : m_stream->avail_out != 0;
+  }
+}
 }
@@ -0,0 +1,935 @@
+#pragma once
+
+/**
+ * \file
+ */
+
+#include <cnfkit/detail/check_cxx_version.h>
+
+#if !__has_include(<zlib.h>)
+#error "zlib.h not found. The headers of zlib must be added to the include search path."
+#endif
+
+#include <cnfkit/detail/input_file.h>
+#include <cnfkit/io.h>
+#include <cnfkit/io/io_stdstream.h>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace cnfkit {
+
+/**
+ * \brief Position in a gzip file at which decompression can be started.
+ *
+ * \ingroup io
+ */
+struct gzip_access_point {
+  /// Offset of the access point in the decompressed data
+  uint64_t uncompressed_offset = 0;
+
+  /// Offset of the first full byte of the deflate block starting at the access point
+  uint64_t compressed_offset = 0;
+
+  /// If nonzero, the block starts with the highest `num_bits` bits of the preceding byte
+  uint32_t num_bits = 0;
+
+  /// The (up to 32 KiB of) decompressed data preceding the access point
+  std::vector<std::byte> window;
+};
+
+/**
+ * \brief Index of access points of a gzip file.
+ *
+ * The index divides the decompressed data of a gzip file into regions
+ * starting at access points, which can be decompressed independently of each
+ * other. Building an index requires decompressing the entire file once,
+ * but indices can be saved and loaded (see `load_or_build_gzip_index()`).
+ *
+ * \ingroup io
+ */
+class gzip_index {
+public:
+  gzip_index() = default;
+
+  /**
+   * \throws std::invalid_argument   Thrown if the access points are not sorted by
+   *                                 their offsets or exceed the given sizes, or if
+   *                                 `span` is 0.
+   */
+  gzip_index(std::vector<gzip_access_point> access_points,
+             uint64_t compressed_size,
+             uint64_t uncompressed_size,
+             uint64_t span,
+             uint64_t fingerprint);
+
+  auto get_access_points() const noexcept -> std::vector<gzip_access_point> const&;
+
+  /// The size of the indexed gzip file
+  auto get_compressed_size() const noexcept -> uint64_t;
+  auto get_uncompressed_size() const noexcept -> uint64_t;
+
+  /// The number of independently decompressible regions
+  auto get_num_regions() const noexcept -> size_t;
+
+  /// The size of the decompressed data of the given region
+  auto get_region_size(size_t region) const noexcept -> uint64_t;
+
+  /// The span with which the index has been built (see `build_gzip_index()`)
+  auto get_span() const noexcept -> uint64_t;
+
+  /// Checksum of the first and last 4 KiB of the indexed gzip file, identifying its contents
+  auto get_fingerprint() const noexcept -> uint64_t;
+
+private:
+  std::vector<gzip_access_point> m_access_points;
+  uint64_t m_compressed_size = 0;
+  uint64_t m_uncompressed_size = 0;
+  uint64_t m_span = 0;
+  uint64_t m_fingerprint = 0;
+};
+
+/**
+ * \brief Builds an index for the given gzip file.
+ *
+ * \ingroup io
+ *
+ * The file is decompressed once, verifying its checksums. Access points are
+ * placed at the first deflate block boundary after each `span` bytes of
+ * decompressed data. Each access point requires about 32 KiB of memory.
+ *
+ * Files consisting of multiple gzip members are supported. Data following
+ * the last gzip member that does not start with the gzip magic number is
+ * ignored, like `zlib_source` does.
+ *
+ * \throws std::invalid_argument   Thrown if `span` is 0.
+ * \throws std::runtime_error      Thrown on I/O failure or if the file is corrupt.
+ */
+auto build_gzip_index(std::filesystem::path const& path, uint64_t span = (1 << 22)) -> gzip_index;
+
+/**
+ * \brief Writes the index to `sink` in a binary file format.
+ *
+ * \ingroup io
+ *
+ * All values are stored in the byte order of the writing machine.
+ *
+ * \throws std::runtime_error      on I/O failure.
+ */
+void write_gzip_index(gzip_index const& index, sink& sink);
+
+/**
+ * \brief Reads an index written by `write_gzip_index()` from `source`.
+ *
+ * \ingroup io
+ *
+ * \throws std::invalid_argument   when the data is not a valid index file written on a
+ *                                 machine with the same byte order.
+ * \throws std::runtime_error      on I/O failure.
+ */
+auto read_gzip_index(source& source) -> gzip_index;
+
+/**
+ * \brief Loads the index of the gzip file at `path` from `index_path`, or builds
+ *        the index and saves it to `index_path`.
+ *
+ * \ingroup io
+ *
+ * The index is rebuilt if the file at `index_path` is not a valid index file,
+ * has been built with a different span, or has been built for a file with a
+ * different size or fingerprint (see `gzip_index::get_fingerprint()`). Failures
+ * to save the index are ignored.
+ *
+ * \throws std::invalid_argument   Thrown if `span` is 0.
+ * \throws std::runtime_error      Thrown on I/O failure or if the gzip file is corrupt.
+ */
+auto load_or_build_gzip_index(std::filesystem::path const& path,
+                              std::filesystem::path const& index_path,
+                              uint64_t span = (1 << 22)) -> gzip_index;
+
+/**
+ * \brief Decompresses a gzip file on multiple threads.
+ *
+ * \ingroup io
+ *
+ * The regions of `index` are decompressed concurrently, writing the
+ * decompressed data of the entire file to `[out, out + index.get_uncompressed_size())`.
+ * Checksums are only verified when building the index, and the index is
+ * matched to the file via its size and fingerprint. The result can be parsed
+ * on multiple threads via `parse_cnf_parallel()`.
+ *
+ * \param num_threads   The maximum number of threads used for decompressing, including
+ *                      the calling thread. Must be positive.
+ *
+ * \throws std::invalid_argument   Thrown if `num_threads` is 0 or `index` does not match the file.
+ * \throws std::runtime_error      Thrown on I/O failure or if the file is corrupt.
+ * \throws std::system_error       Thrown if a thread could not be started.
+ */
+void decompress_gzip_parallel(std::filesystem::path const& path,
+                              gzip_index const& index,
+                              std::byte* out,
+                              size_t num_threads);
+
+/**
+ * \brief Reader for gzip files, decompressing the data ahead on multiple threads.
+ *
+ * The regions of the index are decompressed concurrently by background
+ * threads, and the decompressed data is read sequentially. At most two
+ * regions per thread are held in memory. The parsers read the regions in
+ * place, without copying them (see `source::borrow_bytes()`).
+ *
+ * Checksums are only verified when building the index, and the index is
+ * matched to the file via its size and fingerprint. Errors occurring while
+ * decompressing a region are reported when the region is read.
+ *
+ * \ingroup io
+ */
+class parallel_gzip_source final : public source {
+public:
+  /**
+   * \brief Constructs a parallel_gzip_source object reading the given file.
+   *
+   * \param num_threads   The number of background threads decompressing the data.
+   *                      Must be positive.
+   *
+   * \throws std::invalid_argument   Thrown if `num_threads` is 0 or `index` does not match
+   *                                 the file.
+   * \throws std::runtime_error      Thrown on I/O failure.
+   * \throws std::system_error       Thrown if a thread could not be started.
+   */
+  parallel_gzip_source(std::filesystem::path const& path, gzip_index index, size_t num_threads);
+
+  auto read_bytes(std::byte* buf_start, std::byte* buf_stop) -> std::byte* override;
+  auto read_byte() -> std::optional<std::byte> override;
+  auto is_eof() -> bool override;
+  auto borrow_bytes() -> std::optional<byte_range> override;
+
+  virtual ~parallel_gzip_source();
+
+  auto operator=(parallel_gzip_source const&) -> parallel_gzip_source& = delete;
+  parallel_gzip_source(parallel_gzip_source const&) = delete;
+  auto operator=(parallel_gzip_source&&) -> parallel_gzip_source& = delete;
+  parallel_gzip_source(parallel_gzip_source&&) = delete;
+
+private:
+  struct slot {
+    std::vector<std::byte> data;
+    bool is_ready = false;
+    std::exception_ptr error;
+  };
+
+  void decompress_regions();
+  auto acquire_data() -> bool;
+
+  std::filesystem::path m_path;
+  gzip_index m_index;
+  std::vector<slot> m_slots;
+
+  // Region i is decompressed into m_slots[i % m_slots.size()]. Regions with
+  // m_num_released <= i < m_num_claimed are owned by the decompressing threads
+  // until they are ready. All members below are protected by m_mutex, except
+  // for the consumer-side cursor.
+  std::mutex m_mutex;
+  std::condition_variable m_ready_cv;
+  std::condition_variable m_released_cv;
+  size_t m_num_claimed = 0;
+  size_t m_num_released = 0;
+  bool m_is_stop_requested = false;
+
+  bool m_has_current_slot = false;
+  std::byte const* m_cursor = nullptr;
+  std::byte const* m_stop = nullptr;
+
+  std::vector<std::thread> m_threads;
+};
+
+// *** Implementation ***
+
+namespace detail {
+constexpr size_t gzip_window_size = 32768;
+constexpr size_t gzip_input_buffer_size = (1 << 20);
+
+struct inflate_stream_deleter {
+  void operator()(z_stream* stream) const noexcept
+  {
+    inflateEnd(stream);
+    delete stream;
+  }
+};
+
+using inflate_stream = std::unique_ptr<z_stream, inflate_stream_deleter>;
+
+// Window bits: 15 for raw deflate data, 15 + 16 for gzip data
+inline auto create_inflate_stream(int window_bits) -> inflate_stream
+{
+  auto stream = std::make_unique<z_stream>();
+  stream->zalloc = Z_NULL;
+  stream->zfree = Z_NULL;
+  stream->opaque = Z_NULL;
+  stream->next_in = Z_NULL;
+  stream->avail_in = 0;
+
+  if (inflateInit2(stream.get(), window_bits) != Z_OK) {
+    throw std::runtime_error{"initializing zlib failed"};
+  }
+  return inflate_stream{stream.release()};
+}
+
+inline void throw_on_inflate_error(int result)
+{
+  if (result == Z_NEED_DICT || result == Z_DATA_ERROR) {
+    throw std::runtime_error{"gzip data is corrupt"};
+  }
+  if (result == Z_MEM_ERROR) {
+    throw std::bad_alloc{};
+  }
+  if (result == Z_STREAM_ERROR) {
+    throw std::runtime_error{"zlib decompression failed"};
+  }
+}
+
+// Reads the next block of input if the stream's input is exhausted, returning
+// false at EOF
+inline auto refill_inflate_input(std::FILE* file, z_stream& stream, std::vector<std::byte>& buffer)
+    -> bool
+{
+  if (stream.avail_in == 0) {
+    std::byte* const stop = read_input_file(file, buffer.data(), buffer.data() + buffer.size());
+    stream.next_in = reinterpret_cast<Bytef*>(buffer.data());
+    stream.avail_in = static_cast<uInt>(stop - buffer.data());
+  }
+  return stream.avail_in != 0;
+}
+
+// Decompresses `size` bytes starting at the access point to `out`
+inline void inflate_gzip_region(std::FILE* file,
+                                gzip_access_point const& point,
+                                std::byte* out,
+                                uint64_t size,
+                                std::vector<std::byte>& input_buffer)
+{
+  seek_input_file(file, point.compressed_offset - (point.num_bits != 0 ? 1 : 0));
+  inflate_stream stream = create_inflate_stream(-15);
+
+  if (point.num_bits != 0) {
+    int const byte = std::fgetc(file);
+    if (byte == EOF) {
+      throw std::runtime_error{"gzip file is truncated"};
+    }
+    inflatePrime(stream.get(), static_cast<int>(point.num_bits), byte >> (8 - point.num_bits));
+  }
+
+  if (!point.window.empty()) {
+    inflateSetDictionary(stream.get(),
+                         reinterpret_cast<Bytef const*>(point.window.data()),
+                         static_cast<uInt>(point.window.size()));
+  }
+
+  // The region may extend into subsequent gzip members. At the end of the
+  // raw deflate data, the gzip trailer is skipped and the stream is switched
+  // to reading gzip data, which includes the trailers.
+  bool is_raw = true;
+  size_t num_trailer_bytes_to_skip = 0;
+
+  std::byte* cursor = out;
+  std::byte* const stop = out + size;
+  while (cursor != stop) {
+    if (!refill_inflate_input(file, *stream, input_buffer)) {
+      throw std::runtime_error{"gzip file is truncated"};
+    }
+
+    if (num_trailer_bytes_to_skip != 0) {
+      size_t const num_skipped = std::min<size_t>(num_trailer_bytes_to_skip, stream->avail_in);
+      stream->next_in += num_skipped;
+      stream->avail_in -= static_cast<uInt>(num_skipped);
+      num_trailer_bytes_to_skip -= num_skipped;
+      if (num_trailer_bytes_to_skip == 0) {
+        inflateReset2(stream.get(), 15 + 16);
+      }
+      continue;
+    }
+
+    constexpr uint64_t max_step = (1 << 30);
+    stream->next_out = reinterpret_cast<Bytef*>(cursor);
+    stream->avail_out = static_cast<uInt>(std::min<uint64_t>(stop - cursor, max_step));
+
+    int const result = inflate(stream.get(), Z_NO_FLUSH);
+    throw_on_inflate_error(result);
+    cursor = reinterpret_cast<std::byte*>(stream->next_out);
+
+    if (result == Z_STREAM_END) {
+      if (is_raw) {
+        is_raw = false;
+        num_trailer_bytes_to_skip = 8;
+      }
+      else {
+        inflateReset(stream.get());
+      }
+    }
+  }
+}
+
+struct gzip_index_file_header {
+  char magic[8];
+  uint32_t byte_order_mark;
+  uint32_t reserved;
+  uint64_t compressed_size;
+  uint64_t uncompressed_size;
+  uint64_t span;
+  uint64_t fingerprint;
+  uint64_t num_access_points;
+};
+
+struct gzip_index_file_access_point {
+  uint64_t uncompressed_offset;
+  uint64_t compressed_offset;
+  uint32_t num_bits;
+  uint32_t window_size;
+};
+
+constexpr char gzip_index_file_magic[8] = {'C', 'N', 'F', 'K', 'G', 'Z', 'I', '2'};
+constexpr uint32_t gzip_index_file_byte_order_mark = 0x01020304;
+
+static_assert(sizeof(gzip_index_file_header) == 56);
+static_assert(sizeof(gzip_index_file_access_point) == 24);
+
+constexpr size_t gzip_fingerprint_part_size = 4096;
+
+// Computes the CRC32 checksums of the first and last 4 KiB of the file, covering
+// the header of the first gzip member and the trailer of the last one
+inline auto compute_gzip_fingerprint(std::filesystem::path const& path) -> uint64_t
+{
+  input_file const file = open_input_file(path);
+  uint64_t const file_size = std::filesystem::file_size(path);
+  std::vector<std::byte> buffer(gzip_fingerprint_part_size);
+
+  auto checksum_part = [&file, &buffer](uint64_t offset) -> uint64_t {
+    seek_input_file(file.get(), offset);
+    std::byte* const stop =
+        read_input_file(file.get(), buffer.data(), buffer.data() + buffer.size());
+    return crc32(crc32(0, nullptr, 0),
+                 reinterpret_cast<Bytef const*>(buffer.data()),
+                 static_cast<uInt>(stop - buffer.data()));
+  };
+
+  uint64_t const last_part_offset =
+      file_size > gzip_fingerprint_part_size ? file_size - gzip_fingerprint_part_size : 0;
+  return (checksum_part(0) << 32) | checksum_part(last_part_offset);
+}
+
+inline void check_gzip_index(std::filesystem::path const& path, gzip_index const& index)
+{
+  if (std::filesystem::file_size(path) != index.get_compressed_size() ||
+      compute_gzip_fingerprint(path) != index.get_fingerprint()) {
+    throw std::invalid_argument{"the gzip index does not match the file"};
+  }
+}
+}
+
+inline gzip_index::gzip_index(std::vector<gzip_access_point> access_points,
+                              uint64_t compressed_size,
+                              uint64_t uncompressed_size,
+                              uint64_t span,
+                              uint64_t fingerprint)
+  : m_access_points{std::move(access_points)}
+  , m_compressed_size{compressed_size}
+  , m_uncompressed_size{uncompressed_size}
+  , m_span{span}
+  , m_fingerprint{fingerprint}
+{
+  if (span == 0) {
+    throw std::invalid_argument{"the span must be positive"};
+  }
+
+  uint64_t last_uncompressed_offset = 0;
+  uint64_t last_compressed_offset = 0;
+  for (gzip_access_point const& point : m_access_points) {
+    if (point.uncompressed_offset < last_uncompressed_offset ||
+        point.compressed_offset < last_compressed_offset ||
+        point.uncompressed_offset > uncompressed_size ||
+        point.compressed_offset > compressed_size || point.num_bits >= 8 ||
+        (point.num_bits != 0 && point.compressed_offset == 0) ||
+        point.window.size() > detail::gzip_window_size) {
+      throw std::invalid_argument{"invalid gzip access point"};
+    }
+    last_uncompressed_offset = point.uncompressed_offset;
+    last_compressed_offset = point.compressed_offset;
+  }
+
+  if (m_access_points.empty() ? uncompressed_size != 0
+                              : m_access_points.front().uncompressed_offset != 0) {
+    throw std::invalid_argument{"gzip index does not cover the decompressed data"};
+  }
+}
+
+inline auto gzip_index::get_access_points() const noexcept
+    -> std::vector<gzip_access_point> const&
+{
+  return m_access_points;
+}
+
+inline auto gzip_index::get_compressed_size() const noexcept -> uint64_t
+{
+  return m_compressed_size;
+}
+
+inline auto gzip_index::get_uncompressed_size() const noexcept -> uint64_t
+{
+  return m_uncompressed_size;
+}
+
+inline auto gzip_index::get_num_regions() const noexcept -> size_t
+{
+  return m_access_points.size();
+}
+
+inline auto gzip_index::get_region_size(size_t region) const noexcept -> uint64_t
+{
+  uint64_t const stop = region + 1 < m_access_points.size()
+                            ? m_access_points[region + 1].uncompressed_offset
+                            : m_uncompressed_size;
+  return stop - m_access_points[region].uncompressed_offset;
+}
+
+inline auto gzip_index::get_span() const noexcept -> uint64_t
+{
+  return m_span;
+}
+
+inline auto gzip_index::get_fingerprint() const noexcept -> uint64_t
+{
+  return m_fingerprint;
+}
+
+inline auto build_gzip_index(std::filesystem::path const& path, uint64_t span) -> gzip_index
+{
+  if (span == 0) {
+    throw std::invalid_argument{"the span must be positive"};
+  }
+
+  detail::input_file const file = detail::open_input_file(path);
+  detail::inflate_stream const stream = detail::create_inflate_stream(15 + 16);
+  std::vector<std::byte> input(detail::gzip_input_buffer_size);
+  std::vector<std::byte> output(1 << 16);
+
+  std::vector<gzip_access_point> points;
+  uint64_t total_in = 0;
+  uint64_t total_out = 0;
+
+  while (true) {
+    if (!detail::refill_inflate_input(file.get(), *stream, input)) {
+      throw std::runtime_error{"gzip file is truncated"};
+    }
+
+    uInt const avail_in = stream->avail_in;
+    stream->next_out = reinterpret_cast<Bytef*>(output.data());
+    stream->avail_out = static_cast<uInt>(output.size());
+
+    // With Z_BLOCK, inflate() stops at deflate block boundaries
+    int const result = inflate(stream.get(), Z_BLOCK);
+    detail::throw_on_inflate_error(result);
+    total_in += avail_in - stream->avail_in;
+    total_out += output.size() - stream->avail_out;
+
+    if (result == Z_STREAM_END) {
+      // Continuing with the next gzip member, if any
+      bool const has_input = detail::refill_inflate_input(file.get(), *stream, input);
+      if (!has_input || *stream->next_in != 0x1f) {
+        break;
+      }
+      inflateReset(stream.get());
+      continue;
+    }
+
+    bool const is_block_boundary = (stream->data_type & 128) != 0 && (stream->data_type & 64) == 0;
+    if (is_block_boundary &&
+        (points.empty() || total_out - points.back().uncompressed_offset >= span)) {
+      gzip_access_point& point = points.emplace_back();
+      point.uncompressed_offset = total_out;
+      point.compressed_offset = total_in;
+      point.num_bits = static_cast<uint32_t>(stream->data_type & 7);
+
+      point.window.resize(detail::gzip_window_size);
+      uInt window_size = 0;
+      inflateGetDictionary(
+          stream.get(), reinterpret_cast<Bytef*>(point.window.data()), &window_size);
+      point.window.resize(window_size);
+    }
+  }
+
+  return gzip_index{std::move(points),
+                    std::filesystem::file_size(path),
+                    total_out,
+                    span,
+                    detail::compute_gzip_fingerprint(path)};
+}
+
+inline void write_gzip_index(gzip_index const& index, sink& sink)
+{
+  detail::gzip_index_file_header header;
+  std::memcpy(header.magic, detail::gzip_index_file_magic, sizeof(header.magic));
+  header.byte_order_mark = detail::gzip_index_file_byte_order_mark;
+  header.reserved = 0;
+  header.compressed_size = index.get_compressed_size();
+  header.uncompressed_size = index.get_uncompressed_size();
+  header.span = index.get_span();
+  header.fingerprint = index.get_fingerprint();
+  header.num_access_points = index.get_access_points().size();
+
+  auto const* header_start = reinterpret_cast<std::byte const*>(&header);
+  sink.write_bytes(header_start, header_start + sizeof(header));
+
+  for (gzip_access_point const& point : index.get_access_points()) {
+    detail::gzip_index_file_access_point point_header;
+    point_header.uncompressed_offset = point.uncompressed_offset;
+    point_header.compressed_offset = point.compressed_offset;
+    point_header.num_bits = point.num_bits;
+    point_header.window_size = static_cast<uint32_t>(point.window.size());
+
+    auto const* point_header_start = reinterpret_cast<std::byte const*>(&point_header);
+    sink.write_bytes(point_header_start, point_header_start + sizeof(point_header));
+    sink.write_bytes(point.window.data(), point.window.data() + point.window.size());
+  }
+}
+
+inline auto read_gzip_index(source& source) -> gzip_index
+{
+  auto read_exactly = [&source](void* start, size_t size) {
+    std::byte* const buf_start = static_cast<std::byte*>(start);
+    if (source.read_bytes(buf_start, buf_start + size) != buf_start + size) {
+      throw std::invalid_argument{"unexpected end of gzip index file"};
+    }
+  };
+
+  detail::gzip_index_file_header header;
+  read_exactly(&header, sizeof(header));
+
+  if (std::memcmp(header.magic, detail::gzip_index_file_magic, sizeof(header.magic)) != 0) {
+    throw std::invalid_argument{"not a gzip index file"};
+  }
+  if (header.byte_order_mark != detail::gzip_index_file_byte_order_mark) {
+    throw std::invalid_argument{"gzip index file has been written with a different byte order"};
+  }
+
+  // Not reserving memory according to the header, since the header might be bogus
+  std::vector<gzip_access_point> points;
+  for (uint64_t idx = 0; idx < header.num_access_points; ++idx) {
+    detail::gzip_index_file_access_point point_header;
+    read_exactly(&point_header, sizeof(point_header));
+    if (point_header.window_size > detail::gzip_window_size) {
+      throw std::invalid_argument{"invalid gzip index file"};
+    }
+
+    gzip_access_point& point = points.emplace_back();
+    point.uncompressed_offset = point_header.uncompressed_offset;
+    point.compressed_offset = point_header.compressed_offset;
+    point.num_bits = point_header.num_bits;
+    point.window.resize(point_header.window_size);
+    read_exactly(point.window.data(), point.window.size());
+  }
+
+  if (source.read_byte().has_value()) {
+    throw std::invalid_argument{"unexpected data at the end of gzip index file"};
+  }
+
+  return gzip_index{std::move(points),
+                    header.compressed_size,
+                    header.uncompressed_size,
+                    header.span,
+                    header.fingerprint};
+}
+
+inline auto load_or_build_gzip_index(std::filesystem::path const& path,
+                                     std::filesystem::path const& index_path,
+                                     uint64_t span) -> gzip_index
+{
+  if (span == 0) {
+    throw std::invalid_argument{"the span must be positive"};
+  }
+
+  std::ifstream index_file{index_path, std::ios::binary};
+  if (index_file) {
+    try {
+      istream_source index_source{index_file};
+      gzip_index result = read_gzip_index(index_source);
+      detail::check_gzip_index(path, result);
+      if (result.get_span() == span) {
+        return result;
+      }
+    }
+    catch (std::invalid_argument const&) {
+      // Rebuilding invalid and outdated indices
+    }
+  }
+
+  gzip_index result = build_gzip_index(path, span);
+
+  try {
+    std::ofstream output{index_path, std::ios::binary};
+    if (output) {
+      ostream_sink sink{output};
+      write_gzip_index(result, sink);
+      sink.flush();
+    }
+  }
+  catch (std::runtime_error const&) {
+    // The index is just not cached then
+  }
+
+  return result;
+}
+
+inline void decompress_gzip_parallel(std::filesystem::path const& path,
+                                     gzip_index const& index,
+                                     std::byte* out,
+                                     size_t num_threads)
+{
+  if (num_threads == 0) {
+    throw std::invalid_argument{"the number of threads must be positive"};
+  }
+  detail::check_gzip_index(path, index);
+
+  std::vector<gzip_access_point> const& points = index.get_access_points();
+  std::atomic<size_t> next_region = 0;
+  std::atomic<bool> has_failed = false;
+
+  auto decompress = [&]() {
+    detail::input_file const file = detail::open_input_file(path);
+    std::vector<std::byte> input(detail::gzip_input_buffer_size);
+
+    for (size_t region = next_region++; region < points.size() && !has_failed;
+         region = next_region++) {
+      gzip_access_point const& point = points[region];
+      detail::inflate_gzip_region(
+          file.get(), point, out + point.uncompressed_offset, index.get_region_size(region), input);
+    }
+  };
+
+  size_t const num_workers = std::min(num_threads, std::max<size_t>(points.size(), 1)) - 1;
+  std::vector<std::exception_ptr> errors(num_workers + 1);
+  std::vector<std::thread> threads;
+  threads.reserve(num_workers);
+
+  auto run_worker = [&decompress, &errors, &has_failed](size_t worker) {
+    try {
+      decompress();
+    }
+    catch (...) {
+      errors[worker] = std::current_exception();
+      has_failed = true;
+    }
+  };
+
+  try {
+    for (size_t worker = 1; worker <= num_workers; ++worker) {
+      threads.emplace_back(run_worker, worker);
+    }
+  }
+  catch (...) {
+    has_failed = true;
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    throw;
+  }
+
+  run_worker(0);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (std::exception_ptr const& error : errors) {
+    if (error != nullptr) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+inline parallel_gzip_source::parallel_gzip_source(std::filesystem::path const& path,
+                                                  gzip_index index,
+                                                  size_t num_threads)
+  : m_path{path}, m_index{std::move(index)}
+{
+  if (num_threads == 0) {
+    throw std::invalid_argument{"the number of threads must be positive"};
+  }
+  detail::check_gzip_index(m_path, m_index);
+
+  m_slots.resize(2 * num_threads);
+
+  try {
+    for (size_t idx = 0; idx < num_threads; ++idx) {
+      m_threads.emplace_back([this]() { decompress_regions(); });
+    }
+  }
+  catch (...) {
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      m_is_stop_requested = true;
+    }
+    m_released_cv.notify_all();
+    for (std::thread& thread : m_threads) {
+      thread.join();
+    }
+    throw;
+  }
+}
+
+inline parallel_gzip_source::~parallel_gzip_source()
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_is_stop_requested = true;
+  }
+  m_released_cv.notify_all();
+  for (std::thread& thread : m_threads) {
+    thread.join();
+  }
+}
+
+inline void parallel_gzip_source::decompress_regions()
+{
+  detail::input_file file;
+  std::vector<std::byte> input;
+  std::exception_ptr open_error;
+  try {
+    file = detail::open_input_file(m_path);
+    input.resize(detail::gzip_input_buffer_size);
+  }
+  catch (...) {
+    open_error = std::current_exception();
+  }
+
+  while (true) {
+    size_t region = 0;
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_released_cv.wait(lock, [this]() {
+        return m_is_stop_requested || m_num_claimed == m_index.get_num_regions() ||
+               m_num_claimed - m_num_released < m_slots.size();
+      });
+      if (m_is_stop_requested || m_num_claimed == m_index.get_num_regions()) {
+        break;
+      }
+      region = m_num_claimed++;
+    }
+
+    // The slot is not accessed by the consumer until it is ready
+    slot& target = m_slots[region % m_slots.size()];
+    std::exception_ptr error = open_error;
+    if (error == nullptr) {
+      try {
+        target.data.resize(m_index.get_region_size(region));
+        detail::inflate_gzip_region(file.get(),
+                                    m_index.get_access_points()[region],
+                                    target.data.data(),
+                                    target.data.size(),
+                                    input);
+      }
+      catch (...) {
+        error = std::current_exception();
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      target.error = error;
+      target.is_ready = true;
+    }
+    m_ready_cv.notify_one();
+  }
+}
+
+inline auto parallel_gzip_source::acquire_data() -> bool
+{
+  if (m_cursor != m_stop) {
+    return true;
+  }
+
+  std::unique_lock<std::mutex> lock{m_mutex};
+
+  // Skipping empty regions
+  while (true) {
+    if (m_has_current_slot) {
+      m_has_current_slot = false;
+      m_slots[m_num_released % m_slots.size()].is_ready = false;
+      ++m_num_released;
+      m_released_cv.notify_all();
+    }
+
+    if (m_num_released == m_index.get_num_regions()) {
+      return false;
+    }
+
+    slot& current = m_slots[m_num_released % m_slots.size()];
+
+    // Regions are claimed in order, so the wait ends even if the region is not claimed yet
+    m_ready_cv.wait(lock, [&current]() { return current.is_ready; });
+
+    if (current.error != nullptr) {
+      // The error is reported again on subsequent reads
+      std::rethrow_exception(current.error);
+    }
+
+    m_has_current_slot = true;
+    m_cursor = current.data.data();
+    m_stop = m_cursor + current.data.size();
+    if (m_cursor != m_stop) {
+      return true;
+    }
+  }
+}
+
+inline auto parallel_gzip_source::read_bytes(std::byte* buf_start, std::byte* buf_stop)
+    -> std::byte*
+{
+  std::byte* cursor = buf_start;
+  while (cursor != buf_stop && acquire_data()) {
+    size_t const to_copy =
+        std::min(static_cast<size_t>(buf_stop - cursor), static_cast<size_t>(m_stop - m_cursor));
+    std::memcpy(cursor, m_cursor, to_copy);
+    cursor += to_copy;
+    m_cursor += to_copy;
+  }
+  return cursor;
+}
+
+inline auto parallel_gzip_source::read_byte() -> std::optional<std::byte>
+{
+  if (!acquire_data()) {
+    return std::nullopt;
+  }
+  return *(m_cursor++);
+}
+
+inline auto parallel_gzip_source::is_eof() -> bool
+{
+  return !acquire_data();
+}
+
+inline auto parallel_gzip_source::borrow_bytes() -> std::optional<byte_range>
+{
+  if (!acquire_data()) {
+    return byte_range{};
+  }
+
+  byte_range const result{m_cursor, m_stop};
+  m_cursor = m_stop;
+  return result;
+}
+}
@@ -0,0 +1,354 @@
+#pragma once
+
+/**
+ * \file
+ */
+
+#include <cnfkit/detail/check_cxx_version.h>
+
+#if !__has_include(<zstd.h>)
+#error "zstd.h not found. The headers of zstd must be added to the include search path."
+#endif
+
+#include <cnfkit/detail/input_file.h>
+#include <cnfkit/io.h>
+
+#include <zstd.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cnfkit {
+
+/**
+ * \brief Reader for zstd-compressed files.
+ *
+ * This class uses the zstd library directly, reading the compressed data in
+ * large blocks and decompressing it into the buffers passed to `read_bytes()`.
+ * Files consisting of multiple concatenated zstd frames are supported.
+ *
+ * \ingroup io
+ */
+class zstd_source final : public source {
+public:
+  constexpr static size_t input_buffer_size = (1 << 20);
+
+  /**
+   * \brief Constructs a zstd_source object backed by the given file.
+   *
+   * \throws std::runtime_error   Thrown when opening the file or initializing zstd failed.
+   */
+  explicit zstd_source(std::filesystem::path const& path);
+
+  /**
+   * \brief Constructs a zstd_source object reading from stdin.
+   *
+   * \throws std::runtime_error   Thrown when initializing zstd failed.
+   */
+  zstd_source();
+
+  /**
+   * \throws std::runtime_error   Thrown on I/O failure or if the data is corrupt or truncated.
+   */
+  auto read_bytes(std::byte* buf_start, std::byte* buf_stop) -> std::byte* override;
+
+  /**
+   * \throws std::runtime_error   Thrown on I/O failure or if the data is corrupt or truncated.
+   */
+  auto read_byte() -> std::optional<std::byte> override;
+
+  auto is_eof() -> bool override;
+
+  auto operator=(zstd_source const&) -> zstd_source& = delete;
+  zstd_source(zstd_source const&) = delete;
+
+  auto operator=(zstd_source&& rhs) noexcept -> zstd_source& = default;
+  zstd_source(zstd_source&& rhs) noexcept = default;
+
+private:
+  void refill_input();
+
+  struct context_deleter {
+    void operator()(ZSTD_DCtx* context) const noexcept { ZSTD_freeDCtx(context); }
+  };
+
+  detail::input_file m_file;
+  std::unique_ptr<ZSTD_DCtx, context_deleter> m_context;
+
+  std::vector<std::byte> m_buffer;
+  ZSTD_inBuffer m_input = {nullptr, 0, 0};
+
+  // True if the last decompression step filled the output, in which case
+  // zstd may hold decompressed data not yet returned to the caller
+  bool m_may_have_pending_output = false;
+  bool m_is_in_frame = false;
+  bool m_eof = false;
+};
+
+/**
+ * \brief Writer compressing data in the zstd format.
+ *
+ * This class uses the zstd library. The compressed data is written to
+ * another sink. The zstd frame is completed by `finish()`, or on destruction
+ * of the zstd_sink object.
+ *
+ * \ingroup io
+ */
+class zstd_sink final : public sink {
+public:
+  constexpr static int default_level = ZSTD_CLEVEL_DEFAULT;
+
+  /**
+   * \brief Constructs a zstd_sink object writing the compressed data to `sink`.
+   *
+   * \param level         The zstd compression level. Levels exceeding the range
+   *                      supported by zstd are clamped to that range.
+   *
+   * \param num_threads   The number of threads compressing the data in the
+   *                      background. With 0, the data is compressed by the thread
+   *                      writing it. Using multiple threads requires zstd to be
+   *                      built with multithreading support.
+   *
+   * \throws std::runtime_error   Thrown when zstd could not be initialized, or if
+   *                              `num_threads` is not supported.
+   */
+  explicit zstd_sink(sink& sink, int level = default_level, int num_threads = 0);
+
+  /**
+   * \throws std::runtime_error   Thrown on I/O failure or when called after `finish()`.
+   */
+  void write_bytes(std::byte const* start, std::byte const* stop) override;
+
+  /**
+   * \brief Writes all data passed so far to the wrapped sink, then flushes the wrapped sink.
+   *
+   * Flushing frequently degrades compression.
+   *
+   * \throws std::runtime_error   Thrown on I/O failure.
+   */
+  void flush() override;
+
+  /**
+   * \brief Completes the zstd frame and flushes the wrapped sink.
+   *
+   * After calling this function, no further data may be written.
+   *
+   * \throws std::runtime_error   Thrown on I/O failure.
+   */
+  void finish();
+
+  /**
+   * \brief Calls `finish()` unless it has already been called, ignoring errors.
+   */
+  virtual ~zstd_sink();
+
+  auto operator=(zstd_sink const&) -> zstd_sink& = delete;
+  zstd_sink(zstd_sink const&) = delete;
+
+  /**
+   * \brief Completes the stream of this object like the destructor, then takes
+   *        over the stream of `rhs`.
+   */
+  auto operator=(zstd_sink&& rhs) noexcept -> zstd_sink&;
+  zstd_sink(zstd_sink&& rhs) noexcept = default;
+
+private:
+  void compress_input(ZSTD_inBuffer& input, ZSTD_EndDirective mode);
+  void finish_ignoring_errors() noexcept;
+
+  struct context_deleter {
+    void operator()(ZSTD_CCtx* context) const noexcept { ZSTD_freeCCtx(context); }
+  };
+
+  sink* m_sink = nullptr;
+  std::unique_ptr<ZSTD_CCtx, context_deleter> m_context;
+  std::vector<std::byte> m_buffer;
+  bool m_is_finished = false;
+};
+
+// *** Implementation ***
+
+namespace detail {
+inline void throw_on_zstd_error(size_t result, char const* message)
+{
+  if (ZSTD_isError(result)) {
+    throw std::runtime_error{std::string{message} + ": " + ZSTD_getErrorName(result)};
+  }
+}
+}
+
+inline zstd_source::zstd_source(std::filesystem::path const& path)
+  : m_file{detail::open_input_file(path)}, m_context{ZSTD_createDCtx()}
+{
+  if (m_context == nullptr) {
+    throw std::runtime_error{"initializing zstd failed"};
+  }
+  m_buffer.resize(input_buffer_size);
+}
+
+inline zstd_source::zstd_source() : m_file{detail::open_stdin()}, m_context{ZSTD_createDCtx()}
+{
+  if (m_context == nullptr) {
+    throw std::runtime_error{"initializing zstd failed"};
+  }
+  m_buffer.resize(input_buffer_size);
+}
+
+inline auto zstd_source::read_bytes(std::byte* buf_start, std::byte* buf_stop) -> std::byte*
+{
+  ZSTD_outBuffer output{buf_start, static_cast<size_t>(buf_stop - buf_start), 0};
+
+  while (output.pos != output.size && !m_eof) {
+    if (m_input.pos == m_input.size && !m_may_have_pending_output) {
+      refill_input();
+      if (m_eof) {
+        break;
+      }
+    }
+
+    size_t const input_pos = m_input.pos;
+    size_t const output_pos = output.pos;
+    size_t const result = ZSTD_decompressStream(m_context.get(), &output, &m_input);
+    detail::throw_on_zstd_error(result, "zstd decompression failed");
+
+    // ZSTD_decompressStream() returns 0 exactly when a frame has been completed.
+    // Without progress, the result is a hint for the next frame, though.
+    if (m_input.pos != input_pos || output.pos != output_pos) {
+      m_is_in_frame = result != 0;
+    }
+    m_may_have_pending_output = output.pos == output.size;
+  }
+
+  return buf_start + output.pos;
+}
+
+inline void zstd_source::refill_input()
+{
+  std::byte* const stop =
+      detail::read_input_file(m_file.get(), m_buffer.data(), m_buffer.data() + m_buffer.size());
+  m_input = {m_buffer.data(), static_cast<size_t>(stop - m_buffer.data()), 0};
+
+  if (m_input.size == 0) {
+    if (m_is_in_frame) {
+      throw std::runtime_error{"zstd decompression failed: input is truncated"};
+    }
+    m_eof = true;
+  }
+}
+
+inline auto zstd_source::read_byte() -> std::optional<std::byte>
+{
+  std::byte buf;
+  if (read_bytes(&buf, &buf + 1) == &buf) {
+    return std::nullopt;
+  }
+  return buf;
+}
+
+inline auto zstd_source::is_eof() -> bool
+{
+  return m_eof;
+}
+
+inline zstd_sink::zstd_sink(sink& sink, int level, int num_threads)
+  : m_sink{&sink}, m_context{ZSTD_createCCtx()}, m_buffer(ZSTD_CStreamOutSize())
+{
+  if (m_context == nullptr) {
+    throw std::runtime_error{"initializing zstd failed"};
+  }
+
+  detail::throw_on_zstd_error(
+      ZSTD_CCtx_setParameter(m_context.get(), ZSTD_c_compressionLevel, level),
+      "setting the zstd compression level failed");
+  detail::throw_on_zstd_error(ZSTD_CCtx_setParameter(m_context.get(), ZSTD_c_checksumFlag, 1),
+                              "enabling zstd checksums failed");
+
+  if (num_threads != 0) {
+    detail::throw_on_zstd_error(
+        ZSTD_CCtx_setParameter(m_context.get(), ZSTD_c_nbWorkers, num_threads),
+        "setting the number of zstd threads failed");
+  }
+}
+
+inline zstd_sink::~zstd_sink()
+{
+  finish_ignoring_errors();
+}
+
+inline auto zstd_sink::operator=(zstd_sink&& rhs) noexcept -> zstd_sink&
+{
+  if (this != &rhs) {
+    finish_ignoring_errors();
+    m_sink = rhs.m_sink;
+    m_context = std::move(rhs.m_context);
+    m_buffer = std::move(rhs.m_buffer);
+    m_is_finished = rhs.m_is_finished;
+  }
+  return *this;
+}
+
+inline void zstd_sink::finish_ignoring_errors() noexcept
+{
+  if (m_context != nullptr && !m_is_finished) {
+    try {
+      finish();
+    }
+    catch (...) {
+      // Errors can only be reported by finish()
+    }
+  }
+}
+
+inline void zstd_sink::write_bytes(std::byte const* start, std::byte const* stop)
+{
+  if (m_is_finished) {
+    throw std::runtime_error{"writing to finished zstd_sink"};
+  }
+
+  ZSTD_inBuffer input{start, static_cast<size_t>(stop - start), 0};
+  compress_input(input, ZSTD_e_continue);
+}
+
+inline void zstd_sink::flush()
+{
+  if (!m_is_finished) {
+    ZSTD_inBuffer input{nullptr, 0, 0};
+    compress_input(input, ZSTD_e_flush);
+  }
+  m_sink->flush();
+}
+
+inline void zstd_sink::finish()
+{
+  if (!m_is_finished) {
+    m_is_finished = true;
+    ZSTD_inBuffer input{nullptr, 0, 0};
+    compress_input(input, ZSTD_e_end);
+  }
+  m_sink->flush();
+}
+
+inline void zstd_sink::compress_input(ZSTD_inBuffer& input, ZSTD_EndDirective mode)
+{
+  // With ZSTD_e_continue, compression is done when all input has been consumed.
+  // Otherwise, it is done when zstd reports that no data remains to be flushed.
+  bool is_done = false;
+  while (!is_done) {
+    ZSTD_outBuffer output{m_buffer.data(), m_buffer.size(), 0};
+    size_t const remaining = ZSTD_compressStream2(m_context.get(), &output, &input, mode);
+    detail::throw_on_zstd_error(remaining, "zstd compression failed");
+
+    if (output.pos != 0) {
+      m_sink->write_bytes(m_buffer.data(), m_buffer.data() + output.pos);
+    }
+
+    is_done = mode == ZSTD_e_continue ? input.pos == input.size : remaining == 0;
+  }
+}
+}
@@ -0,0 +1,198 @@
+#include <cnfkit/clause_arena.h>
+
+#include <cnfkit/clause.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+using ::testing::Each;
+using ::testing::ElementsAre;
+using ::testing::Eq;
+
+namespace cnfkit {
+
+using namespace cnfkit_literals;
+
+namespace {
+class arena_test_clause final : public clause<arena_test_clause, uint32_t> {
+public:
+  explicit arena_test_clause(size_type size) : clause<arena_test_clause, uint32_t>(size) {}
+};
+
+auto to_vector(arena_test_clause const& clause) -> std::vector<lit>
+{
+  return std::vector<lit>(clause.begin(), clause.end());
+}
+}
+
+TEST(ClauseArenaTests, ClausesAreStoredContiguously)
+{
+  clause_arena<arena_test_clause> arena;
+  std::vector<lit> const clause1 = {1_dlit, -2_dlit};
+  std::vector<lit> const clause2 = {3_dlit};
+
+  clause_ref const ref1 = arena.add_clause(clause1.data(), clause1.data() + clause1.size());
+  clause_ref const ref2 = arena.add_clause(clause2.data(), clause2.data() + clause2.size());
+
+  EXPECT_THAT(ref1.get_raw_value(), Eq(0));
+  EXPECT_THAT(ref2.get_raw_value(), Eq(3));
+  EXPECT_THAT(arena.get_mem_size(), Eq(5 * sizeof(uint32_t)));
+
+  EXPECT_THAT(to_vector(arena.resolve(ref1)), Eq(clause1));
+  EXPECT_THAT(to_vector(arena.resolve(ref2)), Eq(clause2));
+}
+
+TEST(ClauseArenaTests, ReferencesRemainValidWhenArenaGrows)
+{
+  clause_arena<arena_test_clause> arena;
+  std::vector<clause_ref> refs;
+
+  for (uint32_t idx = 0; idx < 10000; ++idx) {
+    std::vector<lit> const clause(idx % 7, lit{var{idx}, true});
+    refs.push_back(arena.add_clause(clause.data(), clause.data() + clause.size()));
+  }
+
+  for (uint32_t idx = 0; idx < 10000; ++idx) {
+    std::vector<lit> const expected(idx % 7, lit{var{idx}, true});
+    EXPECT_THAT(to_vector(arena.resolve(refs[idx])), Eq(expected));
+  }
+}
+
+TEST(ClauseArenaTests, AllocatedClausesAreZeroInitialized)
+{
+  clause_arena<arena_test_clause> arena;
+  clause_ref const ref = arena.allocate(3);
+
+  EXPECT_THAT(arena.resolve(ref).size(), Eq(3));
+  EXPECT_THAT(to_vector(arena.resolve(ref)), Each(Eq(lit{var{0}, false})));
+}
+
+TEST(ClauseArenaTests, ClearedArenaIsEmpty)
+{
+  clause_arena<arena_test_clause> arena;
+  arena.reserve(10, 30);
+  arena.allocate(3);
+  arena.clear();
+
+  EXPECT_THAT(arena.get_mem_size(), Eq(0));
+  EXPECT_THAT(arena.allocate(1).get_raw_value(), Eq(0));
+}
+
+namespace {
+auto add_test_clauses(clause_arena<arena_test_clause>& arena, uint32_t num_clauses)
+    -> std::vector<clause_ref>
+{
+  std::vector<clause_ref> result;
+  for (uint32_t idx = 0; idx < num_clauses; ++idx) {
+    std::vector<lit> const clause((idx * 5) % 7, lit{var{idx}, true});
+    result.push_back(arena.add_clause(clause.data(), clause.data() + clause.size()));
+  }
+  return result;
+}
+
+auto get_test_clause(uint32_t idx) -> std::vector<lit>
+{
+  return std::vector<lit>((idx * 5) % 7, lit{var{idx}, true});
+}
+}
+
+TEST(ClauseArenaCompactionTests, DeletedClausesAreRemoved)
+{
+  clause_arena<arena_test_clause> arena;
+  std::vector<clause_ref> const old_refs = add_test_clauses(arena, 100);
+  size_t const old_mem_size = arena.get_mem_size();
+
+  size_t deleted_mem_size = 0;
+  for (uint32_t idx = 0; idx < 100; idx += 3) {
+    arena.mark_deleted(old_refs[idx]);
+    deleted_mem_size += arena_test_clause::get_mem_size(get_test_clause(idx).size());
+  }
+  EXPECT_TRUE(arena.is_deleted(old_refs[3]));
+  EXPECT_FALSE(arena.is_deleted(old_refs[4]));
+  EXPECT_THAT(arena.get_deleted_mem_size(), Eq(deleted_mem_size));
+
+  std::vector<clause_ref> refs = old_refs;
+  clause_forwarding_table const forwarding = arena.compact(refs);
+
+  EXPECT_THAT(arena.get_mem_size(), Eq(old_mem_size - deleted_mem_size));
+  EXPECT_THAT(arena.get_deleted_mem_size(), Eq(0));
+  EXPECT_THAT(forwarding.size(), Eq(66));
+  ASSERT_THAT(refs.size(), Eq(66));
+
+  size_t ref_idx = 0;
+  for (uint32_t idx = 0; idx < 100; ++idx) {
+    std::optional<clause_ref> const new_ref = forwarding.forward(old_refs[idx]);
+    if (idx % 3 == 0) {
+      EXPECT_FALSE(new_ref.has_value());
+    }
+    else {
+      ASSERT_TRUE(new_ref.has_value());
+      EXPECT_THAT(*new_ref, Eq(refs[ref_idx++]));
+      EXPECT_THAT(to_vector(arena.resolve(*new_ref)), Eq(get_test_clause(idx)));
+      EXPECT_FALSE(arena.is_deleted(*new_ref));
+    }
+  }
+}
+
+TEST(ClauseArenaCompactionTests, UnreferencedClausesAreRemoved)
+{
+  clause_arena<arena_test_clause> arena;
+  std::vector<clause_ref> const old_refs = add_test_clauses(arena, 10);
+
+  // The order of the references is not relevant
+  std::vector<clause_ref> refs = {old_refs[7], old_refs[2]};
+  clause_forwarding_table const forwarding = arena.compact(refs);
+
+  ASSERT_THAT(refs.size(), Eq(2));
+  EXPECT_THAT(refs[0].get_raw_value(), Eq(0));
+  EXPECT_THAT(to_vector(arena.resolve(refs[0])), Eq(get_test_clause(2)));
+  EXPECT_THAT(to_vector(arena.resolve(refs[1])), Eq(get_test_clause(7)));
+  EXPECT_THAT(forwarding.forward(old_refs[7]), Eq(refs[1]));
+  EXPECT_FALSE(forwarding.forward(old_refs[3]).has_value());
+}
+
+TEST(ClauseArenaCompactionTests, MemoryOfShrunkClausesIsReclaimed)
+{
+  clause_arena<arena_test_clause> arena;
+  std::vector<lit> const clause = {1_dlit, 2_dlit, 3_dlit};
+  std::vector<clause_ref> refs;
+  refs.push_back(arena.add_clause(clause.data(), clause.data() + clause.size()));
+  refs.push_back(arena.add_clause(clause.data(), clause.data() + clause.size()));
+
+  arena.resolve(refs[0]).shrink(1);
+  arena.compact(refs);
+
+  EXPECT_THAT(arena.get_mem_size(), Eq(arena_test_clause::get_mem_size(1) +
+                                       arena_test_clause::get_mem_size(3)));
+  EXPECT_THAT(to_vector(arena.resolve(refs[0])), ElementsAre(1_dlit));
+  EXPECT_THAT(to_vector(arena.resolve(refs[1])), Eq(clause));
+}
+
+TEST(ClauseArenaCompactionTests, ClausesAreReorderedByKey)
+{
+  clause_arena<arena_test_clause> arena;
+  std::vector<clause_ref> const old_refs = add_test_clauses(arena, 100);
+  arena.mark_deleted(old_refs[1]);
+
+  std::vector<clause_ref> refs = old_refs;
+  clause_forwarding_table const forwarding = arena.compact(refs, clause_size_key{});
+
+  ASSERT_THAT(refs.size(), Eq(99));
+  for (size_t idx = 1; idx < refs.size(); ++idx) {
+    EXPECT_LT(refs[idx - 1], refs[idx]);
+    EXPECT_LE(arena.resolve(refs[idx - 1]).size(), arena.resolve(refs[idx]).size());
+  }
+
+  for (uint32_t idx = 0; idx < 100; ++idx) {
+    std::optional<clause_ref> const new_ref = forwarding.forward(old_refs[idx]);
+    ASSERT_THAT(new_ref.has_value(), Eq(idx != 1));
+    if (new_ref.has_value()) {
+      EXPECT_THAT(to_vector(arena.resolve(*new_ref)), Eq(get_test_clause(idx)));
+    }
+  }
+}
+}
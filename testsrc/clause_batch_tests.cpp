@@ -0,0 +1,109 @@
+#include <cnfkit/clause_batch.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+
+namespace cnfkit {
+
+using namespace cnfkit_literals;
+
+TEST(ClauseBatchTests, EmptyBatch)
+{
+  clause_batch const batch;
+  EXPECT_THAT(batch.size(), Eq(0));
+  EXPECT_TRUE(batch.empty());
+  EXPECT_THAT(batch.get_num_lits(), Eq(0));
+  EXPECT_THAT(batch.get_offsets()[0], Eq(0));
+}
+
+TEST(ClauseBatchTests, ClausesAreStoredInCSRLayout)
+{
+  std::vector<lit> const clause1 = {1_dlit, -2_dlit};
+  std::vector<lit> const clause2 = {};
+  std::vector<lit> const clause3 = {3_dlit, 4_dlit, -5_dlit};
+
+  clause_batch batch;
+  batch.add_clause(clause1.data(), clause1.data() + clause1.size());
+  batch.add_clause(clause2.data(), clause2.data() + clause2.size(), false);
+  batch.add_clause(clause3.data(), clause3.data() + clause3.size());
+
+  ASSERT_THAT(batch.size(), Eq(3));
+  EXPECT_FALSE(batch.empty());
+  EXPECT_THAT(batch.get_num_lits(), Eq(5));
+
+  std::vector<size_t> const offsets(batch.get_offsets(), batch.get_offsets() + batch.size() + 1);
+  EXPECT_THAT(offsets, ElementsAre(0, 2, 2, 5));
+
+  std::vector<lit> const lits(batch.get_lits(), batch.get_lits() + batch.get_num_lits());
+  EXPECT_THAT(lits, ElementsAre(1_dlit, -2_dlit, 3_dlit, 4_dlit, -5_dlit));
+
+  EXPECT_THAT(std::vector<lit>(batch.clause_start(2), batch.clause_stop(2)), Eq(clause3));
+  EXPECT_TRUE(batch.clause_start(1) == batch.clause_stop(1));
+
+  EXPECT_TRUE(batch.is_added(0));
+  EXPECT_FALSE(batch.is_added(1));
+  EXPECT_TRUE(batch.is_added(2));
+}
+
+TEST(ClauseBatchTests, ClearedBatchIsEmpty)
+{
+  std::vector<lit> const clause = {1_dlit, -2_dlit};
+
+  clause_batch batch;
+  batch.add_clause(clause.data(), clause.data() + clause.size());
+  batch.clear();
+
+  EXPECT_TRUE(batch.empty());
+  EXPECT_THAT(batch.get_num_lits(), Eq(0));
+
+  batch.add_clause(clause.data(), clause.data() + 1);
+  ASSERT_THAT(batch.size(), Eq(1));
+  EXPECT_THAT(std::vector<lit>(batch.clause_start(0), batch.clause_stop(0)), ElementsAre(1_dlit));
+}
+
+TEST(ClauseBatchTests, ClausesCanBeBuiltLiteralByLiteral)
+{
+  clause_batch batch;
+  batch.add_lit(1_dlit);
+  batch.add_lit(-2_dlit);
+  EXPECT_TRUE(batch.has_unfinished_clause());
+  EXPECT_TRUE(batch.empty());
+  EXPECT_THAT(batch.get_num_lits(), Eq(0));
+
+  batch.finish_clause(false);
+  batch.finish_clause();
+  EXPECT_FALSE(batch.has_unfinished_clause());
+
+  ASSERT_THAT(batch.size(), Eq(2));
+  EXPECT_THAT(batch.get_num_lits(), Eq(2));
+  EXPECT_THAT(std::vector<lit>(batch.clause_start(0), batch.clause_stop(0)),
+              ElementsAre(1_dlit, -2_dlit));
+  EXPECT_TRUE(batch.clause_start(1) == batch.clause_stop(1));
+  EXPECT_FALSE(batch.is_added(0));
+  EXPECT_TRUE(batch.is_added(1));
+}
+
+TEST(ClauseBatchTests, ClearingBatchKeepsUnfinishedClause)
+{
+  std::vector<lit> const clause = {1_dlit, -2_dlit};
+
+  clause_batch batch;
+  batch.add_clause(clause.data(), clause.data() + clause.size());
+  batch.add_lit(3_dlit);
+  batch.clear();
+
+  EXPECT_TRUE(batch.empty());
+  EXPECT_TRUE(batch.has_unfinished_clause());
+
+  batch.add_lit(4_dlit);
+  batch.finish_clause();
+  ASSERT_THAT(batch.size(), Eq(1));
+  EXPECT_THAT(std::vector<lit>(batch.clause_start(0), batch.clause_stop(0)),
+              ElementsAre(3_dlit, 4_dlit));
+}
+}
@@ -0,0 +1,63 @@
+#include <cnfkit/cnf_formula.h>
+
+#include <cnfkit/io/io_buf.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+
+namespace cnfkit {
+
+using namespace cnfkit_literals;
+
+namespace {
+auto to_vector(cnf_clause const& clause) -> std::vector<lit>
+{
+  return std::vector<lit>(clause.begin(), clause.end());
+}
+}
+
+TEST(CNFFormulaTests, ClausesAreAccessibleByIndexAndReference)
+{
+  std::vector<lit> const clause1 = {1_dlit, -2_dlit};
+  std::vector<lit> const clause2 = {};
+
+  cnf_formula formula;
+  EXPECT_TRUE(formula.empty());
+
+  clause_ref const ref1 = formula.add_clause(clause1.data(), clause1.data() + clause1.size());
+  clause_ref const ref2 = formula.add_clause(clause2.data(), clause2.data() + clause2.size());
+
+  ASSERT_THAT(formula.size(), Eq(2));
+  EXPECT_THAT(formula.get_clause_refs(), ElementsAre(ref1, ref2));
+  EXPECT_THAT(to_vector(formula[0]), Eq(clause1));
+  EXPECT_THAT(to_vector(formula[1]), Eq(clause2));
+  EXPECT_THAT(to_vector(formula.resolve(ref1)), Eq(clause1));
+}
+
+TEST(CNFFormulaTests, LoadCNF)
+{
+  std::string const input = "c comment\np cnf 4 3\n1 -2 0\n0\n3 4 -1 0\n";
+  buf_source source{input};
+
+  cnf_formula const formula = load_cnf(source);
+
+  ASSERT_THAT(formula.size(), Eq(3));
+  EXPECT_THAT(to_vector(formula[0]), ElementsAre(1_dlit, -2_dlit));
+  EXPECT_THAT(to_vector(formula[1]), ElementsAre());
+  EXPECT_THAT(to_vector(formula[2]), ElementsAre(3_dlit, 4_dlit, -1_dlit));
+}
+
+TEST(CNFFormulaTests, LoadInvalidCNF)
+{
+  std::string const input = "p cnf 4 1\n1 -2 x 0\n";
+  buf_source source{input};
+  EXPECT_THROW(load_cnf(source), std::invalid_argument);
+}
+}
@@ -0,0 +1,144 @@
+#include <cnfkit/csr_formula.h>
+
+#include <cnfkit/io/io_buf.h>
+#include <cnfkit/io/io_stdstream.h>
+
+#include "test_utils.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+
+namespace cnfkit {
+
+using namespace cnfkit_literals;
+
+namespace {
+using trivial_formula = std::vector<std::vector<lit>>;
+
+auto to_trivial_formula(csr_formula const& formula) -> trivial_formula
+{
+  trivial_formula result;
+  for (size_t idx = 0; idx < formula.size(); ++idx) {
+    result.emplace_back(formula.clause_start(idx), formula.clause_stop(idx));
+  }
+  return result;
+}
+
+auto to_binary_file_content(csr_formula const& formula) -> std::string
+{
+  std::ostringstream stream;
+  ostream_sink sink{stream};
+  write_csr_formula(formula, sink);
+  sink.flush();
+  return stream.str();
+}
+
+auto parse_test_formula() -> csr_formula
+{
+  std::string const input = "c comment\np cnf 5 3\n1 -2 0\n0\n3 4 -5 0\n";
+  buf_source source{input};
+  return parse_cnf_to_csr(source);
+}
+
+trivial_formula const test_formula = {{1_dlit, -2_dlit}, {}, {3_dlit, 4_dlit, -5_dlit}};
+}
+
+TEST(CSRFormulaTests, EmptyFormula)
+{
+  csr_formula const formula;
+  EXPECT_TRUE(formula.empty());
+  EXPECT_THAT(formula.get_num_lits(), Eq(0));
+  EXPECT_THAT(formula.get_offsets()[0], Eq(0));
+}
+
+TEST(CSRFormulaTests, ParseCNFToCSR)
+{
+  csr_formula const formula = parse_test_formula();
+
+  EXPECT_THAT(formula.size(), Eq(3));
+  EXPECT_THAT(formula.get_num_vars(), Eq(5));
+  EXPECT_THAT(formula.get_num_lits(), Eq(5));
+
+  std::vector<uint32_t> const offsets(formula.get_offsets(), formula.get_offsets() + 4);
+  EXPECT_THAT(offsets, ElementsAre(0, 2, 2, 5));
+  EXPECT_THAT(to_trivial_formula(formula), Eq(test_formula));
+}
+
+TEST(CSRFormulaTests, ParseInvalidCNFToCSR)
+{
+  std::string const input = "p cnf 5 3\n1 -2 0\n";
+  buf_source source{input};
+  EXPECT_THROW(parse_cnf_to_csr(source), std::invalid_argument);
+}
+
+TEST(CSRFormulaTests, ConstructorRejectsInvalidOffsets)
+{
+  std::vector<lit> const lits = {1_dlit, 2_dlit};
+  EXPECT_THROW(csr_formula(lits, {}, 2), std::invalid_argument);
+  EXPECT_THROW(csr_formula(lits, {1, 2}, 2), std::invalid_argument);
+  EXPECT_THROW(csr_formula(lits, {0, 2, 1, 2}, 2), std::invalid_argument);
+  EXPECT_THROW(csr_formula(lits, {0, 1}, 2), std::invalid_argument);
+  EXPECT_NO_THROW(csr_formula(lits, {0, 1, 2}, 2));
+}
+
+TEST(CSRFormulaTests, WriteAndReadBinaryFile)
+{
+  std::string const content = to_binary_file_content(parse_test_formula());
+  EXPECT_THAT(content.size(), Eq(40 + 4 * 4 + 5 * 4));
+
+  buf_source source{content};
+  csr_formula const formula = read_csr_formula(source);
+  EXPECT_THAT(formula.get_num_vars(), Eq(5));
+  EXPECT_THAT(to_trivial_formula(formula), Eq(test_formula));
+}
+
+TEST(CSRFormulaTests, WriteAndMapBinaryFile)
+{
+  temp_dir const dir{"cnfkit_csr_formula"};
+  std::filesystem::path const path = dir.get_path() / "formula.csr";
+  write_file(path, to_binary_file_content(parse_test_formula()));
+
+  csr_formula const formula = map_csr_formula(path);
+  EXPECT_THAT(formula.get_num_vars(), Eq(5));
+  EXPECT_THAT(to_trivial_formula(formula), Eq(test_formula));
+
+  // Copies share the mapping
+  csr_formula copy = formula;
+  EXPECT_THAT(copy.get_lits(), Eq(formula.get_lits()));
+}
+
+TEST(CSRFormulaTests, InvalidBinaryFilesAreRejected)
+{
+  std::string const valid_content = to_binary_file_content(parse_test_formula());
+
+  std::string bad_magic = valid_content;
+  bad_magic[0] = 'X';
+
+  std::string bad_offsets = valid_content;
+  bad_offsets[40 + 4] = 7;
+
+  std::vector<std::string> const invalid_contents = {
+      "", valid_content.substr(0, 20), valid_content.substr(0, 60), valid_content + "x",
+      bad_magic, bad_offsets};
+
+  temp_dir const dir{"cnfkit_csr_formula"};
+  std::filesystem::path const path = dir.get_path() / "formula.csr";
+
+  for (std::string const& content : invalid_contents) {
+    buf_source source{content};
+    EXPECT_THROW(read_csr_formula(source), std::invalid_argument);
+
+    write_file(path, content);
+    EXPECT_THROW(map_csr_formula(path), std::invalid_argument);
+  }
+}
+}
@@ -1,14 +1,19 @@
 #include <cnfkit/dimacs_parser.h>
 
 #include <cnfkit/io/io_buf.h>
+#include <cnfkit/io/io_mmap.h>
+#include <cnfkit/io/io_prefetching.h>
 
 #include "test_utils.h"
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <filesystem>
 #include <fstream>
+#include <optional>
+#include <random>
 #include <stdexcept>
 #include <string>
 #include <variant>
@@ -57,6 +62,217 @@ TEST_P(DimacsParsingTests, ParseFromBufSource)
   }
 }
 
+TEST_P(DimacsParsingTests, ParseWithSpanReceiver)
+{
+  std::string const& input = get_input();
+  buf_source source{input};
+
+  if (std::holds_alternative<parse_error>(get_expected())) {
+    EXPECT_THROW(parse_cnf(source, [](lit const* /*unused*/, lit const* /*unused*/) {}),
+                 std::exception);
+  }
+  else {
+    trivial_formula expected = std::get<trivial_formula>(get_expected());
+    trivial_formula result;
+    parse_cnf(source, [&result](lit const* start, lit const* stop) {
+      result.push_back(std::vector<lit>(start, stop));
+    });
+    EXPECT_THAT(result, Eq(expected));
+  }
+}
+
+TEST_P(DimacsParsingTests, ParseBatched)
+{
+  std::string const& input = get_input();
+
+  for (size_t max_batch_size : {1, 2, 4096}) {
+    buf_source source{input};
+
+    if (std::holds_alternative<parse_error>(get_expected())) {
+      EXPECT_THROW(
+          parse_cnf_batched(source, [](clause_batch const& /*unused*/) {}, max_batch_size),
+          std::exception);
+    }
+    else {
+      trivial_formula result;
+      parse_cnf_batched(
+          source,
+          [&result, max_batch_size](clause_batch const& batch) {
+            EXPECT_THAT(batch.empty(), Eq(false));
+            EXPECT_LE(batch.size(), max_batch_size);
+            for (size_t idx = 0; idx < batch.size(); ++idx) {
+              EXPECT_THAT(batch.is_added(idx), Eq(true));
+              result.push_back(std::vector<lit>(batch.clause_start(idx), batch.clause_stop(idx)));
+            }
+          },
+          max_batch_size);
+      EXPECT_THAT(result, Eq(std::get<trivial_formula>(get_expected())));
+    }
+  }
+}
+
+TEST_P(DimacsParsingTests, ParseWithPullReader)
+{
+  std::string const& input = get_input();
+  buf_source source{input};
+
+  auto read_all = [&source]() {
+    trivial_formula result;
+    cnf_reader reader{source};
+    while (std::optional<clause_view> clause = reader.next()) {
+      EXPECT_THAT(clause->is_added, Eq(true));
+      result.push_back(std::vector<lit>(clause->begin(), clause->end()));
+    }
+    EXPECT_THAT(reader.next(), Eq(std::nullopt));
+    return result;
+  };
+
+  if (std::holds_alternative<parse_error>(get_expected())) {
+    EXPECT_THROW(read_all(), std::invalid_argument);
+  }
+  else {
+    EXPECT_THAT(read_all(), Eq(std::get<trivial_formula>(get_expected())));
+  }
+}
+
+TEST_P(DimacsParsingTests, ParseWithBulkReadsOnly)
+{
+  std::string const& input = get_input();
+  bulk_only_test_source source{input};
+
+  if (std::holds_alternative<parse_error>(get_expected())) {
+    EXPECT_THROW(parse_cnf(source, [](std::vector<lit> const& /*unused*/) {}),
+                 std::invalid_argument);
+  }
+  else {
+    trivial_formula expected = std::get<trivial_formula>(get_expected());
+    trivial_formula result;
+    parse_cnf(source, [&result](std::vector<lit> const& clause) { result.push_back(clause); });
+    EXPECT_THAT(result, Eq(expected));
+  }
+}
+
+TEST_P(DimacsParsingTests, ParseFromMmapSource)
+{
+  temp_dir const dir{"cnfkit_dimacs"};
+  fs::path const input_file = dir.get_path() / "input.cnf";
+  write_file(input_file, get_input());
+  mmap_source source{input_file};
+
+  if (std::holds_alternative<parse_error>(get_expected())) {
+    EXPECT_THROW(parse_cnf(source, [](std::vector<lit> const& /*unused*/) {}), std::exception);
+  }
+  else {
+    trivial_formula expected = std::get<trivial_formula>(get_expected());
+    trivial_formula result;
+    parse_cnf(source, [&result](std::vector<lit> const& clause) { result.push_back(clause); });
+    EXPECT_THAT(result, Eq(expected));
+  }
+}
+
+TEST_P(DimacsParsingTests, ParseFromSourceLendingSmallBlocks)
+{
+  std::string const& input = get_input();
+
+  for (size_t block_size : {1, 2, 3, 7}) {
+    lending_test_source source{input, block_size};
+
+    if (std::holds_alternative<parse_error>(get_expected())) {
+      EXPECT_THROW(parse_cnf(source, [](std::vector<lit> const& /*unused*/) {}), std::exception);
+    }
+    else {
+      trivial_formula expected = std::get<trivial_formula>(get_expected());
+      trivial_formula result;
+      parse_cnf(source, [&result](std::vector<lit> const& clause) { result.push_back(clause); });
+      EXPECT_THAT(result, Eq(expected)) << "block size: " << block_size;
+    }
+  }
+}
+
+TEST_P(DimacsParsingTests, ParseFromPrefetchingSource)
+{
+  std::string const& input = get_input();
+  buf_source wrapped{input};
+  prefetching_source source{wrapped, 5, 3};
+
+  if (std::holds_alternative<parse_error>(get_expected())) {
+    EXPECT_THROW(parse_cnf(source, [](std::vector<lit> const& /*unused*/) {}), std::exception);
+  }
+  else {
+    trivial_formula expected = std::get<trivial_formula>(get_expected());
+    trivial_formula result;
+    parse_cnf(source, [&result](std::vector<lit> const& clause) { result.push_back(clause); });
+    EXPECT_THAT(result, Eq(expected));
+  }
+}
+
+TEST_P(DimacsParsingTests, ParseInParallel)
+{
+  std::string const& input = get_input();
+  auto const* input_start = reinterpret_cast<std::byte const*>(input.data());
+  byte_range const input_range{input_start, input_start + input.size()};
+
+  if (std::holds_alternative<parse_error>(get_expected())) {
+    EXPECT_THROW(
+        parse_cnf_parallel(input_range, 4, [](std::vector<lit> const& /*unused*/) {}),
+        std::invalid_argument);
+  }
+  else {
+    trivial_formula expected = std::get<trivial_formula>(get_expected());
+    trivial_formula result;
+    parse_cnf_parallel(
+        input_range, 4, [&result](std::vector<lit> const& clause) { result.push_back(clause); });
+    EXPECT_THAT(result, Eq(expected));
+  }
+}
+
+TEST_P(DimacsParsingTests, ParseInParallelWithSpanReceiver)
+{
+  std::string const& input = get_input();
+  auto const* input_start = reinterpret_cast<std::byte const*>(input.data());
+  byte_range const input_range{input_start, input_start + input.size()};
+
+  if (std::holds_alternative<parse_error>(get_expected())) {
+    EXPECT_THROW(
+        parse_cnf_parallel(input_range, 4, [](lit const* /*unused*/, lit const* /*unused*/) {}),
+        std::invalid_argument);
+  }
+  else {
+    trivial_formula expected = std::get<trivial_formula>(get_expected());
+    trivial_formula result;
+    parse_cnf_parallel(input_range, 4, [&result](lit const* start, lit const* stop) {
+      result.push_back(std::vector<lit>(start, stop));
+    });
+    EXPECT_THAT(result, Eq(expected));
+  }
+}
+
+TEST_P(DimacsParsingTests, ParseInParallelPerRange)
+{
+  std::string const& input = get_input();
+  auto const* input_start = reinterpret_cast<std::byte const*>(input.data());
+  byte_range const input_range{input_start, input_start + input.size()};
+  auto const ignore_clause = [](size_t /*unused*/, std::vector<lit> const& /*unused*/) {};
+
+  if (std::holds_alternative<parse_error>(get_expected())) {
+    EXPECT_THROW(parse_cnf_parallel_per_range(input_range, 4, ignore_clause),
+                 std::invalid_argument);
+  }
+  else {
+    std::vector<trivial_formula> results(4);
+    parse_cnf_parallel_per_range(
+        input_range, 4, [&results](size_t range_index, std::vector<lit> const& clause) {
+          results[range_index].push_back(clause);
+        });
+
+    trivial_formula result;
+    for (trivial_formula const& range_result : results) {
+      result.insert(result.end(), range_result.begin(), range_result.end());
+    }
+    EXPECT_THAT(result, Eq(std::get<trivial_formula>(get_expected())));
+  }
+}
+
 using namespace cnfkit_literals;
 
 namespace {
@@ -87,6 +303,16 @@ auto create_cnf_with_huge_comment() -> std::string
   }
   return result + "\n4 0";
 }
+
+// Comment lines spanning multiple chunks, including a comment exceeding the chunk size
+auto create_cnf_with_huge_preamble() -> std::string
+{
+  std::string result = "c " + std::string(detail::default_chunk_size + 10, 'x') + "\n\n";
+  while (result.size() <= 3 * detail::default_chunk_size) {
+    result += "c 1 2 3 0\n  \t c p cnf 1 1\n";
+  }
+  return result + "p cnf 2 1\n1 -2 0";
+}
 }
 
 // clang-format off
@@ -168,9 +394,440 @@ INSTANTIATE_TEST_SUITE_P(DimacsParsingTests, DimacsParsingTests,
 
     std::make_tuple("parsing huge cnf", create_huge_cnf(), create_huge_expected_formula()),
 
-    std::make_tuple("parsing cnf with huge comment", create_cnf_with_huge_comment(), trivial_formula{{4_dlit}})
+    std::make_tuple("parsing problem with header preceded by comments with CRLF line endings",
+      "c foo\r\nc bar\r\np cnf 2 1\r\n1 2 0\r\n",
+      trivial_formula{{1_dlit, 2_dlit}}),
+
+    std::make_tuple("parsing input consisting of comments fails", "c foo\n\nc bar\n", parse_error{}),
+
+    std::make_tuple("parsing cnf with huge comment", create_cnf_with_huge_comment(), trivial_formula{{4_dlit}}),
+    std::make_tuple("parsing cnf with huge preamble", create_cnf_with_huge_preamble(), trivial_formula{{1_dlit, -2_dlit}}),
+
+    std::make_tuple("parsing problem with long comment in clause body",
+      "p cnf 3 2\n1 -2 0\nc" + std::string(100, '-') + "\n3 0",
+      trivial_formula{{1_dlit, -2_dlit}, {3_dlit}}),
+
+    std::make_tuple("parsing problem containing overlong literal fails",
+      "p cnf 2 1\n1 " + std::string(100, '1') + " 0",
+      parse_error{})
   )
 );
 // clang-format on
 
+
+namespace {
+auto create_huge_cnf_with_comments() -> std::string
+{
+  std::string result = "c generated\np cnf 10 " + std::to_string(detail::default_chunk_size) + "\n";
+  for (uint32_t i = 1; i <= detail::default_chunk_size; ++i) {
+    result += std::to_string(i) + "\n-" + std::to_string(i + 1) + " 0";
+    result += (i % 7 == 0) ? " c 0 1 0 c\n  c 0 2 0\n" : "\n";
+  }
+  return result;
+}
+
+auto as_byte_range(std::string const& str) -> byte_range
+{
+  auto const* start = reinterpret_cast<std::byte const*>(str.data());
+  return byte_range{start, start + str.size()};
+}
+}
+
+TEST(DimacsParallelParsingTests, ParseHugeCNFWithCommentsInParallel)
+{
+  std::string const input = create_huge_cnf_with_comments();
+
+  for (size_t num_threads : {1, 2, 3, 16}) {
+    std::vector<trivial_formula> results(num_threads);
+    parse_cnf_parallel_per_range(
+        as_byte_range(input), num_threads, [&results](size_t index, std::vector<lit> const& clause) {
+          results[index].push_back(clause);
+        });
+
+    trivial_formula result;
+    for (trivial_formula const& range_result : results) {
+      result.insert(result.end(), range_result.begin(), range_result.end());
+    }
+    EXPECT_THAT(result, Eq(create_huge_expected_formula())) << "threads: " << num_threads;
+  }
+}
+
+TEST(DimacsParallelParsingTests, ErrorInLastRangeIsReportedAfterPrecedingClauses)
+{
+  std::string const input = create_huge_cnf() + " 1 x 0";
+
+  size_t num_clauses = 0;
+  EXPECT_THROW(parse_cnf_parallel(as_byte_range(input),
+                                  8,
+                                  [&num_clauses](std::vector<lit> const& /*unused*/) {
+                                    ++num_clauses;
+                                  }),
+               std::invalid_argument);
+  EXPECT_THAT(num_clauses, Eq(detail::default_chunk_size));
+}
+
+TEST(DimacsParallelParsingTests, ExceptionsFromReceiverArePropagated)
+{
+  std::string const input = create_huge_cnf();
+
+  EXPECT_THROW(parse_cnf_parallel_per_range(
+                   as_byte_range(input),
+                   8,
+                   [](size_t index, std::vector<lit> const& /*unused*/) {
+                     if (index == 3) {
+                       throw std::runtime_error{"receiver failed"};
+                     }
+                   }),
+               std::runtime_error);
+}
+
+TEST(DimacsParallelParsingTests, ZeroThreadsAreRejected)
+{
+  std::string const input = "p cnf 1 1 1 0";
+  EXPECT_THROW(
+      parse_cnf_parallel(as_byte_range(input), 0, [](std::vector<lit> const& /*unused*/) {}),
+      std::invalid_argument);
+}
+
+TEST(DimacsHeaderReceiverTests, HeaderIsReceivedBeforeFirstClause)
+{
+  std::string const input = "c foo\np cnf 10 2\n1 -2 0\n3 0\n";
+  buf_source source{input};
+
+  std::optional<cnf_header> header;
+  trivial_formula result;
+  parse_cnf(
+      source,
+      [&header, &result](cnf_header const& received_header) {
+        EXPECT_TRUE(result.empty());
+        header = received_header;
+      },
+      [&header, &result](std::vector<lit> const& clause) {
+        EXPECT_TRUE(header.has_value());
+        result.push_back(clause);
+      });
+
+  ASSERT_TRUE(header.has_value());
+  EXPECT_THAT(header->num_vars, Eq(10));
+  EXPECT_THAT(header->num_clauses, Eq(2));
+  EXPECT_THAT(result, Eq(trivial_formula{{1_dlit, -2_dlit}, {3_dlit}}));
+}
+
+TEST(DimacsHeaderReceiverTests, HeaderReceiverCanStopParsing)
+{
+  std::string const input = "p cnf 10 2\n1 -2 0\n3 0\n";
+  buf_source source{input};
+
+  size_t num_clauses = 0;
+  EXPECT_THROW(parse_cnf(
+                   source,
+                   [](cnf_header const& /*unused*/) { throw std::runtime_error{"cancelled"}; },
+                   [&num_clauses](std::vector<lit> const& /*unused*/) { ++num_clauses; }),
+               std::runtime_error);
+  EXPECT_THAT(num_clauses, Eq(0));
+}
+
+TEST(DimacsHeaderReceiverTests, HeaderIsReceivedBeforeFirstClauseInParallel)
+{
+  std::string const input = create_huge_cnf_with_comments();
+
+  for (size_t num_threads : {1, 4}) {
+    std::optional<cnf_header> header;
+    trivial_formula result;
+    parse_cnf_parallel(
+        as_byte_range(input),
+        num_threads,
+        [&header, &result](cnf_header const& received_header) {
+          EXPECT_TRUE(result.empty());
+          header = received_header;
+        },
+        [&result](lit const* start, lit const* stop) { result.emplace_back(start, stop); });
+
+    ASSERT_TRUE(header.has_value());
+    EXPECT_THAT(header->num_vars, Eq(10));
+    EXPECT_THAT(header->num_clauses, Eq(detail::default_chunk_size));
+    EXPECT_THAT(result, Eq(create_huge_expected_formula())) << "threads: " << num_threads;
+  }
+}
+
+TEST(DimacsHeaderReceiverTests, HeaderIsReceivedBeforeParsingRanges)
+{
+  std::string const input = create_huge_cnf_with_comments();
+
+  std::optional<cnf_header> header;
+  std::atomic<size_t> num_clauses_before_header = 0;
+  parse_cnf_parallel_per_range(
+      as_byte_range(input),
+      4,
+      [&header](cnf_header const& received_header) { header = received_header; },
+      [&header, &num_clauses_before_header](size_t /*unused*/, std::vector<lit> const& /*unused*/) {
+        if (!header.has_value()) {
+          ++num_clauses_before_header;
+        }
+      });
+
+  ASSERT_TRUE(header.has_value());
+  EXPECT_THAT(header->num_clauses, Eq(detail::default_chunk_size));
+  EXPECT_THAT(num_clauses_before_header.load(), Eq(0));
+}
+
+TEST(DimacsPullReaderTests, HeaderIsAvailableBeforeFirstClause)
+{
+  std::string const input = "c foo\np cnf 10 2\n1 -2 0\n3 0\n";
+  buf_source source{input};
+
+  cnf_reader under_test{source};
+  EXPECT_THAT(under_test.get_header().num_vars, Eq(10));
+  EXPECT_THAT(under_test.get_header().num_clauses, Eq(2));
+
+  std::optional<clause_view> clause = under_test.next();
+  ASSERT_TRUE(clause.has_value());
+  EXPECT_THAT(std::vector<lit>(clause->begin(), clause->end()), Eq(std::vector{1_dlit, -2_dlit}));
+}
+
+TEST(DimacsPullReaderTests, ReadingCanBeStoppedEarly)
+{
+  std::string const input = create_huge_cnf() + " 1 x 0";
+  bulk_only_test_source source{input};
+
+  {
+    cnf_reader under_test{source};
+    for (size_t idx = 0; idx < 10; ++idx) {
+      ASSERT_TRUE(under_test.next().has_value());
+    }
+  }
+
+  EXPECT_FALSE(source.is_eof());
+}
+
+TEST(DimacsPullReaderTests, LentDataIsParsedIncrementally)
+{
+  size_t const num_clauses = 8 * detail::default_chunk_size;
+  std::string input = "p cnf 2 " + std::to_string(num_clauses) + "\n";
+  for (size_t idx = 0; idx < num_clauses; ++idx) {
+    input += "1 -2 0\n";
+  }
+  buf_source source{input};
+  cnf_reader under_test{source};
+  ASSERT_TRUE(under_test.next().has_value());
+
+  // If the first call had parsed the entire lent block, the error would not be detected
+  input[input.size() - 2] = 'x';
+  EXPECT_THROW(
+      {
+        while (under_test.next().has_value()) {
+        }
+      },
+      std::invalid_argument);
+}
+
+TEST(DimacsPullReaderTests, ErrorIsReportedAfterPrecedingClauses)
+{
+  std::string const input = create_huge_cnf() + " 1 x 0";
+  buf_source source{input};
+  cnf_reader under_test{source};
+
+  trivial_formula result;
+  EXPECT_THROW(
+      {
+        while (std::optional<clause_view> clause = under_test.next()) {
+          result.push_back(std::vector<lit>(clause->begin(), clause->end()));
+        }
+      },
+      std::invalid_argument);
+  EXPECT_THAT(result, Eq(create_huge_expected_formula()));
+
+  EXPECT_THROW(under_test.next(), std::invalid_argument);
+}
+
+TEST(DimacsPullReaderTests, ThrowsOnInvalidHeader)
+{
+  std::string const input = "p cnf 1\n1 0\n";
+  buf_source source{input};
+  EXPECT_THROW(cnf_reader{source}, std::invalid_argument);
+}
+
+TEST(DimacsTrustedInputTests, ParseWellFormedInput)
+{
+  std::string const input = "c foo\np cnf 10 3\n1 -2 0\n0\n-10 3 4 0";
+  buf_source source{input};
+
+  std::optional<cnf_header> header;
+  trivial_formula result;
+  parse_cnf<trusted_input>(
+      source,
+      [&header](cnf_header const& received_header) { header = received_header; },
+      [&result](std::vector<lit> const& clause) { result.push_back(clause); });
+
+  ASSERT_TRUE(header.has_value());
+  EXPECT_THAT(header->num_clauses, Eq(3));
+  EXPECT_THAT(result, Eq(trivial_formula{{1_dlit, -2_dlit}, {}, {-10_dlit, 3_dlit, 4_dlit}}));
+}
+
+TEST(DimacsTrustedInputTests, ParseHugeInput)
+{
+  std::string const input = create_huge_cnf();
+  buf_source source{input};
+
+  trivial_formula result;
+  parse_cnf<trusted_input>(source,
+                           [&result](std::vector<lit> const& clause) { result.push_back(clause); });
+  EXPECT_THAT(result, Eq(create_huge_expected_formula()));
+}
+
+TEST(DimacsTrustedInputTests, TruncatedInputIsDetected)
+{
+  for (std::string const input : {"p cnf 2 2\n1 -2 0\n2",
+                                   "p cnf 2 2\n1 -2 0\n",
+                                   "p cnf 2",
+                                   "p cnf 3 2\n1 2 0\n3 -",
+                                   "p cnf 3 2\n1 2 0\n-"}) {
+    buf_source source{input};
+    EXPECT_THROW(parse_cnf<trusted_input>(source, [](std::vector<lit> const& /*unused*/) {}),
+                 std::invalid_argument)
+        << "input: " << input;
+  }
+}
+
+class ScanKernelTests : public ::testing::TestWithParam<detail::scan_kernel> {
+};
+
+namespace {
+// Well-formed bodies contain neither comments nor syntax errors
+auto create_random_cnf_body(uint32_t seed, bool is_well_formed = false) -> std::string
+{
+  std::mt19937 rng{seed};
+  std::vector<std::string> const separators = {" ", " ", " ", "  ", "\n", "\t", "\r\n", " \v\f"};
+  std::vector<std::string> special_tokens = {"c comment 1 2 0\n",
+                                             "-0",
+                                             "007",
+                                             "1234567890",
+                                             "-999999999",
+                                             "2147483647",
+                                             "1-2"};
+  if (is_well_formed) {
+    special_tokens.erase(special_tokens.begin());
+  }
+
+  // Every fourth body contains a syntax error
+  int const error_token_idx =
+      (!is_well_formed && seed % 4 == 0) ? static_cast<int>(rng() % 2000) : -1;
+
+  std::string result;
+  for (int token_idx = 0; token_idx < 2000; ++token_idx) {
+    uint32_t const choice = rng() % 100;
+    if (token_idx == error_token_idx) {
+      result += (rng() % 2 == 0) ? "x" : "--1";
+    }
+    else if (choice == 0) {
+      result += special_tokens[rng() % special_tokens.size()];
+    }
+    else if (choice < 20) {
+      result += "0";
+    }
+    else {
+      uint32_t const num_digits = 1 + rng() % 9;
+      uint32_t value = 1 + rng() % 9;
+      for (uint32_t digit = 1; digit < num_digits; ++digit) {
+        value = value * 10 + rng() % 10;
+      }
+      result += (rng() % 2 == 0 ? "-" : "") + std::to_string(value);
+    }
+    result += separators[rng() % separators.size()];
+  }
+  return result;
+}
+
+struct scan_result {
+  trivial_formula clauses;
+  bool failed = false;
+
+  auto operator==(scan_result const& rhs) const -> bool
+  {
+    return clauses == rhs.clauses && failed == rhs.failed;
+  }
+};
+
+template <typename InputPolicy = validated_input>
+auto parse_body_with_kernel(std::string const& body, detail::scan_kernel kernel) -> scan_result
+{
+  scan_result result;
+  detail::cnf_chunk_parser parser{detail::cnf_chunk_parser_mode::dimacs, kernel};
+  try {
+    parser.parse<InputPolicy>(body, 0, [&result](bool /*unused*/, std::vector<lit> const& clause) {
+      result.clauses.push_back(clause);
+    });
+  }
+  catch (std::invalid_argument const&) {
+    result.failed = true;
+  }
+  return result;
+}
+}
+
+TEST_P(ScanKernelTests, ResultsMatchRegularParser)
+{
+  if (!detail::is_scan_kernel_supported(GetParam())) {
+    GTEST_SKIP() << "scan kernel not supported on this machine";
+  }
+
+  for (uint32_t seed = 0; seed < 100; ++seed) {
+    std::string const body = create_random_cnf_body(seed);
+    scan_result const expected = parse_body_with_kernel(body, detail::scan_kernel::disabled);
+    scan_result const result = parse_body_with_kernel(body, GetParam());
+    EXPECT_TRUE(result == expected) << "seed: " << seed;
+  }
+}
+
+TEST_P(ScanKernelTests, ResultsForTrustedInputMatchRegularParser)
+{
+  if (!detail::is_scan_kernel_supported(GetParam())) {
+    GTEST_SKIP() << "scan kernel not supported on this machine";
+  }
+
+  for (uint32_t seed = 0; seed < 100; ++seed) {
+    std::string const body = create_random_cnf_body(seed, true);
+    scan_result const expected = parse_body_with_kernel(body, detail::scan_kernel::disabled);
+    ASSERT_FALSE(expected.failed);
+
+    EXPECT_TRUE(parse_body_with_kernel<trusted_input>(body, GetParam()) == expected)
+        << "seed: " << seed;
+    EXPECT_TRUE(parse_body_with_kernel<trusted_input>(body, detail::scan_kernel::disabled) ==
+                expected)
+        << "seed: " << seed;
+  }
+}
+
+TEST_P(ScanKernelTests, TokensFillingBlockAreLeftToRegularParser)
+{
+  if (!detail::is_scan_kernel_supported(GetParam())) {
+    GTEST_SKIP() << "scan kernel not supported on this machine";
+  }
+
+  std::string const body_with_comment = "1 -2 0\nc" + std::string(100, '-') + "\n3 0\n";
+  EXPECT_TRUE(parse_body_with_kernel(body_with_comment, GetParam()) ==
+              (scan_result{{{1_dlit, -2_dlit}, {3_dlit}}, false}));
+
+  std::string const body_with_overlong_lit = "1 " + std::string(100, '1') + " 0\n";
+  EXPECT_TRUE(parse_body_with_kernel(body_with_overlong_lit, GetParam()).failed);
+
+  std::string const body_with_padded_lit = "1 -" + std::string(99, '0') + "2 0\n";
+  EXPECT_TRUE(parse_body_with_kernel<trusted_input>(body_with_padded_lit, GetParam()) ==
+              (scan_result{{{1_dlit, -2_dlit}}, false}));
+}
+
+TEST(ScanKernelTests, SwarDigitParsing)
+{
+  std::string const digits = "12345678        ";
+  for (size_t num_digits = 1; num_digits <= 8; ++num_digits) {
+    EXPECT_THAT(detail::parse_digits_swar(digits.data(), num_digits),
+                Eq(std::stoul(digits.substr(0, num_digits))));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(ScanKernelTests,
+                         ScanKernelTests,
+                         ::testing::Values(detail::scan_kernel::scalar,
+                                           detail::scan_kernel::sse2,
+                                           detail::scan_kernel::avx2));
 }
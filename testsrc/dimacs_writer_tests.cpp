@@ -0,0 +1,234 @@
+#include <cnfkit/dimacs_writer.h>
+
+#include <cnfkit/dimacs_parser.h>
+#include <cnfkit/io.h>
+#include <cnfkit/io/io_buf.h>
+#include <cnfkit/io/io_mmap.h>
+#include <cnfkit/io/io_stdstream.h>
+#include <cnfkit/literal.h>
+
+#include "test_utils.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using ::testing::Eq;
+
+namespace cnfkit {
+
+namespace {
+class test_sink : public sink {
+public:
+  void write_bytes(std::byte const* start, std::byte const* stop) override
+  {
+    m_data.append(reinterpret_cast<char const*>(start), stop - start);
+    ++m_num_writes;
+  }
+
+  void flush() override {}
+
+  auto get_data() const -> std::string const& { return m_data; }
+  auto get_num_writes() const -> size_t { return m_num_writes; }
+
+private:
+  std::string m_data;
+  size_t m_num_writes = 0;
+};
+
+using test_formula = std::vector<std::vector<lit>>;
+
+void write_formula(test_formula const& formula, dimacs_writer& writer)
+{
+  for (std::vector<lit> const& clause : formula) {
+    writer.add_clause(clause.data(), clause.data() + clause.size());
+  }
+}
+
+auto parse_formula(source& source) -> test_formula
+{
+  test_formula result;
+  parse_cnf(source, [&result](std::vector<lit> const& clause) { result.push_back(clause); });
+  return result;
+}
+
+auto create_random_formula(size_t num_clauses) -> test_formula
+{
+  std::mt19937 rng{1};
+  std::uniform_int_distribution<uint32_t> var_distribution{0, max_dimacs_lit - 1};
+  std::uniform_int_distribution<size_t> size_distribution{0, 20};
+
+  test_formula result(num_clauses);
+  for (std::vector<lit>& clause : result) {
+    clause.resize(size_distribution(rng));
+    for (lit& literal : clause) {
+      literal = lit{var{var_distribution(rng) >> (rng() % 31)}, rng() % 2 == 0};
+    }
+  }
+  return result;
+}
+}
+
+using namespace cnfkit_literals;
+
+TEST(DimacsWriterTests, WriteEmptyFormula)
+{
+  test_sink sink;
+  dimacs_writer under_test{sink, 0, 0};
+  under_test.flush();
+  EXPECT_THAT(sink.get_data(), Eq("p cnf 0 0\n"));
+}
+
+TEST(DimacsWriterTests, WriteFormula)
+{
+  test_sink sink;
+  dimacs_writer under_test{sink, 4, 3};
+
+  write_formula({{1_dlit, -2_dlit}, {}, {-4_dlit, 3_dlit, 1_dlit}}, under_test);
+  under_test.flush();
+
+  EXPECT_THAT(sink.get_data(), Eq("p cnf 4 3\n1 -2 0\n0\n-4 3 1 0\n"));
+  EXPECT_THAT(under_test.get_num_clauses(), Eq(3));
+  EXPECT_THAT(under_test.get_num_vars(), Eq(4));
+}
+
+TEST(DimacsWriterTests, WriteMaximalLiterals)
+{
+  test_formula const input = {{dimacs_to_lit(min_dimacs_lit), dimacs_to_lit(max_dimacs_lit)}};
+
+  test_sink sink;
+  dimacs_writer under_test{sink, max_dimacs_lit, 1};
+  write_formula(input, under_test);
+  under_test.flush();
+
+  EXPECT_THAT(sink.get_data(), Eq("p cnf 2147483647 1\n-2147483647 2147483647 0\n"));
+  EXPECT_THAT(under_test.get_num_vars(), Eq(max_dimacs_lit));
+}
+
+TEST(DimacsWriterTests, WrittenFormulaCanBeParsed)
+{
+  test_formula const input = create_random_formula(10000);
+
+  test_sink sink;
+  dimacs_writer under_test{sink, max_dimacs_lit, input.size()};
+  write_formula(input, under_test);
+  under_test.flush();
+
+  buf_source source{sink.get_data()};
+  EXPECT_THAT(parse_formula(source), Eq(input));
+}
+
+TEST(DimacsWriterTests, WrittenFormulaCanBeParsedAsTrustedInput)
+{
+  test_formula const input = create_random_formula(10000);
+
+  test_sink sink;
+  dimacs_writer under_test{sink, max_dimacs_lit, input.size()};
+  write_formula(input, under_test);
+  under_test.flush();
+
+  buf_source source{sink.get_data()};
+  test_formula result;
+  parse_cnf<trusted_input>(source,
+                           [&result](std::vector<lit> const& clause) { result.push_back(clause); });
+  EXPECT_THAT(result, Eq(input));
+}
+
+TEST(DimacsWriterTests, ThrowsOnLiteralOutOfRange)
+{
+  std::vector<lit> const clause = {1_dlit, lit{var{max_dimacs_lit}, true}};
+
+  test_sink sink;
+  dimacs_writer under_test{sink, 1, 1};
+  EXPECT_THROW(under_test.add_clause(clause.data(), clause.data() + clause.size()),
+               std::invalid_argument);
+
+  under_test.flush();
+  EXPECT_THAT(sink.get_data(), Eq("p cnf 1 1\n"));
+  EXPECT_THAT(under_test.get_num_clauses(), Eq(0));
+  EXPECT_THAT(under_test.get_num_vars(), Eq(0));
+}
+
+TEST(DimacsWriterTests, ThrowsOnNumberOfVariablesOutOfRange)
+{
+  test_sink sink;
+  EXPECT_THROW(dimacs_writer(sink, size_t{max_dimacs_lit} + 1, 0), std::invalid_argument);
+}
+
+TEST(DimacsWriterTests, ClausesAreWrittenWhenBufferIsFull)
+{
+  std::vector<lit> const clause = {1_dlit, -2_dlit, 3_dlit};
+
+  test_sink sink;
+  dimacs_writer under_test{sink, 3, 100, 64};
+  EXPECT_THAT(sink.get_num_writes(), Eq(0));
+
+  while (sink.get_num_writes() == 0) {
+    under_test.add_clause(clause.data(), clause.data() + clause.size());
+  }
+  EXPECT_THAT(under_test.get_num_buffered_bytes(), Eq(0));
+
+  under_test.add_clause(clause.data(), clause.data() + clause.size());
+  EXPECT_GT(under_test.get_num_buffered_bytes(), 0);
+}
+
+TEST(DimacsWriterTests, BufferedClausesAreWrittenOnDestruction)
+{
+  test_sink sink;
+  {
+    dimacs_writer under_test{sink, 2, 1};
+    write_formula({{1_dlit, 2_dlit}}, under_test);
+    EXPECT_THAT(sink.get_num_writes(), Eq(0));
+  }
+  EXPECT_THAT(sink.get_data(), Eq("p cnf 2 1\n1 2 0\n"));
+}
+
+TEST(DimacsWriterTests, PatchedPlaceholderHeaderCanBeParsed)
+{
+  test_formula const input = create_random_formula(1000);
+
+  temp_dir const dir{"cnfkit_dimacs_writer"};
+  std::filesystem::path const path = dir.get_path() / "formula.cnf";
+
+  size_t num_vars = 0;
+  size_t num_clauses = 0;
+  {
+    std::ofstream file{path, std::ios::binary};
+    ostream_sink sink{file};
+    dimacs_writer under_test{sink};
+    write_formula(input, under_test);
+    under_test.flush();
+
+    num_vars = under_test.get_num_vars();
+    num_clauses = under_test.get_num_clauses();
+  }
+
+  EXPECT_THAT(num_clauses, Eq(input.size()));
+  patch_dimacs_header(path, num_vars, num_clauses);
+
+  mmap_source source{path};
+  EXPECT_THAT(parse_formula(source), Eq(input));
+
+  std::ifstream file{path, std::ios::binary};
+  std::string header_line;
+  std::getline(file, header_line);
+  EXPECT_THAT(header_line.size() + 1, Eq(dimacs_writer::placeholder_header_size));
+}
+
+TEST(DimacsWriterTests, PatchingThrowsWithoutPlaceholderHeader)
+{
+  temp_dir const dir{"cnfkit_dimacs_writer"};
+  std::filesystem::path const path = dir.get_path() / "formula.cnf";
+  write_file(path, "p cnf 2 1\n1 2 0\n");
+
+  EXPECT_THROW(patch_dimacs_header(path, 2, 1), std::invalid_argument);
+  EXPECT_THROW(patch_dimacs_header(dir.get_path() / "does_not_exist.cnf", 2, 1),
+               std::runtime_error);
+}
+}
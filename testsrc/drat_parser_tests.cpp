@@ -7,8 +7,13 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <optional>
+#include <random>
 #include <stdexcept>
 #include <string>
 #include <variant>
@@ -99,6 +104,150 @@ TEST_P(DratParsingTests, ParseFromBufSource)
   }
 }
 
+TEST_P(DratParsingTests, ParseWithBulkReadsOnly)
+{
+  std::string const input = get_input();
+  bulk_only_test_source source{input};
+  auto const parse = [this, &source](auto&& clause_receiver) {
+    if (get_format() == drat_format::text) {
+      parse_drat_text(source, clause_receiver);
+    }
+    else {
+      parse_drat_binary(source, clause_receiver);
+    }
+  };
+
+  if (std::holds_alternative<parse_error>(get_expected())) {
+    EXPECT_THROW(parse([](bool /*unused*/, std::vector<lit> const& /*unused*/) {}),
+                 std::invalid_argument);
+  }
+  else {
+    trivial_proof result;
+    parse([&result](bool is_added, std::vector<lit> const& clause) {
+      result.push_back({is_added, clause});
+    });
+    EXPECT_THAT(result, Eq(std::get<trivial_proof>(get_expected())));
+  }
+}
+
+TEST_P(DratParsingTests, ParseWithSpanReceiver)
+{
+  std::string const input = get_input();
+  buf_source source{input};
+  auto const parse = [this, &source](auto&& clause_receiver) {
+    if (get_format() == drat_format::text) {
+      parse_drat_text(source, clause_receiver);
+    }
+    else {
+      parse_drat_binary(source, clause_receiver);
+    }
+  };
+
+  if (std::holds_alternative<parse_error>(get_expected())) {
+    EXPECT_THROW(parse([](bool /*unused*/, lit const* /*unused*/, lit const* /*unused*/) {}),
+                 std::invalid_argument);
+  }
+  else {
+    trivial_proof result;
+    parse([&result](bool is_added, lit const* start, lit const* stop) {
+      result.push_back({is_added, std::vector<lit>(start, stop)});
+    });
+    EXPECT_THAT(result, Eq(std::get<trivial_proof>(get_expected())));
+  }
+}
+
+TEST_P(DratParsingTests, ParseBatched)
+{
+  std::string const input = get_input();
+
+  for (size_t max_batch_size : {1, 3, 4096}) {
+    buf_source source{input};
+    auto const parse = [this, &source, max_batch_size](auto&& batch_receiver) {
+      if (get_format() == drat_format::text) {
+        parse_drat_text_batched(source, batch_receiver, max_batch_size);
+      }
+      else {
+        parse_drat_binary_batched(source, batch_receiver, max_batch_size);
+      }
+    };
+
+    if (std::holds_alternative<parse_error>(get_expected())) {
+      EXPECT_THROW(parse([](clause_batch const& /*unused*/) {}), std::invalid_argument);
+    }
+    else {
+      trivial_proof result;
+      parse([&result, max_batch_size](clause_batch const& batch) {
+        EXPECT_LE(batch.size(), max_batch_size);
+        for (size_t idx = 0; idx < batch.size(); ++idx) {
+          std::vector<lit> const clause(batch.clause_start(idx), batch.clause_stop(idx));
+          result.push_back({batch.is_added(idx), clause});
+        }
+      });
+      EXPECT_THAT(result, Eq(std::get<trivial_proof>(get_expected())));
+    }
+  }
+}
+
+TEST_P(DratParsingTests, ParseWithPullReader)
+{
+  std::string const input = get_input();
+  buf_source source{input};
+
+  auto read_all = [this, &source]() {
+    std::unique_ptr<drat_reader> reader;
+    if (get_format() == drat_format::text) {
+      reader = std::make_unique<drat_text_reader>(source);
+    }
+    else {
+      reader = std::make_unique<drat_binary_reader>(source);
+    }
+
+    trivial_proof result;
+    while (std::optional<clause_view> clause = reader->next()) {
+      result.push_back({clause->is_added, std::vector<lit>(clause->begin(), clause->end())});
+    }
+    EXPECT_THAT(reader->next(), Eq(std::nullopt));
+    return result;
+  };
+
+  if (std::holds_alternative<parse_error>(get_expected())) {
+    EXPECT_THROW(read_all(), std::invalid_argument);
+  }
+  else {
+    EXPECT_THAT(read_all(), Eq(std::get<trivial_proof>(get_expected())));
+  }
+}
+
+TEST_P(DratParsingTests, ParseFromSourceLendingSmallBlocks)
+{
+  std::string const input = get_input();
+
+  for (size_t block_size : {1, 2, 3, 7}) {
+    lending_test_source source{input, block_size};
+    auto const parse = [this, &source](auto&& clause_receiver) {
+      if (get_format() == drat_format::text) {
+        parse_drat_text(source, clause_receiver);
+      }
+      else {
+        parse_drat_binary(source, clause_receiver);
+      }
+    };
+
+    if (std::holds_alternative<parse_error>(get_expected())) {
+      EXPECT_THROW(parse([](bool /*unused*/, std::vector<lit> const& /*unused*/) {}),
+                   std::exception);
+    }
+    else {
+      trivial_proof result;
+      parse([&result](bool is_added, std::vector<lit> const& clause) {
+        result.push_back({is_added, clause});
+      });
+      EXPECT_THAT(result, Eq(std::get<trivial_proof>(get_expected())))
+          << "block size: " << block_size;
+    }
+  }
+}
+
 using namespace cnfkit_literals;
 
 // clang-format off
@@ -123,6 +272,13 @@ INSTANTIATE_TEST_SUITE_P(DratParsingTests, DratParsingTests,
     std::make_tuple("parsing proof ending in deleted clause fails (3)", "1 2 0 d\nc foo bar\n  c baz", parse_error{}),
     std::make_tuple("parsing proof ending in deleted clause fails (4)", "1 2 0 d\n", parse_error{}),
 
+    std::make_tuple("parsing proof with long comment",
+      "1 -2 0\nc" + std::string(100, '=') + "\nd 1 -2 0",
+      trivial_proof{proof_clause{1, {1_dlit, -2_dlit}}, proof_clause{0, {1_dlit, -2_dlit}}}),
+
+    std::make_tuple("parsing proof containing overlong literal fails",
+      "1 " + std::string(100, '1') + " 0", parse_error{}),
+
     std::make_tuple("parsing binary proof with single added empty clause",
       std::vector<char>{0x61, 0}, trivial_proof{proof_clause{true, {}}}),
 
@@ -155,6 +311,9 @@ INSTANTIATE_TEST_SUITE_P(DratParsingTests, DratParsingTests,
       }
     ),
 
+    std::make_tuple("parsing binary proof with literals encoded as a and d",
+      std::vector<char>{0x61, 0x61, 0x64, 0}, trivial_proof{proof_clause{true, {-48_dlit, 50_dlit}}}),
+
     std::make_tuple("parsing empty binary proof", std::vector<char>{}, trivial_proof{}),
     std::make_tuple("parsing binary proof ending in open clause fails (1)", std::vector<char>{'\x64'}, parse_error{}),
     std::make_tuple("parsing binary proof ending in open clause fails (2)", std::vector<char>{'\x64', '\x7f'}, parse_error{}),
@@ -168,4 +327,228 @@ INSTANTIATE_TEST_SUITE_P(DratParsingTests, DratParsingTests,
 );
 // clang-format on
 
+namespace {
+auto create_huge_binary_proof(size_t num_clauses) -> std::string
+{
+  std::string result;
+  for (size_t idx = 0; idx < num_clauses; ++idx) {
+    result += (idx % 3 == 0) ? "d\x02\x05" : "a\x03\x81\x01";
+    result += '\0';
+  }
+  return result;
+}
+}
+
+TEST(DratPullReaderTests, ReadingCanBeStoppedEarly)
+{
+  std::string const input = create_huge_binary_proof(detail::default_chunk_size) + "x";
+  bulk_only_test_source source{input};
+
+  {
+    drat_binary_reader under_test{source};
+    for (size_t idx = 0; idx < 10; ++idx) {
+      std::optional<clause_view> const clause = under_test.next();
+      ASSERT_TRUE(clause.has_value());
+      EXPECT_THAT(clause->is_added, Eq(idx % 3 != 0));
+    }
+  }
+
+  EXPECT_FALSE(source.is_eof());
+}
+
+TEST(DratPullReaderTests, LentDataIsParsedIncrementally)
+{
+  for (drat_format const format : {drat_format::text, drat_format::binary}) {
+    std::string input;
+    if (format == drat_format::text) {
+      for (size_t idx = 0; idx < 8 * detail::default_chunk_size; ++idx) {
+        input += "d 1 -2 0\n";
+      }
+    }
+    else {
+      input = create_huge_binary_proof(8 * detail::default_chunk_size);
+    }
+
+    buf_source source{input};
+    std::unique_ptr<drat_reader> under_test;
+    if (format == drat_format::text) {
+      under_test = std::make_unique<drat_text_reader>(source);
+    }
+    else {
+      under_test = std::make_unique<drat_binary_reader>(source);
+    }
+    ASSERT_TRUE(under_test->next().has_value());
+
+    // If the first call had parsed the entire lent block, the error would not be detected
+    input[input.size() - 1] = 'x';
+    EXPECT_THROW(
+        {
+          while (under_test->next().has_value()) {
+          }
+        },
+        std::invalid_argument);
+  }
+}
+
+TEST(DratPullReaderTests, ErrorIsReportedAfterPrecedingClauses)
+{
+  std::string const input = create_huge_binary_proof(detail::default_chunk_size) + "x";
+  buf_source source{input};
+  drat_binary_reader under_test{source};
+
+  size_t num_clauses = 0;
+  EXPECT_THROW(
+      {
+        while (under_test.next().has_value()) {
+          ++num_clauses;
+        }
+      },
+      std::invalid_argument);
+  EXPECT_THAT(num_clauses, Eq(detail::default_chunk_size));
+
+  EXPECT_THROW(under_test.next(), std::invalid_argument);
+}
+
+TEST(DratTrustedInputTests, ResultsMatchRegularParser)
+{
+  std::string input;
+  for (int idx = 0; idx < 100000; ++idx) {
+    input += (idx % 3 == 0) ? "d 1 -2 0\n" : std::to_string(idx) + " -1234567890 3 0\n";
+  }
+
+  trivial_proof expected;
+  trivial_proof result;
+  buf_source source{input};
+  parse_drat_text(source, [&expected](bool is_added, std::vector<lit> const& clause) {
+    expected.push_back({is_added, clause});
+  });
+
+  buf_source trusted_source{input};
+  parse_drat_text<trusted_input>(trusted_source,
+                                 [&result](bool is_added, std::vector<lit> const& clause) {
+                                   result.push_back({is_added, clause});
+                                 });
+
+  EXPECT_THAT(result.size(), Eq(100000));
+  EXPECT_THAT(result, Eq(expected));
+}
+
+TEST(DratTrustedInputTests, TruncatedInputIsDetected)
+{
+  for (std::string const input : {"1 2 0\nd", "1 2 0\nd 1 2", "1 2", "1 2 0\n3 4 -", "1 2 0\n-"}) {
+    buf_source source{input};
+    EXPECT_THROW(parse_drat_text<trusted_input>(
+                     source, [](bool /*unused*/, std::vector<lit> const& /*unused*/) {}),
+                 std::invalid_argument)
+        << "input: " << input;
+  }
+}
+
+class Leb128KernelTests : public ::testing::TestWithParam<detail::leb128_kernel> {
+};
+
+namespace {
+auto encode_leb128_reference(uint32_t value) -> std::string
+{
+  std::string result;
+  while (value >= 0x80) {
+    result += static_cast<char>((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  result += static_cast<char>(value);
+  return result;
+}
+
+auto create_random_binary_proof(uint32_t seed) -> std::string
+{
+  std::mt19937 rng{seed};
+  std::vector<std::string> const special_lits = {
+      std::string{"\x80\x00", 2},     // variable 0
+      std::string{"\x01"},             // variable 0
+      std::string{"\x82\x80\x00", 3}, // non-canonical encoding of 1
+      "\xff\xff\xff\xff\x0f",      // largest encodable literal
+      "\xff\xff\xff\xff\x1f",      // out of range
+      "\x80\x80\x80\x80\x80\x01"}; // too long
+
+  // Every fourth proof contains an invalid literal
+  int const error_clause_idx = (seed % 4 == 0) ? static_cast<int>(rng() % 200) : -1;
+
+  std::string result;
+  for (int clause_idx = 0; clause_idx < 200; ++clause_idx) {
+    result += (rng() % 2 == 0) ? 'a' : 'd';
+
+    uint32_t const size = rng() % 40;
+    for (uint32_t lit_idx = 0; lit_idx < size; ++lit_idx) {
+      if (clause_idx == error_clause_idx && lit_idx == size / 2) {
+        result += special_lits[rng() % special_lits.size()];
+      }
+      else if (rng() % 100 == 0) {
+        result += special_lits[2 + rng() % 2];
+      }
+      else {
+        // Values of 1 to 5 bytes, with varying likelihood
+        uint32_t const num_bits = 2 + rng() % 31;
+        uint32_t const value = std::max<uint32_t>(2, rng() >> (32 - num_bits));
+        result += encode_leb128_reference(value);
+      }
+    }
+    result += '\0';
+  }
+  return result;
+}
+
+struct leb128_parse_result {
+  trivial_proof clauses;
+  bool failed = false;
+
+  auto operator==(leb128_parse_result const& rhs) const -> bool
+  {
+    return clauses == rhs.clauses && failed == rhs.failed;
+  }
+};
+
+auto parse_binary_proof_with_kernel(std::string const& input, detail::leb128_kernel kernel)
+    -> leb128_parse_result
+{
+  leb128_parse_result result;
+  detail::drat_binary_chunk_parser parser{kernel};
+  std::byte const* start = reinterpret_cast<std::byte const*>(input.data());
+  try {
+    parser.parse(start,
+                 start + input.size(),
+                 [&result](bool is_added, lit const* clause_start, lit const* clause_stop) {
+                   result.clauses.emplace_back(is_added,
+                                               std::vector<lit>(clause_start, clause_stop));
+                 });
+    parser.check_on_drat_finish();
+  }
+  catch (std::invalid_argument const&) {
+    result.failed = true;
+  }
+  return result;
+}
+}
+
+TEST_P(Leb128KernelTests, ResultsMatchRegularParser)
+{
+  if (!detail::is_leb128_kernel_supported(GetParam())) {
+    GTEST_SKIP() << "LEB128 kernel not supported on this machine";
+  }
+
+  for (uint32_t seed = 0; seed < 200; ++seed) {
+    std::string const input = create_random_binary_proof(seed);
+    leb128_parse_result const expected =
+        parse_binary_proof_with_kernel(input, detail::leb128_kernel::disabled);
+    leb128_parse_result const result = parse_binary_proof_with_kernel(input, GetParam());
+    EXPECT_TRUE(result == expected) << "seed: " << seed;
+    EXPECT_TRUE(seed % 4 == 0 || !expected.failed) << "seed: " << seed;
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Leb128KernelTests,
+                         Leb128KernelTests,
+                         ::testing::Values(detail::leb128_kernel::scalar,
+                                           detail::leb128_kernel::bmi2,
+                                           detail::leb128_kernel::ssse3,
+                                           detail::leb128_kernel::avx2));
 }
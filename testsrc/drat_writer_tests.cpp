@@ -8,7 +8,12 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <charconv>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
@@ -23,6 +28,7 @@ public:
   void write_bytes(std::byte const* start, std::byte const* stop) override
   {
     m_buffer.insert(m_buffer.end(), start, stop);
+    ++m_num_writes;
   }
 
   void flush() override {}
@@ -38,8 +44,11 @@ public:
 
   auto bytes() -> std::vector<std::byte> const& { return m_buffer; }
 
+  auto get_num_writes() const -> size_t { return m_num_writes; }
+
 private:
   std::vector<std::byte> m_buffer;
+  size_t m_num_writes = 0;
 };
 
 using test_proof_clause = std::pair<bool, std::vector<lit>>;
@@ -134,4 +143,196 @@ INSTANTIATE_TEST_SUITE_P(DratWriterTest, DratWriterTest,
     std::make_tuple("writing proof containing maximal literals",
                     test_proof{{true, {dimacs_to_lit(min_dimacs_lit), dimacs_to_lit(max_dimacs_lit)}}})));
 // clang-format on
+
+template <typename Writer>
+class BufferedDratWriterTests : public ::testing::Test {
+};
+
+using DratWriterTypes = ::testing::Types<drat_text_writer, drat_binary_writer>;
+TYPED_TEST_SUITE(BufferedDratWriterTests, DratWriterTypes);
+
+TYPED_TEST(BufferedDratWriterTests, ClausesAreWrittenWhenBufferIsFull)
+{
+  std::vector<lit> const clause = {1_dlit, -2_dlit, 3_dlit};
+
+  test_sink sink;
+  TypeParam under_test{sink, 64};
+
+  under_test.add_clause(clause.data(), clause.data() + clause.size());
+  EXPECT_THAT(sink.get_num_writes(), Eq(0));
+  EXPECT_GT(under_test.get_num_buffered_bytes(), 0);
+
+  while (sink.get_num_writes() == 0) {
+    under_test.add_clause(clause.data(), clause.data() + clause.size());
+  }
+
+  EXPECT_GE(sink.bytes().size(), 64);
+  EXPECT_THAT(under_test.get_num_buffered_bytes(), Eq(0));
+
+  under_test.del_clause(clause.data(), clause.data() + clause.size());
+  EXPECT_GT(under_test.get_num_buffered_bytes(), 0);
+
+  under_test.flush();
+  EXPECT_THAT(under_test.get_num_buffered_bytes(), Eq(0));
+  EXPECT_THAT(sink.get_num_writes(), Eq(2));
+}
+
+TYPED_TEST(BufferedDratWriterTests, ClausesAreWrittenImmediatelyWithoutBuffer)
+{
+  std::vector<lit> const clause = {1_dlit, -2_dlit, 3_dlit};
+
+  test_sink sink;
+  TypeParam under_test{sink, 0};
+
+  under_test.add_clause(clause.data(), clause.data() + clause.size());
+  EXPECT_THAT(sink.get_num_writes(), Eq(1));
+  EXPECT_THAT(under_test.get_num_buffered_bytes(), Eq(0));
+}
+
+TYPED_TEST(BufferedDratWriterTests, BufferedClausesAreWrittenOnDestruction)
+{
+  std::vector<lit> const clause = {1_dlit, -2_dlit, 3_dlit};
+  test_sink sink;
+
+  {
+    TypeParam under_test{sink};
+    under_test.add_clause(clause.data(), clause.data() + clause.size());
+    EXPECT_THAT(sink.get_num_writes(), Eq(0));
+  }
+
+  EXPECT_THAT(sink.get_num_writes(), Eq(1));
+  EXPECT_FALSE(sink.bytes().empty());
+}
+
+TYPED_TEST(BufferedDratWriterTests, BufferedClausesAreWrittenOnMoveAssignment)
+{
+  std::vector<lit> const clause = {1_dlit, -2_dlit, 3_dlit};
+  test_sink sink1;
+  test_sink sink2;
+
+  TypeParam writer1{sink1};
+  TypeParam writer2{sink2};
+  writer1.add_clause(clause.data(), clause.data() + clause.size());
+  writer2.add_clause(clause.data(), clause.data() + clause.size());
+
+  writer1 = std::move(writer2);
+  EXPECT_THAT(sink1.get_num_writes(), Eq(1));
+  EXPECT_THAT(sink2.get_num_writes(), Eq(0));
+
+  writer1.flush();
+  EXPECT_THAT(sink2.get_num_writes(), Eq(1));
+}
+
+TYPED_TEST(BufferedDratWriterTests, ClausesWithOutOfRangeLiteralsAreRejected)
+{
+  std::vector<lit> const valid_clause = {1_dlit, -2_dlit};
+  std::vector<lit> const invalid_clause = {1_dlit, lit{var{max_dimacs_lit}, true}};
+
+  test_sink sink;
+  TypeParam under_test{sink};
+  under_test.add_clause(valid_clause.data(), valid_clause.data() + valid_clause.size());
+  size_t const num_buffered_bytes = under_test.get_num_buffered_bytes();
+
+  EXPECT_THROW(
+      under_test.add_clause(invalid_clause.data(), invalid_clause.data() + invalid_clause.size()),
+      std::invalid_argument);
+  EXPECT_THAT(under_test.get_num_buffered_bytes(), Eq(num_buffered_bytes));
+}
+
+TEST(DimacsEncodingTests, EncodeDecimal)
+{
+  std::vector<uint32_t> values = {0, std::numeric_limits<uint32_t>::max()};
+  for (uint64_t power = 1; power <= std::numeric_limits<uint32_t>::max(); power *= 10) {
+    values.push_back(static_cast<uint32_t>(power - 1));
+    values.push_back(static_cast<uint32_t>(power));
+    values.push_back(static_cast<uint32_t>(power + 1));
+  }
+  for (uint64_t power = 1; power <= std::numeric_limits<uint32_t>::max(); power *= 2) {
+    values.push_back(static_cast<uint32_t>(power - 1));
+    values.push_back(static_cast<uint32_t>(power));
+  }
+  for (uint32_t value = 0; value < 100000; value += 7) {
+    values.push_back(value * 43);
+  }
+
+  for (uint32_t const value : values) {
+    char expected[16];
+    char* const expected_stop = std::to_chars(expected, expected + sizeof(expected), value).ptr;
+
+    char result[16];
+    char* const result_stop = detail::encode_decimal(result, value);
+
+    ASSERT_THAT(std::string(result, result_stop), Eq(std::string(expected, expected_stop)))
+        << "value: " << value;
+    ASSERT_THAT(detail::count_decimal_digits(value), Eq(expected_stop - expected));
+  }
+}
+
+TEST(DimacsEncodingTests, EncodeDimacsLit)
+{
+  char result[detail::max_encoded_dimacs_lit_size];
+
+  char* stop = detail::encode_dimacs_lit(result, -1_dlit);
+  EXPECT_THAT(std::string(result, stop), Eq("-1 "));
+
+  stop = detail::encode_dimacs_lit(result, 1_dlit);
+  EXPECT_THAT(std::string(result, stop), Eq("1 "));
+
+  stop = detail::encode_dimacs_lit(result, dimacs_to_lit(min_dimacs_lit));
+  EXPECT_THAT(std::string(result, stop), Eq("-2147483647 "));
+}
+
+class Leb128EncodingTests : public ::testing::TestWithParam<detail::leb128_kernel> {
+};
+
+namespace {
+auto encode_leb128_reference(lit const* start, lit const* stop) -> std::vector<std::byte>
+{
+  std::vector<std::byte> result;
+  for (lit const* cursor = start; cursor != stop; ++cursor) {
+    uint32_t value =
+        (cursor->get_var().get_raw_value() + 1) * 2 + (cursor->is_positive() ? 0 : 1);
+    while (value >= 0x80) {
+      result.push_back(std::byte((value & 0x7F) | 0x80));
+      value >>= 7;
+    }
+    result.push_back(std::byte(value));
+  }
+  return result;
+}
+}
+
+TEST_P(Leb128EncodingTests, ResultsMatchReferenceEncoding)
+{
+  if (!detail::is_leb128_kernel_supported(GetParam())) {
+    GTEST_SKIP() << "LEB128 kernel not supported on this machine";
+  }
+
+  std::mt19937 rng{1};
+  std::vector<lit> lits = {1_dlit, -1_dlit, 64_dlit, -64_dlit, dimacs_to_lit(max_dimacs_lit),
+                           dimacs_to_lit(min_dimacs_lit)};
+  for (int idx = 0; idx < 10000; ++idx) {
+    uint32_t const max_var = std::numeric_limits<int32_t>::max() - 1;
+    uint32_t const raw_var = static_cast<uint32_t>(rng() % max_var) >> (rng() % 31);
+    lits.push_back(lit{var{raw_var}, rng() % 2 == 0});
+  }
+
+  std::vector<std::byte> const expected =
+      encode_leb128_reference(lits.data(), lits.data() + lits.size());
+
+  std::vector<std::byte> result(lits.size() * detail::max_leb128_lit_size +
+                                detail::max_leb128_encoding_overrun);
+  detail::leb128_encode_fn const encode = detail::get_leb128_encode_fn(GetParam());
+  std::byte* const stop = encode(lits.data(), lits.data() + lits.size(), result.data());
+  result.resize(stop - result.data());
+
+  EXPECT_THAT(result, Eq(expected));
+}
+
+INSTANTIATE_TEST_SUITE_P(Leb128EncodingTests,
+                         Leb128EncodingTests,
+                         ::testing::Values(detail::leb128_kernel::scalar,
+                                           detail::leb128_kernel::bmi2,
+                                           detail::leb128_kernel::ssse3,
+                                           detail::leb128_kernel::avx2));
 }
@@ -1,8 +1,21 @@
 #include <cnfkit/io.h>
+#include <cnfkit/io/io_async.h>
 #include <cnfkit/io/io_buf.h>
+#include <cnfkit/io/io_fd.h>
 #include <cnfkit/io/io_libarchive.h>
+#include <cnfkit/io/io_mmap.h>
+#include <cnfkit/io/io_prefetching.h>
 #include <cnfkit/io/io_stdstream.h>
 #include <cnfkit/io/io_zlib.h>
+#include <cnfkit/io/io_zlib_parallel.h>
+
+#if defined(CNFKIT_TEST_LZMA)
+#include <cnfkit/io/io_lzma.h>
+#endif
+
+#if defined(CNFKIT_TEST_ZSTD)
+#include <cnfkit/io/io_zstd.h>
+#endif
 
 
 #include "test_utils.h"
@@ -10,11 +23,15 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace fs = std::filesystem;
@@ -131,6 +148,55 @@ TYPED_TEST(DecompressingSourceTests, ReadingAfterMove)
 }
 
 
+TEST(BufSourceTests, BorrowRemainingInput)
+{
+  buf_source under_test{uncompressed_input};
+  EXPECT_THAT(under_test.read_byte(), ::testing::Optional(std::byte{'L'}));
+
+  std::optional<byte_range> const range = under_test.borrow_bytes();
+  ASSERT_TRUE(range.has_value());
+  EXPECT_THAT(range->start, Eq(reinterpret_cast<std::byte const*>(uncompressed_input.data() + 1)));
+  EXPECT_THAT(range->stop - range->start, Eq(uncompressed_input.size() - 1));
+
+  EXPECT_TRUE(under_test.is_eof());
+  std::optional<byte_range> const empty_range = under_test.borrow_bytes();
+  ASSERT_TRUE(empty_range.has_value());
+  EXPECT_THAT(empty_range->start, Eq(empty_range->stop));
+}
+
+
+TEST(SourceTests, NextBlockReturnsLentData)
+{
+  buf_source under_test{uncompressed_input};
+  std::vector<std::byte> fallback_buffer(8);
+
+  byte_range const block = under_test.next_block(fallback_buffer);
+  EXPECT_THAT(block.start, Eq(reinterpret_cast<std::byte const*>(uncompressed_input.data())));
+  EXPECT_THAT(block.stop - block.start, Eq(uncompressed_input.size()));
+
+  byte_range const eof_block = under_test.next_block(fallback_buffer);
+  EXPECT_THAT(eof_block.start, Eq(eof_block.stop));
+}
+
+TEST(SourceTests, NextBlockFallsBackToReading)
+{
+  std::stringstream test_input{uncompressed_input};
+  istream_source under_test{test_input};
+  std::vector<std::byte> fallback_buffer(8);
+
+  std::vector<std::byte> result;
+  byte_range block;
+  do {
+    block = under_test.next_block(fallback_buffer);
+    EXPECT_THAT(block.start, Eq(fallback_buffer.data()));
+    EXPECT_THAT(block.stop - block.start, ::testing::Le(8));
+    result.insert(result.end(), block.start, block.stop);
+  } while (block.start != block.stop);
+
+  EXPECT_THAT(result, Eq(as_bytes(uncompressed_input)));
+}
+
+
 TEST(IStreamSourceTests, ReadCompleteInput)
 {
   std::stringstream test_input{uncompressed_input};
@@ -172,4 +238,1320 @@ TEST(IStreamSourceTests, ReadingAfterMove)
   istream_source moved_source = std::move(under_test);
   EXPECT_THAT(moved_source.read_byte(), ::testing::Optional(std::byte{'L'}));
 }
+
+
+TEST(StreambufSourceTests, ReadCompleteInput)
+{
+  std::stringbuf test_input{uncompressed_input};
+  streambuf_source under_test{test_input};
+
+  auto buffer = create_buffer();
+  auto ptr_past_end = under_test.read_bytes(buffer.data(), buffer.data() + buffer.size());
+  buffer.resize(std::distance(buffer.data(), ptr_past_end));
+
+  EXPECT_THAT(buffer, Eq(as_bytes(uncompressed_input)));
+
+  EXPECT_THAT(under_test.read_byte(), Eq(std::nullopt));
+  EXPECT_TRUE(under_test.is_eof());
+}
+
+TEST(StreambufSourceTests, ReadCompleteInputBytewise)
+{
+  std::stringbuf test_input{uncompressed_input};
+  streambuf_source under_test{test_input};
+
+  std::vector<std::byte> result;
+  while (!under_test.is_eof()) {
+    std::optional<std::byte> const byte = under_test.read_byte();
+    ASSERT_TRUE(byte.has_value());
+    result.push_back(*byte);
+  }
+
+  EXPECT_THAT(result, Eq(as_bytes(uncompressed_input)));
+  EXPECT_THAT(under_test.read_byte(), Eq(std::nullopt));
+}
+
+TEST(StreambufSourceTests, EmptyInputIsEOFBeforeReading)
+{
+  std::stringbuf test_input{""};
+  streambuf_source under_test{test_input};
+  EXPECT_TRUE(under_test.is_eof());
+}
+
+TEST(StreambufSourceTests, ReadingAfterMove)
+{
+  std::stringbuf test_input{uncompressed_input};
+  streambuf_source under_test{test_input};
+
+  streambuf_source moved_source = std::move(under_test);
+  EXPECT_THAT(moved_source.read_byte(), ::testing::Optional(std::byte{'L'}));
+}
+
+
+TEST(MmapSourceTests, ThrowsOnConstructionWhenFileNotFound)
+{
+  EXPECT_THROW(mmap_source{"does/not/exist"}, std::runtime_error);
+}
+
+TEST(MmapSourceTests, ReadCompleteInput)
+{
+  temp_dir const dir{"cnfkit_io"};
+  write_file(dir.get_path() / "input", uncompressed_input);
+  mmap_source under_test{dir.get_path() / "input"};
+
+  auto buffer = create_buffer();
+  auto ptr_past_end =
+      under_test.read_bytes(buffer.data(), buffer.data() + uncompressed_input.size());
+  buffer.resize(std::distance(buffer.data(), ptr_past_end));
+
+  EXPECT_THAT(buffer, Eq(as_bytes(uncompressed_input)));
+
+  EXPECT_THAT(under_test.read_byte(), Eq(std::nullopt));
+  EXPECT_TRUE(under_test.is_eof());
+}
+
+TEST(MmapSourceTests, BorrowRemainingInput)
+{
+  temp_dir const dir{"cnfkit_io"};
+  write_file(dir.get_path() / "input", uncompressed_input);
+  mmap_source under_test{dir.get_path() / "input"};
+
+  EXPECT_THAT(under_test.read_byte(), ::testing::Optional(std::byte{'L'}));
+
+  std::optional<byte_range> const block = under_test.borrow_bytes();
+  ASSERT_TRUE(block.has_value());
+  EXPECT_THAT(std::vector<std::byte>(block->start, block->stop),
+              Eq(as_bytes(uncompressed_input.substr(1))));
+  EXPECT_TRUE(under_test.is_eof());
+
+  std::optional<byte_range> const block_at_eof = under_test.borrow_bytes();
+  ASSERT_TRUE(block_at_eof.has_value());
+  EXPECT_THAT(block_at_eof->start, Eq(block_at_eof->stop));
+}
+
+TEST(MmapSourceTests, ReadEmptyFile)
+{
+  temp_dir const dir{"cnfkit_io"};
+  write_file(dir.get_path() / "input", "");
+  mmap_source under_test{dir.get_path() / "input"};
+
+  EXPECT_TRUE(under_test.is_eof());
+  EXPECT_THAT(under_test.read_byte(), Eq(std::nullopt));
+}
+
+TEST(MmapSourceTests, ReadingAfterMove)
+{
+  temp_dir const dir{"cnfkit_io"};
+  write_file(dir.get_path() / "input", uncompressed_input);
+  mmap_source under_test{dir.get_path() / "input"};
+
+  mmap_source moved_source = std::move(under_test);
+  EXPECT_THAT(moved_source.read_byte(), ::testing::Optional(std::byte{'L'}));
+}
+
+
+namespace {
+class failing_source : public source {
+public:
+  auto read_bytes(std::byte* start, std::byte* stop) -> std::byte* override
+  {
+    if (m_is_first_read) {
+      m_is_first_read = false;
+      return std::fill_n(start, std::distance(start, stop), std::byte{'x'});
+    }
+    throw std::runtime_error{"read error"};
+  }
+
+  auto read_byte() -> std::optional<std::byte> override { throw std::runtime_error{"read error"}; }
+  auto is_eof() -> bool override { return false; }
+
+private:
+  bool m_is_first_read = true;
+};
+}
+
+TEST(PrefetchingSourceTests, ReadCompleteInput)
+{
+  buf_source wrapped{uncompressed_input};
+  prefetching_source under_test{wrapped, 4, 2};
+
+  auto buffer = create_buffer();
+  auto ptr_past_end =
+      under_test.read_bytes(buffer.data(), buffer.data() + uncompressed_input.size());
+  buffer.resize(std::distance(buffer.data(), ptr_past_end));
+
+  EXPECT_THAT(buffer, Eq(as_bytes(uncompressed_input)));
+
+  EXPECT_THAT(under_test.read_byte(), Eq(std::nullopt));
+  EXPECT_TRUE(under_test.is_eof());
+}
+
+TEST(PrefetchingSourceTests, ReadCompleteInputBytewise)
+{
+  buf_source wrapped{uncompressed_input};
+  prefetching_source under_test{wrapped, 3, 3};
+
+  std::vector<std::byte> result;
+  while (!under_test.is_eof()) {
+    std::optional<std::byte> const byte = under_test.read_byte();
+    if (byte.has_value()) {
+      result.push_back(*byte);
+    }
+  }
+
+  EXPECT_THAT(result, Eq(as_bytes(uncompressed_input)));
+}
+
+TEST(PrefetchingSourceTests, BorrowCompleteInput)
+{
+  buf_source wrapped{uncompressed_input};
+  prefetching_source under_test{wrapped, 5, 2};
+
+  std::vector<std::byte> result;
+  std::optional<byte_range> block;
+  while ((block = under_test.borrow_bytes()) && block->start != block->stop) {
+    EXPECT_THAT(std::distance(block->start, block->stop), ::testing::Le(5));
+    result.insert(result.end(), block->start, block->stop);
+  }
+
+  EXPECT_TRUE(under_test.is_eof());
+  EXPECT_THAT(result, Eq(as_bytes(uncompressed_input)));
+}
+
+TEST(PrefetchingSourceTests, DestructionBeforeEOF)
+{
+  buf_source wrapped{uncompressed_input};
+  prefetching_source under_test{wrapped, 1, 1};
+  EXPECT_THAT(under_test.read_byte(), ::testing::Optional(std::byte{'L'}));
+}
+
+TEST(PrefetchingSourceTests, ErrorIsReportedAfterPrecedingData)
+{
+  failing_source wrapped;
+  prefetching_source under_test{wrapped, 4, 2};
+
+  std::vector<std::byte> buffer(4);
+  EXPECT_THAT(under_test.read_bytes(buffer.data(), buffer.data() + 4), Eq(buffer.data() + 4));
+  EXPECT_THAT(buffer, Eq(as_bytes("xxxx")));
+  EXPECT_THROW(under_test.read_byte(), std::runtime_error);
+}
+
+TEST(PrefetchingSourceTests, ThrowsOnInvalidBufferConfiguration)
+{
+  buf_source wrapped{uncompressed_input};
+  EXPECT_THROW(prefetching_source(wrapped, 0, 1), std::invalid_argument);
+  EXPECT_THROW(prefetching_source(wrapped, 1, 0), std::invalid_argument);
+}
+
+namespace {
+class recording_sink : public sink {
+public:
+  void write_bytes(std::byte const* start, std::byte const* stop) override
+  {
+    m_data.insert(m_data.end(), start, stop);
+  }
+
+  void flush() override { ++m_num_flushes; }
+
+  auto get_data() const -> std::vector<std::byte> const& { return m_data; }
+  auto get_num_flushes() const -> size_t { return m_num_flushes; }
+
+private:
+  std::vector<std::byte> m_data;
+  size_t m_num_flushes = 0;
+};
+
+class failing_sink : public sink {
+public:
+  void write_bytes(std::byte const* /*unused*/, std::byte const* /*unused*/) override
+  {
+    throw std::runtime_error{"write error"};
+  }
+
+  void flush() override {}
+};
+
+// Sink blocking all writes until open() is called
+class gated_sink : public sink {
+public:
+  void write_bytes(std::byte const* start, std::byte const* stop) override
+  {
+    m_is_open.wait();
+    m_wrapped.write_bytes(start, stop);
+  }
+
+  void flush() override { m_wrapped.flush(); }
+
+  void open() { m_gate.set_value(); }
+
+  auto get_data() const -> std::vector<std::byte> const& { return m_wrapped.get_data(); }
+
+private:
+  std::promise<void> m_gate;
+  std::shared_future<void> m_is_open = m_gate.get_future().share();
+  recording_sink m_wrapped;
+};
+
+void write_string(sink& sink, std::string const& str)
+{
+  std::byte const* start = reinterpret_cast<std::byte const*>(str.data());
+  sink.write_bytes(start, start + str.size());
+}
+}
+
+TEST(AsyncSinkTests, WriteCompleteInput)
+{
+  recording_sink wrapped;
+  async_sink under_test{wrapped, 4, 2};
+  for (char const ch : uncompressed_input) {
+    write_string(under_test, std::string(1, ch));
+  }
+  write_string(under_test, uncompressed_input);
+  under_test.flush();
+
+  EXPECT_THAT(wrapped.get_data(), Eq(as_bytes(uncompressed_input + uncompressed_input)));
+  EXPECT_THAT(wrapped.get_num_flushes(), Eq(1));
+}
+
+TEST(AsyncSinkTests, RemainingDataIsWrittenOnDestruction)
+{
+  recording_sink wrapped;
+  {
+    async_sink under_test{wrapped, 16, 3};
+    write_string(under_test, uncompressed_input);
+  }
+  EXPECT_THAT(wrapped.get_data(), Eq(as_bytes(uncompressed_input)));
+}
+
+TEST(AsyncSinkTests, WritingBlocksWhenAllBuffersAreFull)
+{
+  gated_sink wrapped;
+  async_sink under_test{wrapped, 4, 2};
+
+  // The first buffer is blocked in the wrapped sink, the second one is waiting
+  write_string(under_test, "abcdefg");
+  std::future<void> blocked_write =
+      std::async(std::launch::async, [&under_test]() { write_string(under_test, "hi"); });
+  EXPECT_THAT(blocked_write.wait_for(std::chrono::milliseconds{50}),
+              Eq(std::future_status::timeout));
+
+  wrapped.open();
+  blocked_write.get();
+  under_test.flush();
+  EXPECT_THAT(wrapped.get_data(), Eq(as_bytes("abcdefghi")));
+}
+
+TEST(AsyncSinkTests, ErrorIsReportedOnFlush)
+{
+  failing_sink wrapped;
+  async_sink under_test{wrapped, 4, 2};
+  write_string(under_test, "abc");
+  EXPECT_THROW(under_test.flush(), std::runtime_error);
+  EXPECT_THROW(write_string(under_test, "abc"), std::runtime_error);
+}
+
+TEST(AsyncSinkTests, ThrowsOnInvalidBufferConfiguration)
+{
+  recording_sink wrapped;
+  EXPECT_THROW(async_sink(wrapped, 0, 1), std::invalid_argument);
+  EXPECT_THROW(async_sink(wrapped, 1, 0), std::invalid_argument);
+}
+
+namespace {
+auto create_compressible_input() -> std::string
+{
+  std::string result;
+  for (int idx = 0; idx < 100000; ++idx) {
+    result += std::to_string(idx % 1000) + " ";
+  }
+  return result;
+}
+
+auto gunzip(std::vector<std::byte> const& input) -> std::string
+{
+  temp_dir dir{"cnfkit_io"};
+  fs::path const path = dir.get_path() / "input.gz";
+  write_file(path, std::string{reinterpret_cast<char const*>(input.data()), input.size()});
+
+  zlib_source source{path};
+  std::string result;
+  std::optional<std::byte> byte;
+  while ((byte = source.read_byte())) {
+    result.push_back(static_cast<char>(*byte));
+  }
+  return result;
+}
+
+void write_bytes_to_file(fs::path const& path, std::vector<std::byte> const& content)
+{
+  write_file(path, std::string{reinterpret_cast<char const*>(content.data()), content.size()});
+}
+
+// Reads the source via read_bytes(), in blocks of the given size
+auto read_all(source& source, size_t block_size) -> std::string
+{
+  std::string result;
+  std::vector<std::byte> buffer(block_size);
+  std::byte* stop = nullptr;
+  do {
+    stop = source.read_bytes(buffer.data(), buffer.data() + buffer.size());
+    result.append(reinterpret_cast<char const*>(buffer.data()), stop - buffer.data());
+  } while (stop == buffer.data() + buffer.size());
+
+  EXPECT_TRUE(source.is_eof());
+  return result;
+}
+
+auto read_all_bytewise(source& source) -> std::string
+{
+  std::string result;
+  while (!source.is_eof()) {
+    std::optional<std::byte> const byte = source.read_byte();
+    if (byte.has_value()) {
+      result.push_back(static_cast<char>(*byte));
+    }
+  }
+  return result;
+}
+}
+
+TEST(ZlibSinkTests, CompressedDataCanBeDecompressed)
+{
+  std::string const input = create_compressible_input();
+
+  recording_sink wrapped;
+  zlib_sink under_test{wrapped, 9, 1024};
+  write_string(under_test, input.substr(0, 1000));
+  write_string(under_test, input.substr(1000));
+  under_test.finish();
+
+  EXPECT_THAT(wrapped.get_num_flushes(), Eq(1));
+  EXPECT_THAT(wrapped.get_data().size(), ::testing::Lt(input.size() / 10));
+  EXPECT_THAT(gunzip(wrapped.get_data()), Eq(input));
+}
+
+TEST(ZlibSinkTests, StreamIsCompletedOnDestruction)
+{
+  recording_sink wrapped;
+  {
+    zlib_sink under_test{wrapped};
+    write_string(under_test, uncompressed_input);
+  }
+  EXPECT_THAT(gunzip(wrapped.get_data()), Eq(uncompressed_input));
+}
+
+TEST(ZlibSinkTests, MoveAssignmentCompletesReplacedStream)
+{
+  std::string const input = create_compressible_input();
+
+  recording_sink replaced_wrapped;
+  recording_sink moved_wrapped;
+  {
+    zlib_sink under_test{replaced_wrapped};
+    write_string(under_test, uncompressed_input);
+
+    zlib_sink moved{moved_wrapped};
+    write_string(moved, input.substr(0, 1000));
+
+    under_test = std::move(moved);
+    EXPECT_THAT(gunzip(replaced_wrapped.get_data()), Eq(uncompressed_input));
+
+    write_string(under_test, input.substr(1000));
+  }
+  EXPECT_THAT(gunzip(moved_wrapped.get_data()), Eq(input));
+}
+
+TEST(ZlibSinkTests, FlushWritesPendingData)
+{
+  recording_sink wrapped;
+  zlib_sink under_test{wrapped};
+  write_string(under_test, uncompressed_input);
+  under_test.flush();
+  EXPECT_THAT(wrapped.get_num_flushes(), Eq(1));
+
+  // The flushed data is decompressible, but the stream is incomplete
+  std::vector<std::byte> const flushed = wrapped.get_data();
+  under_test.finish();
+  EXPECT_THAT(wrapped.get_data().size(), ::testing::Gt(flushed.size()));
+  EXPECT_THAT(gunzip(wrapped.get_data()), Eq(uncompressed_input));
+}
+
+TEST(ZlibSinkTests, WritingAfterFinishFails)
+{
+  recording_sink wrapped;
+  zlib_sink under_test{wrapped};
+  under_test.finish();
+  EXPECT_THROW(write_string(under_test, uncompressed_input), std::runtime_error);
+}
+
+TEST(ZlibSinkTests, ThrowsOnInvalidConfiguration)
+{
+  recording_sink wrapped;
+  EXPECT_THROW(zlib_sink(wrapped, 10), std::invalid_argument);
+  EXPECT_THROW(zlib_sink(wrapped, Z_DEFAULT_COMPRESSION, 0), std::invalid_argument);
+}
+
+namespace {
+// Pseudo-random clauses, which are compressed to many deflate blocks
+auto create_random_cnf_text(size_t num_clauses) -> std::string
+{
+  std::string result = "p cnf 1000000 " + std::to_string(num_clauses) + "\n";
+  uint32_t state = 1;
+  for (size_t idx = 0; idx < 3 * num_clauses; ++idx) {
+    state = state * 1103515245 + 12345;
+    result += std::to_string((static_cast<int32_t>(state % 2000001) - 1000000) | 1);
+    result += (idx % 3 == 2) ? " 0\n" : " ";
+  }
+  return result;
+}
+
+auto gzip_compress(std::string const& input, int level = Z_DEFAULT_COMPRESSION)
+    -> std::vector<std::byte>
+{
+  recording_sink result;
+  zlib_sink compressor{result, level};
+  write_string(compressor, input);
+  compressor.finish();
+  return result.get_data();
+}
+
+class GzipIndexTests : public ::testing::Test {
+protected:
+  GzipIndexTests() : m_dir{"cnfkit_io"}, m_input{create_random_cnf_text(100000)}
+  {
+    write_bytes_to_file(get_gzip_path(), gzip_compress(m_input));
+  }
+
+  auto get_gzip_path() const -> fs::path { return m_dir.get_path() / "input.cnf.gz"; }
+  auto get_index_path() const -> fs::path { return m_dir.get_path() / "input.cnf.gz.idx"; }
+  auto get_input() const -> std::string const& { return m_input; }
+
+private:
+  temp_dir m_dir;
+  std::string m_input;
+};
+
+auto decompress_with_index(fs::path const& path, gzip_index const& index, size_t num_threads)
+    -> std::string
+{
+  std::string result;
+  result.resize(index.get_uncompressed_size());
+  decompress_gzip_parallel(path, index, reinterpret_cast<std::byte*>(result.data()), num_threads);
+  return result;
+}
+}
+
+TEST_F(GzipIndexTests, IndexCoversDecompressedData)
+{
+  gzip_index const index = build_gzip_index(get_gzip_path(), 1 << 16);
+
+  EXPECT_THAT(index.get_uncompressed_size(), Eq(get_input().size()));
+  EXPECT_THAT(index.get_compressed_size(), Eq(fs::file_size(get_gzip_path())));
+  ASSERT_THAT(index.get_num_regions(), ::testing::Gt(10));
+  EXPECT_THAT(index.get_access_points().front().uncompressed_offset, Eq(0));
+
+  uint64_t total_size = 0;
+  for (size_t region = 0; region < index.get_num_regions(); ++region) {
+    EXPECT_THAT(index.get_region_size(region), ::testing::Ge(1 << 16));
+    total_size += index.get_region_size(region);
+  }
+  EXPECT_THAT(total_size, Eq(get_input().size()));
+}
+
+TEST_F(GzipIndexTests, DecompressParallel)
+{
+  gzip_index const index = build_gzip_index(get_gzip_path(), 1 << 16);
+
+  for (size_t num_threads : {1, 3, 100}) {
+    EXPECT_THAT(decompress_with_index(get_gzip_path(), index, num_threads), Eq(get_input()))
+        << "threads: " << num_threads;
+  }
+}
+
+TEST_F(GzipIndexTests, DecompressParallelWithSingleRegion)
+{
+  gzip_index const index = build_gzip_index(get_gzip_path(), 1 << 30);
+  EXPECT_THAT(index.get_num_regions(), Eq(1));
+  EXPECT_THAT(decompress_with_index(get_gzip_path(), index, 4), Eq(get_input()));
+}
+
+TEST_F(GzipIndexTests, DecompressParallelWithMultipleMembers)
+{
+  // Regions span member boundaries, and members contain multiple regions
+  std::string const second_input = create_random_cnf_text(50000);
+  std::vector<std::byte> compressed = gzip_compress(get_input());
+  std::vector<std::byte> const second_member = gzip_compress(second_input);
+  std::vector<std::byte> const empty_member = gzip_compress("");
+  compressed.insert(compressed.end(), empty_member.begin(), empty_member.end());
+  compressed.insert(compressed.end(), second_member.begin(), second_member.end());
+  write_bytes_to_file(get_gzip_path(), compressed);
+
+  for (uint64_t span : {1 << 16, 1 << 20}) {
+    gzip_index const index = build_gzip_index(get_gzip_path(), span);
+    EXPECT_THAT(decompress_with_index(get_gzip_path(), index, 4), Eq(get_input() + second_input))
+        << "span: " << span;
+  }
+}
+
+TEST_F(GzipIndexTests, DataAfterLastMemberIsIgnored)
+{
+  std::vector<std::byte> compressed = gzip_compress(get_input());
+  compressed.resize(compressed.size() + 100, std::byte{0});
+  write_bytes_to_file(get_gzip_path(), compressed);
+
+  gzip_index const index = build_gzip_index(get_gzip_path(), 1 << 16);
+  EXPECT_THAT(decompress_with_index(get_gzip_path(), index, 4), Eq(get_input()));
+}
+
+TEST_F(GzipIndexTests, DecompressEmptyFile)
+{
+  write_bytes_to_file(get_gzip_path(), gzip_compress(""));
+  gzip_index const index = build_gzip_index(get_gzip_path());
+  EXPECT_THAT(index.get_uncompressed_size(), Eq(0));
+  EXPECT_THAT(decompress_with_index(get_gzip_path(), index, 4), Eq(""));
+}
+
+TEST_F(GzipIndexTests, BuildingThrowsOnCorruptInput)
+{
+  std::vector<std::byte> compressed = gzip_compress(get_input());
+  compressed[compressed.size() / 2] ^= std::byte{0xff};
+  write_bytes_to_file(get_gzip_path(), compressed);
+  EXPECT_THROW(build_gzip_index(get_gzip_path()), std::runtime_error);
+
+  compressed = gzip_compress(get_input());
+  compressed.resize(compressed.size() / 2);
+  write_bytes_to_file(get_gzip_path(), compressed);
+  EXPECT_THROW(build_gzip_index(get_gzip_path()), std::runtime_error);
+
+  EXPECT_THROW(build_gzip_index(get_gzip_path(), 0), std::invalid_argument);
+}
+
+TEST_F(GzipIndexTests, DecompressingThrowsWhenIndexDoesNotMatch)
+{
+  gzip_index const index = build_gzip_index(get_gzip_path(), 1 << 16);
+  write_bytes_to_file(get_gzip_path(), gzip_compress(create_random_cnf_text(100)));
+
+  std::vector<std::byte> buffer(index.get_uncompressed_size());
+  EXPECT_THROW(decompress_gzip_parallel(get_gzip_path(), index, buffer.data(), 2),
+               std::invalid_argument);
+  EXPECT_THROW(decompress_gzip_parallel(get_gzip_path(), index, buffer.data(), 0),
+               std::invalid_argument);
+  EXPECT_THROW(parallel_gzip_source(get_gzip_path(), index, 2), std::invalid_argument);
+}
+
+TEST_F(GzipIndexTests, IndexCanBeSavedAndLoaded)
+{
+  gzip_index const index = build_gzip_index(get_gzip_path(), 1 << 16);
+
+  recording_sink sink;
+  write_gzip_index(index, sink);
+  std::string const serialized{reinterpret_cast<char const*>(sink.get_data().data()),
+                               sink.get_data().size()};
+
+  buf_source source{serialized};
+  gzip_index const loaded = read_gzip_index(source);
+
+  EXPECT_THAT(loaded.get_compressed_size(), Eq(index.get_compressed_size()));
+  EXPECT_THAT(loaded.get_uncompressed_size(), Eq(index.get_uncompressed_size()));
+  ASSERT_THAT(loaded.get_num_regions(), Eq(index.get_num_regions()));
+  for (size_t idx = 0; idx < index.get_num_regions(); ++idx) {
+    gzip_access_point const& expected = index.get_access_points()[idx];
+    gzip_access_point const& actual = loaded.get_access_points()[idx];
+    EXPECT_THAT(actual.uncompressed_offset, Eq(expected.uncompressed_offset));
+    EXPECT_THAT(actual.compressed_offset, Eq(expected.compressed_offset));
+    EXPECT_THAT(actual.num_bits, Eq(expected.num_bits));
+    EXPECT_THAT(actual.window, Eq(expected.window));
+  }
+
+  std::string const truncated = serialized.substr(0, serialized.size() - 1);
+  buf_source truncated_source{truncated};
+  EXPECT_THROW(read_gzip_index(truncated_source), std::invalid_argument);
+}
+
+TEST_F(GzipIndexTests, LoadOrBuildCachesIndex)
+{
+  gzip_index const built = load_or_build_gzip_index(get_gzip_path(), get_index_path(), 1 << 16);
+  ASSERT_TRUE(fs::exists(get_index_path()));
+
+  gzip_index const loaded = load_or_build_gzip_index(get_gzip_path(), get_index_path(), 1 << 16);
+  EXPECT_THAT(loaded.get_num_regions(), Eq(built.get_num_regions()));
+  EXPECT_THAT(loaded.get_fingerprint(), Eq(built.get_fingerprint()));
+
+  // The index is rebuilt when requesting a different span
+  gzip_index const respanned =
+      load_or_build_gzip_index(get_gzip_path(), get_index_path(), 1 << 20);
+  EXPECT_THAT(respanned.get_span(), Eq(1 << 20));
+  EXPECT_THAT(respanned.get_num_regions(), ::testing::Lt(built.get_num_regions()));
+
+  // The index is rebuilt when the file has changed
+  write_bytes_to_file(get_gzip_path(), gzip_compress(create_random_cnf_text(100)));
+  gzip_index const rebuilt = load_or_build_gzip_index(get_gzip_path(), get_index_path(), 1 << 20);
+  EXPECT_THAT(rebuilt.get_compressed_size(), Eq(fs::file_size(get_gzip_path())));
+  EXPECT_THAT(decompress_with_index(get_gzip_path(), rebuilt, 2), Eq(create_random_cnf_text(100)));
+
+  // Invalid index files are replaced
+  write_file(get_index_path(), "foo");
+  gzip_index const replaced = load_or_build_gzip_index(get_gzip_path(), get_index_path(), 1 << 20);
+  EXPECT_THAT(replaced.get_compressed_size(), Eq(fs::file_size(get_gzip_path())));
+  EXPECT_THAT(fs::file_size(get_index_path()), ::testing::Gt(3));
+}
+
+TEST_F(GzipIndexTests, IndexIsRebuiltWhenFileIsReplacedBySameSizedFile)
+{
+  // Without compression, the file size only depends on the size of the input
+  std::string replacement_input = get_input();
+  std::reverse(replacement_input.begin(), replacement_input.end());
+  std::vector<std::byte> const original = gzip_compress(get_input(), 0);
+  std::vector<std::byte> const replacement = gzip_compress(replacement_input, 0);
+  ASSERT_THAT(replacement.size(), Eq(original.size()));
+
+  write_bytes_to_file(get_gzip_path(), original);
+  gzip_index const built = load_or_build_gzip_index(get_gzip_path(), get_index_path(), 1 << 16);
+
+  write_bytes_to_file(get_gzip_path(), replacement);
+  EXPECT_THROW(decompress_with_index(get_gzip_path(), built, 2), std::invalid_argument);
+
+  gzip_index const rebuilt = load_or_build_gzip_index(get_gzip_path(), get_index_path(), 1 << 16);
+  EXPECT_THAT(rebuilt.get_fingerprint(), ::testing::Ne(built.get_fingerprint()));
+  EXPECT_THAT(decompress_with_index(get_gzip_path(), rebuilt, 2), Eq(replacement_input));
+}
+
+TEST_F(GzipIndexTests, ParallelGzipSourceReadsCompleteInput)
+{
+  gzip_index const index = build_gzip_index(get_gzip_path(), 1 << 16);
+
+  for (size_t num_threads : {1, 4}) {
+    parallel_gzip_source under_test{get_gzip_path(), index, num_threads};
+    EXPECT_THAT(read_all(under_test, 10000), Eq(get_input())) << "threads: " << num_threads;
+    EXPECT_THAT(under_test.read_byte(), Eq(std::nullopt));
+  }
+}
+
+TEST_F(GzipIndexTests, ParallelGzipSourceLendsRegions)
+{
+  gzip_index const index = build_gzip_index(get_gzip_path(), 1 << 16);
+  parallel_gzip_source under_test{get_gzip_path(), index, 2};
+
+  std::string result;
+  std::optional<byte_range> range;
+  while ((range = under_test.borrow_bytes()) && range->start != range->stop) {
+    result.append(reinterpret_cast<char const*>(range->start), range->stop - range->start);
+  }
+
+  EXPECT_THAT(result, Eq(get_input()));
+  EXPECT_TRUE(under_test.is_eof());
+}
+
+TEST_F(GzipIndexTests, ParallelGzipSourceReadsBytewise)
+{
+  write_bytes_to_file(get_gzip_path(), gzip_compress(uncompressed_input));
+  gzip_index const index = build_gzip_index(get_gzip_path());
+
+  parallel_gzip_source under_test{get_gzip_path(), index, 2};
+  EXPECT_THAT(read_all_bytewise(under_test), Eq(uncompressed_input));
+}
+
+TEST_F(GzipIndexTests, ParallelGzipSourceDestructionBeforeEOF)
+{
+  gzip_index const index = build_gzip_index(get_gzip_path(), 1 << 16);
+  parallel_gzip_source under_test{get_gzip_path(), index, 4};
+  EXPECT_THAT(under_test.read_byte(), ::testing::Optional(std::byte{'p'}));
+}
+
+TEST_F(GzipIndexTests, ParallelGzipSourceReportsErrorsInOrder)
+{
+  gzip_index const index = build_gzip_index(get_gzip_path(), 1 << 16);
+  ASSERT_THAT(index.get_num_regions(), ::testing::Gt(4));
+
+  // Corrupting the data in the middle of the fourth region. When decompressing
+  // a region, zlib may decode the header of the following block.
+  std::vector<std::byte> compressed = gzip_compress(get_input());
+  uint64_t const corrupt_offset = (index.get_access_points()[3].compressed_offset +
+                                   index.get_access_points()[4].compressed_offset) /
+                                  2;
+  for (uint64_t offset = corrupt_offset; offset < corrupt_offset + 100; ++offset) {
+    compressed[offset] = std::byte{0xff};
+  }
+  write_bytes_to_file(get_gzip_path(), compressed);
+
+  parallel_gzip_source under_test{get_gzip_path(), index, 4};
+  std::vector<std::byte> buffer(index.get_access_points()[3].uncompressed_offset);
+  EXPECT_THAT(under_test.read_bytes(buffer.data(), buffer.data() + buffer.size()),
+              Eq(buffer.data() + buffer.size()));
+  EXPECT_THROW(under_test.read_byte(), std::runtime_error);
+}
+
+TEST(LibarchiveSourceTests, BorrowCompleteInput)
+{
+  decompressing_source_context<libarchive_source> context{gz_compressed_input};
+  source& under_test = context.get_source();
+
+  std::vector<std::byte> result;
+  std::optional<byte_range> range;
+  while ((range = under_test.borrow_bytes()) && range->start != range->stop) {
+    result.insert(result.end(), range->start, range->stop);
+  }
+
+  ASSERT_TRUE(range.has_value());
+  EXPECT_THAT(result, Eq(as_bytes(uncompressed_input)));
+  EXPECT_TRUE(under_test.is_eof());
+}
+
+TEST(LibarchiveSourceTests, MixedReadingAndBorrowing)
+{
+  decompressing_source_context<libarchive_source> context{gz_compressed_input};
+  source& under_test = context.get_source();
+
+  std::vector<std::byte> result(5);
+  under_test.read_bytes(result.data(), result.data() + 5);
+  result.push_back(*under_test.read_byte());
+
+  std::optional<byte_range> const range = under_test.borrow_bytes();
+  ASSERT_TRUE(range.has_value());
+  result.insert(result.end(), range->start, range->stop);
+
+  EXPECT_THAT(result, Eq(as_bytes(uncompressed_input)));
+  EXPECT_THAT(under_test.read_byte(), Eq(std::nullopt));
+}
+
+TEST(LibarchiveSourceTests, ReadWithSmallBufferSize)
+{
+  std::string const input = create_random_cnf_text(10000);
+  temp_dir const dir{"cnfkit_io"};
+  write_bytes_to_file(dir.get_path() / "input.gz", gzip_compress(input));
+
+  libarchive_source under_test{dir.get_path() / "input.gz", 1};
+  EXPECT_THAT(read_all(under_test, 1000), Eq(input));
+}
+
+TEST(LibarchiveSourceTests, ThrowsOnInvalidBufferSize)
+{
+  temp_dir const dir{"cnfkit_io"};
+  write_file(dir.get_path() / "input", uncompressed_input);
+  EXPECT_THROW(libarchive_source(dir.get_path() / "input", 0), std::invalid_argument);
+}
+
+namespace {
+// Writes the data to a pipe on a background thread, in small blocks
+class pipe_writer {
+public:
+  explicit pipe_writer(std::string data) : m_data{std::move(data)}
+  {
+    if (::pipe(m_fds) != 0) {
+      throw std::runtime_error{"could not create pipe"};
+    }
+
+    m_writer = std::thread{[this]() {
+      for (size_t pos = 0; pos < m_data.size(); pos += 1000) {
+        size_t const size = std::min<size_t>(1000, m_data.size() - pos);
+        auto const* start = reinterpret_cast<std::byte const*>(m_data.data() + pos);
+        detail::write_fd(m_fds[1], start, start + size);
+      }
+      ::close(m_fds[1]);
+    }};
+  }
+
+  auto get_read_fd() const -> int { return m_fds[0]; }
+
+  ~pipe_writer()
+  {
+    m_writer.join();
+    ::close(m_fds[0]);
+  }
+
+private:
+  std::string m_data;
+  int m_fds[2] = {-1, -1};
+  std::thread m_writer;
+};
+
+auto create_large_input() -> std::string
+{
+  std::string result;
+  for (int idx = 0; idx < 200000; ++idx) {
+    result += std::to_string(idx) + " 0\n";
+  }
+  return result;
+}
+
+auto borrow_all(source& source) -> std::string
+{
+  std::string result;
+  std::optional<byte_range> block;
+  while ((block = source.borrow_bytes()) && block->start != block->stop) {
+    result.append(reinterpret_cast<char const*>(block->start), block->stop - block->start);
+  }
+  EXPECT_TRUE(block.has_value());
+  EXPECT_TRUE(source.is_eof());
+  return result;
+}
+}
+
+TEST(FdSourceTests, ThrowsOnConstructionWhenFileNotFound)
+{
+  EXPECT_THROW(fd_source{"does/not/exist"}, std::runtime_error);
+}
+
+TEST(FdSourceTests, ThrowsOnInvalidBufferSize)
+{
+  EXPECT_THROW(fd_source(STDIN_FILENO, 0), std::invalid_argument);
+}
+
+TEST(FdSourceTests, ReadCompleteInput)
+{
+  temp_dir const dir{"cnfkit_io"};
+  write_file(dir.get_path() / "input", uncompressed_input);
+  fd_source under_test{dir.get_path() / "input"};
+
+  auto buffer = create_buffer();
+  auto ptr_past_end =
+      under_test.read_bytes(buffer.data(), buffer.data() + uncompressed_input.size());
+  buffer.resize(std::distance(buffer.data(), ptr_past_end));
+
+  EXPECT_THAT(buffer, Eq(as_bytes(uncompressed_input)));
+
+  EXPECT_THAT(under_test.read_byte(), Eq(std::nullopt));
+  EXPECT_TRUE(under_test.is_eof());
+}
+
+TEST(FdSourceTests, ReadEmptyFile)
+{
+  temp_dir const dir{"cnfkit_io"};
+  write_file(dir.get_path() / "input", "");
+  fd_source under_test{dir.get_path() / "input"};
+
+  EXPECT_THAT(under_test.read_byte(), Eq(std::nullopt));
+  EXPECT_TRUE(under_test.is_eof());
+}
+
+TEST(FdSourceTests, ReadLargeFileWithSmallBuffer)
+{
+  std::string const input = create_large_input();
+  temp_dir const dir{"cnfkit_io"};
+  write_file(dir.get_path() / "input", input);
+
+  // Exercising both reading via the buffer and reading into the caller's buffer
+  for (size_t block_size : {size_t{1}, size_t{100}, size_t{4096}, size_t{100000}}) {
+    fd_source under_test{dir.get_path() / "input", 4096};
+    EXPECT_THAT(read_all(under_test, block_size), Eq(input)) << "block size: " << block_size;
+  }
+}
+
+TEST(FdSourceTests, ReadFromPipe)
+{
+  std::string const input = create_large_input();
+  pipe_writer writer{input};
+  fd_source under_test{writer.get_read_fd()};
+  EXPECT_THAT(read_all(under_test, 1 << 16), Eq(input));
+}
+
+TEST(FdSourceTests, ReadFromPipeBytewise)
+{
+  std::string const input = create_large_input();
+  pipe_writer writer{input};
+  fd_source under_test{writer.get_read_fd(), 1000};
+  EXPECT_THAT(read_all_bytewise(under_test), Eq(input));
+}
+
+TEST(FdSourceTests, BorrowFromPipe)
+{
+  std::string const input = create_large_input();
+  pipe_writer writer{input};
+  fd_source under_test{writer.get_read_fd()};
+  EXPECT_THAT(borrow_all(under_test), Eq(input));
+}
+
+TEST(FdSourceTests, MixedReadingAndBorrowing)
+{
+  temp_dir const dir{"cnfkit_io"};
+  write_file(dir.get_path() / "input", uncompressed_input);
+  fd_source under_test{dir.get_path() / "input", 16};
+
+  EXPECT_THAT(under_test.read_byte(), ::testing::Optional(std::byte{'L'}));
+  std::string result = "L" + borrow_all(under_test);
+  EXPECT_THAT(result, Eq(uncompressed_input));
+}
+
+TEST(FdSourceTests, ReadingAfterMove)
+{
+  temp_dir const dir{"cnfkit_io"};
+  write_file(dir.get_path() / "input", uncompressed_input);
+  fd_source under_test{dir.get_path() / "input"};
+
+  fd_source moved_source = std::move(under_test);
+  EXPECT_THAT(moved_source.read_byte(), ::testing::Optional(std::byte{'L'}));
+}
+
+TEST(FdSinkTests, WriteToFile)
+{
+  std::string const input = create_large_input();
+  temp_dir const dir{"cnfkit_io"};
+
+  {
+    fd_sink under_test{dir.get_path() / "output", 4096};
+
+    // Alternating between buffered writes and writes bypassing the buffer
+    size_t pos = 0;
+    for (size_t idx = 0; pos < input.size(); ++idx) {
+      size_t const size = std::min<size_t>(idx % 2 == 0 ? 100 : 10000, input.size() - pos);
+      write_string(under_test, input.substr(pos, size));
+      pos += size;
+    }
+    under_test.flush();
+  }
+
+  std::ifstream output{dir.get_path() / "output", std::ios::binary};
+  std::string const result{std::istreambuf_iterator<char>{output}, {}};
+  EXPECT_THAT(result, Eq(input));
+}
+
+TEST(FdSinkTests, RemainingDataIsWrittenOnDestruction)
+{
+  temp_dir const dir{"cnfkit_io"};
+  {
+    fd_sink under_test{dir.get_path() / "output"};
+    write_string(under_test, uncompressed_input);
+  }
+
+  std::ifstream output{dir.get_path() / "output", std::ios::binary};
+  std::string const result{std::istreambuf_iterator<char>{output}, {}};
+  EXPECT_THAT(result, Eq(uncompressed_input));
+}
+
+TEST(FdSinkTests, WriteToPipe)
+{
+  int fds[2];
+  ASSERT_THAT(::pipe(fds), Eq(0));
+
+  std::string const input = create_large_input();
+  std::thread writer{[&input, fd = fds[1]]() {
+    fd_sink under_test{fd, 1000};
+    write_string(under_test, input);
+    under_test.flush();
+    ::close(fd);
+  }};
+
+  fd_source reader{fds[0]};
+  EXPECT_THAT(read_all(reader, 1 << 16), Eq(input));
+  writer.join();
+  ::close(fds[0]);
+}
+
+TEST(FdSinkTests, ThrowsOnConstructionWhenDirectoryNotFound)
+{
+  EXPECT_THROW(fd_sink{"does/not/exist"}, std::runtime_error);
+}
+
+TEST(FdSinkTests, ThrowsOnInvalidBufferSize)
+{
+  EXPECT_THROW(fd_sink(STDOUT_FILENO, 0), std::invalid_argument);
+}
+
+namespace {
+// Unbuffered stream buffer accepting at most the given number of characters
+class bounded_streambuf : public std::streambuf {
+public:
+  explicit bounded_streambuf(size_t capacity) : m_capacity{capacity} {}
+
+  auto get_data() const -> std::string const& { return m_data; }
+
+protected:
+  auto overflow(int_type ch) -> int_type override
+  {
+    if (m_data.size() == m_capacity || traits_type::eq_int_type(ch, traits_type::eof())) {
+      return traits_type::eof();
+    }
+    m_data.push_back(traits_type::to_char_type(ch));
+    return ch;
+  }
+
+private:
+  std::string m_data;
+  size_t m_capacity;
+};
+}
+
+TEST(StreambufSinkTests, WriteCompleteInput)
+{
+  std::stringbuf output;
+  streambuf_sink under_test{output};
+
+  write_string(under_test, uncompressed_input);
+  under_test.flush();
+  EXPECT_THAT(output.str(), Eq(uncompressed_input));
+}
+
+TEST(StreambufSinkTests, ThrowsWhenDataIsNotAccepted)
+{
+  bounded_streambuf output{4};
+  streambuf_sink under_test{output};
+  EXPECT_THROW(write_string(under_test, uncompressed_input), std::runtime_error);
+  EXPECT_THAT(output.get_data(), Eq(uncompressed_input.substr(0, 4)));
+}
+
+#if defined(CNFKIT_TEST_ZSTD)
+namespace {
+auto unzstd(std::vector<std::byte> const& input) -> std::string
+{
+  std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)> context{ZSTD_createDCtx(), ZSTD_freeDCtx};
+  std::string result;
+  std::vector<char> buffer(ZSTD_DStreamOutSize());
+
+  ZSTD_inBuffer in{input.data(), input.size(), 0};
+  size_t remaining = 1;
+  while (in.pos != in.size || remaining != 0) {
+    ZSTD_outBuffer out{buffer.data(), buffer.size(), 0};
+    remaining = ZSTD_decompressStream(context.get(), &out, &in);
+    if (ZSTD_isError(remaining) || (out.pos == 0 && in.pos == in.size && remaining != 0)) {
+      throw std::runtime_error{"decompression failed"};
+    }
+    result.append(buffer.data(), out.pos);
+  }
+  return result;
+}
+}
+
+TEST(ZstdSinkTests, CompressedDataCanBeDecompressed)
+{
+  std::string const input = create_compressible_input();
+
+  for (int num_threads : {0, 2}) {
+    recording_sink wrapped;
+    zstd_sink under_test{wrapped, 19, num_threads};
+    write_string(under_test, input.substr(0, 1000));
+    write_string(under_test, input.substr(1000));
+    under_test.finish();
+
+    EXPECT_THAT(wrapped.get_num_flushes(), Eq(1));
+    EXPECT_THAT(wrapped.get_data().size(), ::testing::Lt(input.size() / 10));
+    EXPECT_THAT(unzstd(wrapped.get_data()), Eq(input)) << "threads: " << num_threads;
+  }
+}
+
+TEST(ZstdSinkTests, StreamIsCompletedOnDestruction)
+{
+  recording_sink wrapped;
+  {
+    zstd_sink under_test{wrapped};
+    write_string(under_test, uncompressed_input);
+  }
+  EXPECT_THAT(unzstd(wrapped.get_data()), Eq(uncompressed_input));
+}
+
+TEST(ZstdSinkTests, MoveAssignmentCompletesReplacedStream)
+{
+  std::string const input = create_compressible_input();
+
+  recording_sink replaced_wrapped;
+  recording_sink moved_wrapped;
+  {
+    zstd_sink under_test{replaced_wrapped};
+    write_string(under_test, uncompressed_input);
+
+    zstd_sink moved{moved_wrapped};
+    write_string(moved, input.substr(0, 1000));
+
+    under_test = std::move(moved);
+    EXPECT_THAT(unzstd(replaced_wrapped.get_data()), Eq(uncompressed_input));
+
+    write_string(under_test, input.substr(1000));
+  }
+  EXPECT_THAT(unzstd(moved_wrapped.get_data()), Eq(input));
+}
+
+TEST(ZstdSinkTests, FlushWritesPendingData)
+{
+  recording_sink wrapped;
+  zstd_sink under_test{wrapped};
+  write_string(under_test, uncompressed_input);
+  EXPECT_TRUE(wrapped.get_data().empty());
+
+  under_test.flush();
+  EXPECT_THAT(wrapped.get_num_flushes(), Eq(1));
+  EXPECT_FALSE(wrapped.get_data().empty());
+
+  under_test.finish();
+  EXPECT_THAT(unzstd(wrapped.get_data()), Eq(uncompressed_input));
+}
+
+TEST(ZstdSinkTests, WritingAfterFinishFails)
+{
+  recording_sink wrapped;
+  zstd_sink under_test{wrapped};
+  under_test.finish();
+  EXPECT_THROW(write_string(under_test, uncompressed_input), std::runtime_error);
+}
+
+namespace {
+auto zstd_compress(std::string const& input) -> std::vector<std::byte>
+{
+  recording_sink result;
+  zstd_sink compressor{result};
+  write_string(compressor, input);
+  compressor.finish();
+  return result.get_data();
+}
+}
+
+TEST(ZstdSourceTests, ThrowsOnConstructionWhenFileNotFound)
+{
+  EXPECT_THROW(zstd_source{"does/not/exist"}, std::runtime_error);
+}
+
+TEST(ZstdSourceTests, ReadCompleteInput)
+{
+  std::string const input = create_compressible_input();
+  temp_dir const dir{"cnfkit_io"};
+  write_bytes_to_file(dir.get_path() / "input.zst", zstd_compress(input));
+
+  for (size_t block_size : {1000, 1 << 20}) {
+    zstd_source under_test{dir.get_path() / "input.zst"};
+    EXPECT_THAT(read_all(under_test, block_size), Eq(input)) << "block size: " << block_size;
+    EXPECT_THAT(under_test.read_byte(), Eq(std::nullopt));
+  }
+}
+
+TEST(ZstdSourceTests, ReadCompleteInputBytewise)
+{
+  temp_dir const dir{"cnfkit_io"};
+  write_bytes_to_file(dir.get_path() / "input.zst", zstd_compress(uncompressed_input));
+
+  zstd_source under_test{dir.get_path() / "input.zst"};
+  EXPECT_THAT(read_all_bytewise(under_test), Eq(uncompressed_input));
+}
+
+TEST(ZstdSourceTests, ReadConcatenatedFrames)
+{
+  std::vector<std::byte> input = zstd_compress(uncompressed_input);
+  std::vector<std::byte> const second_frame = zstd_compress("foo");
+  input.insert(input.end(), second_frame.begin(), second_frame.end());
+
+  temp_dir const dir{"cnfkit_io"};
+  write_bytes_to_file(dir.get_path() / "input.zst", input);
+
+  zstd_source under_test{dir.get_path() / "input.zst"};
+  EXPECT_THAT(read_all(under_test, 1024), Eq(uncompressed_input + "foo"));
+}
+
+TEST(ZstdSourceTests, ThrowsOnTruncatedInput)
+{
+  std::vector<std::byte> input = zstd_compress(create_compressible_input());
+  input.resize(input.size() / 2);
+
+  temp_dir const dir{"cnfkit_io"};
+  write_bytes_to_file(dir.get_path() / "input.zst", input);
+
+  zstd_source under_test{dir.get_path() / "input.zst"};
+  EXPECT_THROW(read_all(under_test, 1024), std::runtime_error);
+}
+
+TEST(ZstdSourceTests, ThrowsOnCorruptInput)
+{
+  temp_dir const dir{"cnfkit_io"};
+  write_file(dir.get_path() / "input.zst", uncompressed_input);
+
+  zstd_source under_test{dir.get_path() / "input.zst"};
+  EXPECT_THROW(read_all(under_test, 1024), std::runtime_error);
+}
+#endif
+
+#if defined(CNFKIT_TEST_LZMA)
+namespace {
+// Compresses the input to a single xz stream, split into blocks of the given size
+auto xz_compress(std::string const& input, uint64_t block_size) -> std::vector<std::byte>
+{
+  lzma_mt options{};
+  options.threads = 1;
+  options.block_size = block_size;
+  options.preset = LZMA_PRESET_DEFAULT;
+  options.check = LZMA_CHECK_CRC64;
+
+  lzma_stream stream = LZMA_STREAM_INIT;
+  if (lzma_stream_encoder_mt(&stream, &options) != LZMA_OK) {
+    throw std::runtime_error{"initializing liblzma failed"};
+  }
+
+  std::vector<std::byte> result(lzma_stream_buffer_bound(input.size()));
+  stream.next_in = reinterpret_cast<uint8_t const*>(input.data());
+  stream.avail_in = input.size();
+  stream.next_out = reinterpret_cast<uint8_t*>(result.data());
+  stream.avail_out = result.size();
+
+  lzma_ret const code_result = lzma_code(&stream, LZMA_FINISH);
+  result.resize(result.size() - stream.avail_out);
+  lzma_end(&stream);
+
+  if (code_result != LZMA_STREAM_END) {
+    throw std::runtime_error{"xz compression failed"};
+  }
+  return result;
+}
+}
+
+TEST(LzmaSourceTests, ThrowsOnConstructionWhenFileNotFound)
+{
+  EXPECT_THROW(lzma_source{"does/not/exist"}, std::runtime_error);
+}
+
+TEST(LzmaSourceTests, ReadCompleteInput)
+{
+  std::string const input = create_compressible_input();
+  temp_dir const dir{"cnfkit_io"};
+
+  // Single-block streams are decompressed by one thread, regardless of num_threads
+  for (uint64_t block_size : {uint64_t{1} << 16, uint64_t{1} << 30}) {
+    write_bytes_to_file(dir.get_path() / "input.xz", xz_compress(input, block_size));
+
+    for (uint32_t num_threads : {1, 4}) {
+      lzma_source under_test{dir.get_path() / "input.xz", num_threads};
+      EXPECT_THAT(read_all(under_test, 1000), Eq(input))
+          << "block size: " << block_size << ", threads: " << num_threads;
+      EXPECT_THAT(under_test.read_byte(), Eq(std::nullopt));
+    }
+  }
+}
+
+TEST(LzmaSourceTests, ReadCompleteInputBytewise)
+{
+  temp_dir const dir{"cnfkit_io"};
+  write_bytes_to_file(dir.get_path() / "input.xz", xz_compress(uncompressed_input, 1 << 16));
+
+  lzma_source under_test{dir.get_path() / "input.xz"};
+  EXPECT_THAT(read_all_bytewise(under_test), Eq(uncompressed_input));
+}
+
+TEST(LzmaSourceTests, ReadConcatenatedStreams)
+{
+  std::vector<std::byte> input = xz_compress(uncompressed_input, 1 << 16);
+  std::vector<std::byte> const second_stream = xz_compress("foo", 1 << 16);
+  input.insert(input.end(), second_stream.begin(), second_stream.end());
+
+  temp_dir const dir{"cnfkit_io"};
+  write_bytes_to_file(dir.get_path() / "input.xz", input);
+
+  lzma_source under_test{dir.get_path() / "input.xz"};
+  EXPECT_THAT(read_all(under_test, 1024), Eq(uncompressed_input + "foo"));
+}
+
+TEST(LzmaSourceTests, ThrowsOnTruncatedInput)
+{
+  std::vector<std::byte> input = xz_compress(create_compressible_input(), 1 << 16);
+  input.resize(input.size() / 2);
+
+  temp_dir const dir{"cnfkit_io"};
+  write_bytes_to_file(dir.get_path() / "input.xz", input);
+
+  lzma_source under_test{dir.get_path() / "input.xz", 2};
+  EXPECT_THROW(read_all(under_test, 1024), std::runtime_error);
+}
+
+TEST(LzmaSourceTests, ThrowsOnCorruptInput)
+{
+  temp_dir const dir{"cnfkit_io"};
+  write_file(dir.get_path() / "input.xz", uncompressed_input);
+
+  lzma_source under_test{dir.get_path() / "input.xz"};
+  EXPECT_THROW(read_all(under_test, 1024), std::runtime_error);
+}
+#endif
 }
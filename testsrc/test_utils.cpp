@@ -1,7 +1,11 @@
 #include "test_utils.h"
 
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
 #include <random>
+#include <stdexcept>
 #include <string>
 
 namespace fs = std::filesystem;
@@ -46,4 +50,65 @@ auto temp_dir::get_path() const -> fs::path const&
   return m_path;
 }
 
+lending_test_source::lending_test_source(std::string const& data, size_t block_size)
+  : m_data{data}, m_block_size{block_size}
+{
+}
+
+auto lending_test_source::read_bytes(std::byte* buf_start, std::byte* buf_stop) -> std::byte*
+{
+  size_t const to_copy =
+      std::min(static_cast<size_t>(buf_stop - buf_start), m_data.size() - m_offset);
+  std::memcpy(buf_start, m_data.data() + m_offset, to_copy);
+  m_offset += to_copy;
+  return buf_start + to_copy;
+}
+
+auto lending_test_source::read_byte() -> std::optional<std::byte>
+{
+  if (m_offset == m_data.size()) {
+    return std::nullopt;
+  }
+  return static_cast<std::byte>(m_data[m_offset++]);
+}
+
+auto lending_test_source::is_eof() -> bool
+{
+  return m_offset == m_data.size();
+}
+
+auto lending_test_source::borrow_bytes() -> std::optional<byte_range>
+{
+  size_t const block_size = std::min(m_block_size, m_data.size() - m_offset);
+  auto const* block_start = reinterpret_cast<std::byte const*>(m_data.data() + m_offset);
+  m_offset += block_size;
+  return byte_range{block_start, block_start + block_size};
+}
+
+bulk_only_test_source::bulk_only_test_source(std::string const& data) : m_data{data} {}
+
+auto bulk_only_test_source::read_bytes(std::byte* buf_start, std::byte* buf_stop) -> std::byte*
+{
+  size_t const to_copy =
+      std::min(static_cast<size_t>(buf_stop - buf_start), m_data.size() - m_offset);
+  std::memcpy(buf_start, m_data.data() + m_offset, to_copy);
+  m_offset += to_copy;
+  return buf_start + to_copy;
+}
+
+auto bulk_only_test_source::read_byte() -> std::optional<std::byte>
+{
+  throw std::logic_error{"unexpected call to read_byte()"};
+}
+
+auto bulk_only_test_source::is_eof() -> bool
+{
+  return m_offset == m_data.size();
+}
+
+void write_file(fs::path const& path, std::string const& content)
+{
+  std::ofstream file{path, std::ios::binary};
+  file.write(content.data(), content.size());
+}
 }
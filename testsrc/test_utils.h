@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cnfkit/io.h>
 #include <cnfkit/literal.h>
 
 #include <filesystem>
+#include <optional>
 #include <ostream>
 #include <string>
 
@@ -21,4 +23,42 @@ public:
 private:
   std::filesystem::path m_path;
 };
+
+/**
+ * Source lending the data of a string in blocks of the given size, for
+ * testing how parsers handle tokens spanning block boundaries.
+ */
+class lending_test_source : public source {
+public:
+  lending_test_source(std::string const& data, size_t block_size);
+
+  auto read_bytes(std::byte* buf_start, std::byte* buf_stop) -> std::byte* override;
+  auto read_byte() -> std::optional<std::byte> override;
+  auto is_eof() -> bool override;
+  auto borrow_bytes() -> std::optional<byte_range> override;
+
+private:
+  std::string const& m_data;
+  size_t m_block_size;
+  size_t m_offset = 0;
+};
+
+/**
+ * Source serving the data of a string via read_bytes(), failing on
+ * read_byte(), for checking that parsers only issue bulk reads.
+ */
+class bulk_only_test_source : public source {
+public:
+  explicit bulk_only_test_source(std::string const& data);
+
+  auto read_bytes(std::byte* buf_start, std::byte* buf_stop) -> std::byte* override;
+  auto read_byte() -> std::optional<std::byte> override;
+  auto is_eof() -> bool override;
+
+private:
+  std::string const& m_data;
+  size_t m_offset = 0;
+};
+
+void write_file(std::filesystem::path const& path, std::string const& content);
 }